@@ -0,0 +1,412 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// store generated meshes in binary files that are mapped into memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	///////////////////////////////////////////////////
+	//	AlignOffset()
+	//
+	//	Round a file offset up to the stream alignment.
+	///////////////////////////////////////////////////
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + MeshCache::STREAM_ALIGNMENT - 1) & ~(MeshCache::STREAM_ALIGNMENT - 1));
+	}
+
+	///////////////////////////////////////////////////
+	//	WritePadding()
+	//
+	//	Write zeros up to the passed in file offset.
+	///////////////////////////////////////////////////
+	void WritePadding(std::ofstream& file, uint64_t offset)
+	{
+		static const char zeros[256] = {};
+		uint64_t position = (uint64_t)file.tellp();
+
+		while (position < offset)
+		{
+			uint64_t count = offset - position;
+			if (count > sizeof(zeros))
+			{
+				count = sizeof(zeros);
+			}
+			file.write(zeros, (std::streamsize)count);
+			position += count;
+		}
+	}
+}
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#else
+	m_file = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshCache::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a whole file into
+ *  memory for reading.
+ ***********************************************************/
+bool MeshCache::MappedFile::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	m_hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE == m_hFile)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(m_hFile, &fileSize) == FALSE) || (fileSize.QuadPart <= 0))
+	{
+		Close();
+		return(false);
+	}
+
+	m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == m_hMapping)
+	{
+		Close();
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	m_file = open(path.c_str(), O_RDONLY);
+	if (m_file < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileStatus;
+	if ((fstat(m_file, &fileStatus) != 0) || (fileStatus.st_size <= 0))
+	{
+		Close();
+		return(false);
+	}
+
+	void* pMapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	m_pData = (MAP_FAILED == pMapping) ? NULL : (const unsigned char*)pMapping;
+	m_size = (size_t)fileStatus.st_size;
+#endif
+
+	if (NULL == m_pData)
+	{
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping and closing the file.
+ ***********************************************************/
+void MeshCache::MappedFile::Close()
+{
+#ifdef _WIN32
+	if (NULL != m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (NULL != m_hMapping)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+	if (INVALID_HANDLE_VALUE != m_hFile)
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (NULL != m_pData)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+	if (m_file >= 0)
+	{
+		close(m_file);
+		m_file = -1;
+	}
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+}
+
+///////////////////////////////////////////////////
+//	HashBytes()
+//
+//	Add the passed in bytes to a running 64-bit
+//  FNV-1a hash.  It only has to tell the generator
+//  parameters of two cache files apart, so a simple
+//  hash that is the same on every platform is enough.
+///////////////////////////////////////////////////
+uint64_t MeshCache::HashBytes(
+	const void* pData,
+	size_t size,
+	uint64_t hash)
+{
+	const unsigned char* pBytes = (const unsigned char*)pData;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= pBytes[i];
+		hash *= 0x100000001B3ull;
+	}
+
+	return(hash);
+}
+
+///////////////////////////////////////////////////
+//	WriteMeshFile()
+//
+//	Write the header, the level table and the two
+//  streams of a mesh into a cache file.  The file is
+//  written under a temporary name and renamed when
+//  it is complete, so a run that is stopped halfway
+//  never leaves a damaged cache file behind.
+///////////////////////////////////////////////////
+bool MeshCache::WriteMeshFile(
+	const std::string& path,
+	uint32_t floatsPerVertex,
+	uint64_t generatorHash,
+	const std::vector<MeshLevel>& levels)
+{
+	if ((levels.empty() == true) || (levels.size() > MAX_LEVELS))
+	{
+		return(false);
+	}
+
+	std::vector<LevelRecord> records;
+	uint64_t nVertices = 0;
+	uint64_t nIndices = 0;
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		LevelRecord record = levels[i].record;
+		record.firstVertex = (uint32_t)nVertices;
+		record.firstIndex = (uint32_t)nIndices;
+		nVertices += record.nVertices;
+		nIndices += (uint64_t)record.nIndices + record.nCombinationIndices;
+		records.push_back(record);
+	}
+
+	FileHeader header;
+	header.magic = FILE_MAGIC;
+	header.version = FILE_VERSION;
+	header.floatsPerVertex = floatsPerVertex;
+	header.nLevels = (uint32_t)levels.size();
+	header.generatorHash = generatorHash;
+	header.vertexStreamOffset = AlignOffset(sizeof(FileHeader) + (sizeof(LevelRecord) * records.size()));
+	header.vertexStreamSize = nVertices * floatsPerVertex * sizeof(float);
+	header.indexStreamOffset = AlignOffset(header.vertexStreamOffset + header.vertexStreamSize);
+	header.indexStreamSize = nIndices * sizeof(uint32_t);
+
+	std::string temporaryPath = path + ".tmp";
+	std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return(false);
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)records.data(), (std::streamsize)(sizeof(LevelRecord) * records.size()));
+
+	WritePadding(file, header.vertexStreamOffset);
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		file.write((const char*)levels[i].vertices,
+			(std::streamsize)((size_t)records[i].nVertices * floatsPerVertex * sizeof(float)));
+	}
+
+	WritePadding(file, header.indexStreamOffset);
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		file.write((const char*)levels[i].indices,
+			(std::streamsize)(((size_t)records[i].nIndices + records[i].nCombinationIndices) * sizeof(uint32_t)));
+	}
+
+	bool bWritten = file.good();
+	file.close();
+
+	if (bWritten == true)
+	{
+		// replace an outdated file of the same name
+		std::remove(path.c_str());
+		bWritten = (std::rename(temporaryPath.c_str(), path.c_str()) == 0);
+	}
+	if (bWritten == false)
+	{
+		std::remove(temporaryPath.c_str());
+	}
+
+	return(bWritten);
+}
+
+///////////////////////////////////////////////////
+//	ReadMeshFile()
+//
+//	Check a mapped cache file and get pointers to the
+//  data of each of its levels.  Everything is checked
+//  against the size of the file, the part ranges
+//  against the indices of their level and the indices
+//  against its vertices, so a damaged file is rejected
+//  instead of being read or drawn past its end.  A file
+//  generated from other parameters is rejected too.
+///////////////////////////////////////////////////
+bool MeshCache::ReadMeshFile(
+	const MappedFile& file,
+	uint32_t floatsPerVertex,
+	uint64_t generatorHash,
+	std::vector<MeshLevel>& levels)
+{
+	levels.clear();
+
+	const unsigned char* pData = file.GetData();
+	const uint64_t size = file.GetSize();
+	if ((NULL == pData) || (size < sizeof(FileHeader)))
+	{
+		return(false);
+	}
+
+	const FileHeader* pHeader = (const FileHeader*)pData;
+	if ((pHeader->magic != FILE_MAGIC) || (pHeader->version != FILE_VERSION) ||
+		(pHeader->floatsPerVertex != floatsPerVertex) || (pHeader->generatorHash != generatorHash) ||
+		(pHeader->nLevels == 0) || (pHeader->nLevels > MAX_LEVELS) ||
+		((sizeof(FileHeader) + (sizeof(LevelRecord) * pHeader->nLevels)) > size) ||
+		((pHeader->vertexStreamOffset % STREAM_ALIGNMENT) != 0) ||
+		((pHeader->indexStreamOffset % STREAM_ALIGNMENT) != 0) ||
+		(pHeader->vertexStreamOffset > size) || (pHeader->vertexStreamSize > (size - pHeader->vertexStreamOffset)) ||
+		(pHeader->indexStreamOffset > size) || (pHeader->indexStreamSize > (size - pHeader->indexStreamOffset)))
+	{
+		return(false);
+	}
+
+	const uint64_t nStreamVertices = pHeader->vertexStreamSize / (floatsPerVertex * sizeof(float));
+	const uint64_t nStreamIndices = pHeader->indexStreamSize / sizeof(uint32_t);
+	const LevelRecord* pRecords = (const LevelRecord*)(pData + sizeof(FileHeader));
+	const float* pVertices = (const float*)(pData + pHeader->vertexStreamOffset);
+	const uint32_t* pIndices = (const uint32_t*)(pData + pHeader->indexStreamOffset);
+
+	for (uint32_t i = 0; i < pHeader->nLevels; i++)
+	{
+		const LevelRecord& record = pRecords[i];
+		if (((uint64_t)record.firstVertex + record.nVertices > nStreamVertices) ||
+			((uint64_t)record.firstIndex + record.nIndices + record.nCombinationIndices > nStreamIndices))
+		{
+			levels.clear();
+			return(false);
+		}
+
+		MeshLevel level;
+		level.record = record;
+		level.vertices = pVertices + ((size_t)record.firstVertex * floatsPerVertex);
+		level.indices = pIndices + record.firstIndex;
+
+		// the parts lie in the indices of the level, their combinations
+		// may also use the copies behind them
+		bool bValid = true;
+		for (int j = 0; j < 3; j++)
+		{
+			bValid = bValid && ((uint64_t)record.parts[j][0] + record.parts[j][1] <= record.nIndices);
+		}
+		for (int j = 0; j < 8; j++)
+		{
+			bValid = bValid && ((uint64_t)record.partCombinations[j][0] + record.partCombinations[j][1] <=
+				(uint64_t)record.nIndices + record.nCombinationIndices);
+		}
+
+		// every index has to name a vertex of the level
+		const uint64_t nLevelIndices = (uint64_t)record.nIndices + record.nCombinationIndices;
+		for (uint64_t j = 0; (j < nLevelIndices) && (bValid == true); j++)
+		{
+			bValid = (level.indices[j] < record.nVertices);
+		}
+
+		if (bValid == false)
+		{
+			levels.clear();
+			return(false);
+		}
+
+		levels.push_back(level);
+	}
+
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	CreateCacheDirectory()
+//
+//	Create the directory for the cache files, it is
+//  fine when it exists already.
+///////////////////////////////////////////////////
+bool MeshCache::CreateCacheDirectory(const std::string& path)
+{
+#ifdef _WIN32
+	if (CreateDirectoryA(path.c_str(), NULL) == FALSE)
+	{
+		return(GetLastError() == ERROR_ALREADY_EXISTS);
+	}
+#else
+	struct stat directoryStatus;
+	if ((stat(path.c_str(), &directoryStatus) == 0) && S_ISDIR(directoryStatus.st_mode))
+	{
+		return(true);
+	}
+	if (mkdir(path.c_str(), 0755) != 0)
+	{
+		return(false);
+	}
+#endif
+
+	return(true);
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// store generated meshes in binary files that are mapped into memory
+//
+// A cache file holds one mesh with all of its levels of detail:
+//
+//     header | level table | padding | vertex stream | padding | index stream
+//
+// The streams start on page boundaries, so once the file is mapped they can be
+// handed to OpenGL as they are, without being read into buffers first.  The
+// version is raised whenever the file layout or the generated meshes change,
+// and files of another version are ignored and written again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MeshCache
+{
+	// identifies a mesh cache file, "MSHC"
+	const uint32_t FILE_MAGIC = 0x4348534D;
+	// raise when the layout of the file changes, a change of the
+	// mesh generation is caught by the generator hash instead
+	const uint32_t FILE_VERSION = 3;
+	// alignment of the streams in the file
+	const uint64_t STREAM_ALIGNMENT = 4096;
+	// most levels of detail a file can hold
+	const uint32_t MAX_LEVELS = 8;
+
+	// start of every cache file
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t floatsPerVertex;	// interleaved floats of each vertex
+		uint32_t nLevels;			// entries of the level table
+		uint64_t generatorHash;		// hash of what the mesh was generated from
+		uint64_t vertexStreamOffset;
+		uint64_t vertexStreamSize;	// bytes
+		uint64_t indexStreamOffset;
+		uint64_t indexStreamSize;	// bytes
+	};
+
+	// one level of detail, the index ranges are relative to the
+	// first index of the level and the indices to its first vertex
+	struct LevelRecord
+	{
+		uint32_t firstVertex;		// first vertex of the level in the vertex stream
+		uint32_t nVertices;
+		uint32_t firstIndex;		// first index of the level in the index stream
+		uint32_t nIndices;
+		uint32_t nCombinationIndices;	// part combination copies behind the indices
+		uint32_t bHasParts;			// the parts can be drawn separately
+		uint32_t parts[3][2];		// first index and count of the top, bottom and sides
+		uint32_t partCombinations[8][2];	// first index and count by part flags
+		float boundsMinimum[3];		// bounding box and sphere of the vertices
+		float boundsMaximum[3];
+		float boundsCenter[3];
+		float boundsRadius;
+	};
+
+	// a level of detail together with its data
+	struct MeshLevel
+	{
+		LevelRecord record;
+		const float* vertices;
+		const uint32_t* indices;
+	};
+
+	/***********************************************************
+	 *  MappedFile
+	 *
+	 *  This class contains the code for mapping a file into
+	 *  memory for reading, until it is closed.
+	 ***********************************************************/
+	class MappedFile
+	{
+	public:
+		// constructor
+		MappedFile();
+		// destructor, closes the file
+		~MappedFile();
+
+		// map the file at the passed in path, returns false when
+		// it does not exist or cannot be mapped
+		bool Open(const std::string& path);
+		// unmap and close the file
+		void Close();
+
+		// get the mapped contents of the file
+		const unsigned char* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_size; }
+
+	private:
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const unsigned char* m_pData;
+		size_t m_size;
+#ifdef _WIN32
+		void* m_hFile;
+		void* m_hMapping;
+#else
+		int m_file;
+#endif
+	};
+
+	// hash the passed in bytes into a running hash, start with the
+	// default to hash the parameters a mesh is generated from
+	uint64_t HashBytes(
+		const void* pData,
+		size_t size,
+		uint64_t hash = 0xCBF29CE484222325ull);
+
+	// write the levels of a mesh into a cache file, the first vertex
+	// and first index of the records are filled in - returns false
+	// when the file could not be written
+	bool WriteMeshFile(
+		const std::string& path,
+		uint32_t floatsPerVertex,
+		uint64_t generatorHash,
+		const std::vector<MeshLevel>& levels);
+
+	// check the header, the level table and the indices of a mapped
+	// cache file and get its levels, which point into the mapping -
+	// returns false when the file is of another version, was generated
+	// from other parameters or is damaged
+	bool ReadMeshFile(
+		const MappedFile& file,
+		uint32_t floatsPerVertex,
+		uint64_t generatorHash,
+		std::vector<MeshLevel>& levels);
+
+	// create the cache directory if it does not exist yet
+	bool CreateCacheDirectory(const std::string& path);
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// build the curved 3D primitives from tessellation parameters
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <cstddef>
+
+namespace
+{
+	///////////////////////////////////////////////////
+	//	ResizeMesh()
+	//
+	//	Size the buffers of a mesh for the passed in
+	//  counts, so the writers fill them in place.
+	///////////////////////////////////////////////////
+	void ResizeMesh(MeshGenerator::MeshData& mesh, GLuint nVertices, GLuint nIndices)
+	{
+		mesh.vertices.resize((size_t)nVertices * MeshGenerator::FLOATS_PER_VERTEX);
+		mesh.indices.resize(nIndices);
+	}
+}
+
+///////////////////////////////////////////////////
+//	GenerateSphere()
+//
+//	Generate a unit sphere of any resolution.
+///////////////////////////////////////////////////
+void MeshGenerator::GenerateSphere(
+	int rings,
+	int sectors,
+	MeshData& mesh)
+{
+	if (rings < 2) rings = 2;
+	if (sectors < 3) sectors = 3;
+
+	ResizeMesh(mesh, SphereVertexCount(rings, sectors), SphereIndexCount(rings, sectors));
+	WriteSphere(rings, sectors, mesh);
+}
+
+///////////////////////////////////////////////////
+//	GenerateCylinder()
+//
+//	Generate a cylinder, tapered cylinder or cone of
+//  any resolution.
+///////////////////////////////////////////////////
+void MeshGenerator::GenerateCylinder(
+	int segments,
+	float topRadius,
+	MeshData& mesh)
+{
+	if (segments < 3) segments = 3;
+	if (topRadius < 0.0f) topRadius = 0.0f;
+
+	const bool bHasTop = (topRadius > 0.0f);
+
+	ResizeMesh(mesh, CylinderVertexCount(segments, bHasTop), CylinderIndexCount(segments, bHasTop));
+	WriteCylinder(segments, topRadius, mesh);
+}
+
+///////////////////////////////////////////////////
+//	GenerateTorus()
+//
+//	Generate a torus of any resolution.
+///////////////////////////////////////////////////
+void MeshGenerator::GenerateTorus(
+	int mainSegments,
+	int tubeSegments,
+	float tubeRadius,
+	MeshData& mesh)
+{
+	if (mainSegments < 3) mainSegments = 3;
+	if (tubeSegments < 3) tubeSegments = 3;
+
+	ResizeMesh(mesh, TorusVertexCount(mainSegments, tubeSegments), TorusIndexCount(mainSegments, tubeSegments));
+	WriteTorus(mainSegments, tubeSegments, tubeRadius, mesh);
+}
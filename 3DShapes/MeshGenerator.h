@@ -0,0 +1,518 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// build the curved 3D primitives from tessellation parameters
+//
+// The generated meshes use the same interleaved vertex layout as the shape
+// meshes (position, normal, texture coordinates) and indexed triangle lists.
+// The triangles are emitted from the top of the shapes down, and around the
+// torus ring, so the first half of the indices is always a half shape.
+//
+// The vertex and index counts of every shape are known from its parameters,
+// so the buffers are sized once and then written in place.  The writers are
+// constexpr templates, which lets the default resolutions be built by the
+// compiler into static meshes, while any other resolution is generated into
+// a MeshData at run time by exactly the same code.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace MeshGenerator
+{
+	// interleaved vertices and triangle list indices of a generated
+	// mesh, with the index ranges of its caps and sides
+	struct MeshData
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		GLuint topFirstIndex = 0;
+		GLuint topIndexCount = 0;
+		GLuint bottomFirstIndex = 0;
+		GLuint bottomIndexCount = 0;
+		GLuint sidesFirstIndex = 0;
+		GLuint sidesIndexCount = 0;
+	};
+
+	// raise when the generated vertices or indices change, so the
+	// cached shapes of the previous generator are not used
+	const int GENERATOR_VERSION = 1;
+
+	// number of floats of each interleaved vertex
+	const int FLOATS_PER_VERTEX = 8;
+
+	// resolutions of the full detail shapes
+	const int DEFAULT_SPHERE_RINGS = 16;
+	const int DEFAULT_SPHERE_SECTORS = 16;
+	const int DEFAULT_CYLINDER_SEGMENTS = 36;
+	const int DEFAULT_TORUS_MAIN_SEGMENTS = 30;
+	const int DEFAULT_TORUS_TUBE_SEGMENTS = 30;
+	constexpr float DEFAULT_TORUS_THICKNESS = 0.2f;
+
+	// unit sphere around the origin, with the given number of
+	// rings from pole to pole and sectors around the Y axis
+	void GenerateSphere(
+		int rings,
+		int sectors,
+		MeshData& mesh);
+
+	// cylinder of height 1 standing on the origin, with a bottom
+	// radius of 1 and the given top radius - a top radius of zero
+	// makes a cone, which has no top cap
+	void GenerateCylinder(
+		int segments,
+		float topRadius,
+		MeshData& mesh);
+
+	// torus around the Z axis with a ring radius of 1 and the
+	// given tube radius
+	void GenerateTorus(
+		int mainSegments,
+		int tubeSegments,
+		float tubeRadius,
+		MeshData& mesh);
+
+	///////////////////////////////////////////////////
+	//	Vertex and index counts
+	///////////////////////////////////////////////////
+
+	constexpr GLuint SphereVertexCount(int rings, int sectors)
+	{
+		return (GLuint)((rings + 1) * (sectors + 1));
+	}
+	// the rings at the poles have one triangle per sector
+	constexpr GLuint SphereIndexCount(int rings, int sectors)
+	{
+		return (GLuint)((rings - 1) * sectors * 6);
+	}
+	// a cylinder without a top cap is a cone
+	constexpr GLuint CylinderVertexCount(int segments, bool bHasTop)
+	{
+		return (GLuint)((segments + 1) * (bHasTop ? 4 : 3));
+	}
+	constexpr GLuint CylinderIndexCount(int segments, bool bHasTop)
+	{
+		return (GLuint)(segments * (bHasTop ? 12 : 6));
+	}
+	constexpr GLuint TorusVertexCount(int mainSegments, int tubeSegments)
+	{
+		return (GLuint)((mainSegments + 1) * (tubeSegments + 1));
+	}
+	constexpr GLuint TorusIndexCount(int mainSegments, int tubeSegments)
+	{
+		return (GLuint)(mainSegments * tubeSegments * 6);
+	}
+
+	// mesh with a fixed number of vertices and indices, which
+	// can be built at compile time
+	template<GLuint VERTICES, GLuint INDICES>
+	struct StaticMesh
+	{
+		enum { VERTEX_COUNT = VERTICES, INDEX_COUNT = INDICES };
+
+		GLfloat vertices[VERTICES * FLOATS_PER_VERTEX];
+		GLuint indices[INDICES];
+		GLuint topFirstIndex;
+		GLuint topIndexCount;
+		GLuint bottomFirstIndex;
+		GLuint bottomIndexCount;
+		GLuint sidesFirstIndex;
+		GLuint sidesIndexCount;
+	};
+
+	// the buffers and index ranges of a generated mesh, which
+	// is either a MeshData or a StaticMesh
+	struct MeshView
+	{
+		const GLfloat* vertices;
+		GLuint nVertices;
+		const GLuint* indices;
+		GLuint nIndices;
+		GLuint topFirstIndex;
+		GLuint topIndexCount;
+		GLuint bottomFirstIndex;
+		GLuint bottomIndexCount;
+		GLuint sidesFirstIndex;
+		GLuint sidesIndexCount;
+	};
+
+	template<typename MESH>
+	MeshView GetMeshView(const MESH& mesh, const GLfloat* vertices, GLuint nVertices, const GLuint* indices, GLuint nIndices)
+	{
+		MeshView view = { vertices, nVertices, indices, nIndices,
+			mesh.topFirstIndex, mesh.topIndexCount,
+			mesh.bottomFirstIndex, mesh.bottomIndexCount,
+			mesh.sidesFirstIndex, mesh.sidesIndexCount };
+		return view;
+	}
+
+	inline MeshView GetMeshView(const MeshData& mesh)
+	{
+		return GetMeshView(mesh, mesh.vertices.data(), (GLuint)(mesh.vertices.size() / FLOATS_PER_VERTEX),
+			mesh.indices.data(), (GLuint)mesh.indices.size());
+	}
+
+	template<GLuint VERTICES, GLuint INDICES>
+	MeshView GetMeshView(const StaticMesh<VERTICES, INDICES>& mesh)
+	{
+		return GetMeshView(mesh, mesh.vertices, VERTICES, mesh.indices, INDICES);
+	}
+
+	namespace Detail
+	{
+		constexpr double PI = 3.14159265358979323846;
+
+		///////////////////////////////////////////////////
+		//	Sine() / Cosine() / SquareRoot()
+		//
+		//	The library math functions cannot be used in
+		//  constant expressions, so these are evaluated
+		//  with series that are accurate to well below
+		//  float precision.
+		///////////////////////////////////////////////////
+		constexpr double Sine(double x)
+		{
+			while (x > PI) x -= 2.0 * PI;
+			while (x < -PI) x += 2.0 * PI;
+
+			double term = x;
+			double sum = x;
+			for (int n = 1; n < 13; n++)
+			{
+				term *= -(x * x) / (double)((2 * n) * ((2 * n) + 1));
+				sum += term;
+			}
+			return sum;
+		}
+
+		constexpr double Cosine(double x)
+		{
+			return Sine(x + (PI * 0.5));
+		}
+
+		constexpr double SquareRoot(double x)
+		{
+			double root = (x > 1.0) ? x : 1.0;
+			for (int n = 0; n < 32; n++)
+			{
+				root = 0.5 * (root + (x / root));
+			}
+			return root;
+		}
+
+		///////////////////////////////////////////////////
+		//	WriteVertex() / WriteTriangle()
+		//
+		//	Write one interleaved vertex or the indices of
+		//  one triangle at the current write position.
+		///////////////////////////////////////////////////
+		template<typename MESH>
+		constexpr void WriteVertex(
+			MESH& mesh,
+			GLuint& nVertices,
+			double x, double y, double z,
+			double nx, double ny, double nz,
+			double u, double v)
+		{
+			GLuint offset = nVertices * FLOATS_PER_VERTEX;
+
+			mesh.vertices[offset + 0] = (GLfloat)x;
+			mesh.vertices[offset + 1] = (GLfloat)y;
+			mesh.vertices[offset + 2] = (GLfloat)z;
+			mesh.vertices[offset + 3] = (GLfloat)nx;
+			mesh.vertices[offset + 4] = (GLfloat)ny;
+			mesh.vertices[offset + 5] = (GLfloat)nz;
+			mesh.vertices[offset + 6] = (GLfloat)u;
+			mesh.vertices[offset + 7] = (GLfloat)v;
+			nVertices++;
+		}
+
+		template<typename MESH>
+		constexpr void WriteTriangle(MESH& mesh, GLuint& nIndices, GLuint a, GLuint b, GLuint c)
+		{
+			mesh.indices[nIndices + 0] = a;
+			mesh.indices[nIndices + 1] = b;
+			mesh.indices[nIndices + 2] = c;
+			nIndices += 3;
+		}
+
+		///////////////////////////////////////////////////
+		//	WriteCap()
+		//
+		//	Write a flat disc at the given height, facing
+		//  up or down, as a fan around its center vertex.
+		//  The texture is mapped onto the disc from above.
+		///////////////////////////////////////////////////
+		template<typename MESH>
+		constexpr void WriteCap(
+			MESH& mesh,
+			GLuint& nVertices,
+			GLuint& nIndices,
+			int segments,
+			double y,
+			double radius,
+			bool bFacingUp)
+		{
+			GLuint center = nVertices;
+			double normalY = bFacingUp ? 1.0 : -1.0;
+
+			WriteVertex(mesh, nVertices, 0.0, y, 0.0, 0.0, normalY, 0.0, 0.5, 0.5);
+			for (int i = 0; i < segments; i++)
+			{
+				double angle = (2.0 * PI * i) / segments;
+				double c = Cosine(angle);
+				double s = Sine(angle);
+				WriteVertex(mesh, nVertices, radius * c, y, -radius * s, 0.0, normalY, 0.0,
+					0.5 - (0.5 * s), 0.5 + (0.5 * c));
+			}
+
+			for (int i = 0; i < segments; i++)
+			{
+				GLuint current = center + 1 + i;
+				GLuint next = center + 1 + ((i + 1) % segments);
+				if (bFacingUp == true)
+				{
+					WriteTriangle(mesh, nIndices, center, current, next);
+				}
+				else
+				{
+					WriteTriangle(mesh, nIndices, center, next, current);
+				}
+			}
+		}
+	}
+
+	///////////////////////////////////////////////////
+	//	WriteSphere()
+	//
+	//	Write a unit sphere with rings of latitude from
+	//  the top pole down.  The seam repeats the first
+	//  column of vertices so the texture wraps, and the
+	//  triangles that touch the poles are skipped since
+	//  their pole edge has no length.  The mesh needs
+	//  room for SphereVertexCount() vertices and for
+	//  SphereIndexCount() indices.
+	///////////////////////////////////////////////////
+	template<typename MESH>
+	constexpr void WriteSphere(int rings, int sectors, MESH& mesh)
+	{
+		GLuint nVertices = 0;
+		GLuint nIndices = 0;
+
+		for (int ring = 0; ring <= rings; ring++)
+		{
+			double polar = (Detail::PI * ring) / rings;
+			double y = Detail::Cosine(polar);
+			double ringRadius = Detail::Sine(polar);
+
+			for (int sector = 0; sector <= sectors; sector++)
+			{
+				double azimuth = (2.0 * Detail::PI * sector) / sectors;
+				double x = ringRadius * Detail::Sine(azimuth);
+				double z = ringRadius * Detail::Cosine(azimuth);
+
+				Detail::WriteVertex(mesh, nVertices, x, y, z, x, y, z,
+					(double)sector / sectors, 1.0 - ((double)ring / rings));
+			}
+		}
+
+		for (int ring = 0; ring < rings; ring++)
+		{
+			for (int sector = 0; sector < sectors; sector++)
+			{
+				GLuint topLeft = (GLuint)((ring * (sectors + 1)) + sector);
+				GLuint bottomLeft = topLeft + sectors + 1;
+
+				if (ring != 0)
+				{
+					Detail::WriteTriangle(mesh, nIndices, topLeft, bottomLeft, topLeft + 1);
+				}
+				if (ring != (rings - 1))
+				{
+					Detail::WriteTriangle(mesh, nIndices, topLeft + 1, bottomLeft, bottomLeft + 1);
+				}
+			}
+		}
+
+		mesh.topFirstIndex = 0;
+		mesh.topIndexCount = 0;
+		mesh.bottomFirstIndex = 0;
+		mesh.bottomIndexCount = 0;
+		mesh.sidesFirstIndex = 0;
+		mesh.sidesIndexCount = nIndices;
+	}
+
+	///////////////////////////////////////////////////
+	//	WriteCylinder()
+	//
+	//	Write a cylinder, tapered cylinder or cone.  The
+	//  indices hold the top cap, the sides and then the
+	//  bottom cap, so that every combination of parts
+	//  except the two caps alone is one contiguous
+	//  range, and the angle runs from the +X axis
+	//  towards -Z like the texture of the caps.  Cones
+	//  are textured like their bottom cap seen from
+	//  above, with the tip in the middle.  The mesh needs
+	//  room for CylinderVertexCount() vertices and for
+	//  CylinderIndexCount() indices.
+	///////////////////////////////////////////////////
+	template<typename MESH>
+	constexpr void WriteCylinder(int segments, double topRadius, MESH& mesh)
+	{
+		const bool bHasTop = (topRadius > 0.0);
+		// the side normals lean up by the change of radius over the height
+		const double slope = 1.0 - topRadius;
+		const double normalScale = 1.0 / Detail::SquareRoot(1.0 + (slope * slope));
+		GLuint nVertices = 0;
+		GLuint nIndices = 0;
+
+		mesh.topFirstIndex = nIndices;
+		if (bHasTop == true)
+		{
+			Detail::WriteCap(mesh, nVertices, nIndices, segments, 1.0, topRadius, true);
+		}
+		mesh.topIndexCount = nIndices - mesh.topFirstIndex;
+
+		GLuint first = nVertices;
+		for (int i = 0; i <= segments; i++)
+		{
+			double angle = (2.0 * Detail::PI * i) / segments;
+			double c = Detail::Cosine(angle);
+			double s = Detail::Sine(angle);
+			double nx = c * normalScale;
+			double ny = slope * normalScale;
+			double nz = -s * normalScale;
+
+			if (bHasTop == true)
+			{
+				double u = (double)i / segments;
+				Detail::WriteVertex(mesh, nVertices, c, 0.0, -s, nx, ny, nz, u, 0.0);
+				Detail::WriteVertex(mesh, nVertices, topRadius * c, 1.0, -topRadius * s, nx, ny, nz, u, 1.0);
+			}
+			else
+			{
+				Detail::WriteVertex(mesh, nVertices, c, 0.0, -s, nx, ny, nz, 0.5 - (0.5 * s), 0.5 + (0.5 * c));
+				Detail::WriteVertex(mesh, nVertices, 0.0, 1.0, 0.0, nx, ny, nz, 0.5, 0.5);
+			}
+		}
+
+		mesh.sidesFirstIndex = nIndices;
+		for (int i = 0; i < segments; i++)
+		{
+			GLuint bottom = first + (i * 2);
+			GLuint top = bottom + 1;
+
+			Detail::WriteTriangle(mesh, nIndices, bottom, bottom + 2, top);
+			if (bHasTop == true)
+			{
+				Detail::WriteTriangle(mesh, nIndices, top, bottom + 2, top + 2);
+			}
+		}
+		mesh.sidesIndexCount = nIndices - mesh.sidesFirstIndex;
+
+		mesh.bottomFirstIndex = nIndices;
+		Detail::WriteCap(mesh, nVertices, nIndices, segments, 0.0, 1.0, false);
+		mesh.bottomIndexCount = nIndices - mesh.bottomFirstIndex;
+	}
+
+	///////////////////////////////////////////////////
+	//	WriteTorus()
+	//
+	//	Write a torus in the XY plane.  The triangles
+	//  follow the main ring, so half of the indices
+	//  draw half of the torus.  The mesh needs room for
+	//  TorusVertexCount() vertices and for
+	//  TorusIndexCount() indices.
+	///////////////////////////////////////////////////
+	template<typename MESH>
+	constexpr void WriteTorus(int mainSegments, int tubeSegments, double tubeRadius, MESH& mesh)
+	{
+		GLuint nVertices = 0;
+		GLuint nIndices = 0;
+
+		for (int i = 0; i <= mainSegments; i++)
+		{
+			double mainAngle = (2.0 * Detail::PI * i) / mainSegments;
+			double cosMain = Detail::Cosine(mainAngle);
+			double sinMain = Detail::Sine(mainAngle);
+
+			for (int j = 0; j <= tubeSegments; j++)
+			{
+				double tubeAngle = (2.0 * Detail::PI * j) / tubeSegments;
+				double cosTube = Detail::Cosine(tubeAngle);
+				double sinTube = Detail::Sine(tubeAngle);
+				double ringDistance = 1.0 + (tubeRadius * cosTube);
+
+				Detail::WriteVertex(mesh, nVertices,
+					ringDistance * cosMain, ringDistance * sinMain, tubeRadius * sinTube,
+					cosTube * cosMain, cosTube * sinMain, sinTube,
+					(double)i / mainSegments, (double)j / tubeSegments);
+			}
+		}
+
+		for (int i = 0; i < mainSegments; i++)
+		{
+			for (int j = 0; j < tubeSegments; j++)
+			{
+				GLuint current = (GLuint)((i * (tubeSegments + 1)) + j);
+				GLuint next = current + tubeSegments + 1;
+
+				Detail::WriteTriangle(mesh, nIndices, current, next, current + 1);
+				Detail::WriteTriangle(mesh, nIndices, current + 1, next, next + 1);
+			}
+		}
+
+		mesh.topFirstIndex = 0;
+		mesh.topIndexCount = 0;
+		mesh.bottomFirstIndex = 0;
+		mesh.bottomIndexCount = 0;
+		mesh.sidesFirstIndex = 0;
+		mesh.sidesIndexCount = nIndices;
+	}
+
+	///////////////////////////////////////////////////
+	//	MakeSphere() / MakeCylinder() / MakeCone() /
+	//	MakeTorus()
+	//
+	//	Build a shape of a fixed resolution as a static
+	//  mesh, so it can be a constexpr variable that is
+	//  built by the compiler.
+	///////////////////////////////////////////////////
+	template<int RINGS, int SECTORS>
+	constexpr StaticMesh<SphereVertexCount(RINGS, SECTORS), SphereIndexCount(RINGS, SECTORS)> MakeSphere()
+	{
+		StaticMesh<SphereVertexCount(RINGS, SECTORS), SphereIndexCount(RINGS, SECTORS)> mesh{};
+		WriteSphere(RINGS, SECTORS, mesh);
+		return mesh;
+	}
+
+	// the top radius has to be above zero
+	template<int SEGMENTS>
+	constexpr StaticMesh<CylinderVertexCount(SEGMENTS, true), CylinderIndexCount(SEGMENTS, true)> MakeCylinder(
+		double topRadius)
+	{
+		StaticMesh<CylinderVertexCount(SEGMENTS, true), CylinderIndexCount(SEGMENTS, true)> mesh{};
+		WriteCylinder(SEGMENTS, topRadius, mesh);
+		return mesh;
+	}
+
+	template<int SEGMENTS>
+	constexpr StaticMesh<CylinderVertexCount(SEGMENTS, false), CylinderIndexCount(SEGMENTS, false)> MakeCone()
+	{
+		StaticMesh<CylinderVertexCount(SEGMENTS, false), CylinderIndexCount(SEGMENTS, false)> mesh{};
+		WriteCylinder(SEGMENTS, 0.0, mesh);
+		return mesh;
+	}
+
+	template<int MAIN_SEGMENTS, int TUBE_SEGMENTS>
+	constexpr StaticMesh<TorusVertexCount(MAIN_SEGMENTS, TUBE_SEGMENTS), TorusIndexCount(MAIN_SEGMENTS, TUBE_SEGMENTS)> MakeTorus(
+		double tubeRadius)
+	{
+		StaticMesh<TorusVertexCount(MAIN_SEGMENTS, TUBE_SEGMENTS), TorusIndexCount(MAIN_SEGMENTS, TUBE_SEGMENTS)> mesh{};
+		WriteTorus(MAIN_SEGMENTS, TUBE_SEGMENTS, tubeRadius, mesh);
+		return mesh;
+	}
+}
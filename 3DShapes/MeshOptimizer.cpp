@@ -0,0 +1,466 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder the triangles and vertices of indexed meshes for the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+namespace
+{
+	// marks a vertex that has not been given a new position yet
+	const unsigned int g_Unmapped = 0xFFFFFFFFu;
+
+	///////////////////////////////////////////////////
+	//	TransformVertex()
+	//
+	//	Simulate the FIFO post-transform cache for one
+	//  vertex.  A vertex is in the cache while fewer
+	//  than cacheSize other vertices were added since
+	//  it was, so hits do not move it.  Returns 1 when
+	//  the vertex had to be transformed.
+	///////////////////////////////////////////////////
+	unsigned int TransformVertex(
+		unsigned int vertex,
+		std::vector<unsigned int>& cacheTime,
+		unsigned int& timeStamp,
+		unsigned int cacheSize)
+	{
+		if ((timeStamp - cacheTime[vertex]) > cacheSize)
+		{
+			cacheTime[vertex] = timeStamp;
+			timeStamp++;
+			return(1);
+		}
+
+		return(0);
+	}
+
+	///////////////////////////////////////////////////
+	//	SkipDeadEnd()
+	//
+	//	Find the next vertex to fan around when none of
+	//  the vertices of the last fan are usable - the
+	//  most recently used vertex that still has
+	//  triangles left, else the next such vertex in
+	//  input order.  Returns -1 when all triangles are
+	//  emitted.
+	///////////////////////////////////////////////////
+	int SkipDeadEnd(
+		const std::vector<unsigned int>& liveTriangles,
+		std::vector<unsigned int>& deadEnd,
+		size_t& cursor)
+	{
+		while (deadEnd.empty() == false)
+		{
+			unsigned int vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[vertex] > 0)
+			{
+				return((int)vertex);
+			}
+		}
+
+		while (cursor < liveTriangles.size())
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return((int)cursor);
+			}
+			cursor++;
+		}
+
+		return(-1);
+	}
+}
+
+///////////////////////////////////////////////////
+//	AnalyzeVertexCache()
+//
+//	Count the vertex transforms of a triangle list
+//  with a FIFO post-transform cache.
+///////////////////////////////////////////////////
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(
+	const unsigned int* indices,
+	size_t nIndices,
+	size_t nVertices,
+	unsigned int cacheSize)
+{
+	VertexCacheStats stats;
+	std::vector<unsigned int> cacheTime(nVertices, 0);
+	std::vector<unsigned char> used(nVertices, 0);
+	unsigned int timeStamp = cacheSize + 1;
+
+	stats.nTriangles = (unsigned int)(nIndices / 3);
+	for (size_t i = 0; i < (size_t)stats.nTriangles * 3; i++)
+	{
+		unsigned int vertex = indices[i];
+		if (vertex >= nVertices)
+		{
+			continue;
+		}
+
+		if (used[vertex] == 0)
+		{
+			used[vertex] = 1;
+			stats.nVertices++;
+		}
+		stats.nTransforms += TransformVertex(vertex, cacheTime, timeStamp, cacheSize);
+	}
+
+	if (stats.nTriangles > 0)
+	{
+		stats.acmr = (float)stats.nTransforms / (float)stats.nTriangles;
+	}
+	if (stats.nVertices > 0)
+	{
+		stats.atvr = (float)stats.nTransforms / (float)stats.nVertices;
+	}
+
+	return(stats);
+}
+
+///////////////////////////////////////////////////
+//	OptimizeVertexCache()
+//
+//	Reorder the triangles with Tipsify.  All of the
+//  remaining triangles around the current vertex are
+//  emitted as a fan, then the fan continues from the
+//  one of its vertices that will still be in the
+//  cache after its own remaining triangles are
+//  emitted and that entered the cache first.
+///////////////////////////////////////////////////
+void MeshOptimizer::OptimizeVertexCache(
+	unsigned int* indices,
+	size_t nIndices,
+	size_t nVertices,
+	std::vector<unsigned int>& clusters,
+	unsigned int cacheSize)
+{
+	const size_t nTriangles = nIndices / 3;
+
+	clusters.clear();
+	if ((nTriangles == 0) || (nVertices == 0))
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < nTriangles * 3; i++)
+	{
+		if (indices[i] >= nVertices)
+		{
+			// leave lists with invalid indices as they are
+			clusters.push_back(0);
+			return;
+		}
+	}
+
+	// the triangles that use each vertex, stored one vertex
+	// after another with the start of each in the offsets
+	std::vector<unsigned int> offsets(nVertices + 1, 0);
+	for (size_t i = 0; i < nTriangles * 3; i++)
+	{
+		offsets[indices[i] + 1]++;
+	}
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+
+	std::vector<unsigned int> adjacency(nTriangles * 3);
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t t = 0; t < nTriangles; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			adjacency[fill[indices[(t * 3) + k]]++] = (unsigned int)t;
+		}
+	}
+
+	std::vector<unsigned int> liveTriangles(nVertices);
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		liveTriangles[v] = offsets[v + 1] - offsets[v];
+	}
+
+	std::vector<unsigned int> cacheTime(nVertices, 0);
+	std::vector<unsigned char> emitted(nTriangles, 0);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	deadEnd.reserve(nTriangles * 3);
+	output.reserve(nTriangles * 3);
+
+	unsigned int timeStamp = cacheSize + 1;
+	size_t cursor = 0;
+	int fanning = SkipDeadEnd(liveTriangles, deadEnd, cursor);
+	clusters.push_back(0);
+
+	while (fanning >= 0)
+	{
+		// emit the remaining triangles around the fanning vertex
+		candidates.clear();
+		for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+		{
+			unsigned int triangle = adjacency[a];
+			if (emitted[triangle] != 0)
+			{
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int vertex = indices[(triangle * 3) + k];
+				output.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				TransformVertex(vertex, cacheTime, timeStamp, cacheSize);
+			}
+			emitted[triangle] = 1;
+		}
+
+		// continue from the oldest candidate that stays in the cache
+		int next = -1;
+		int bestPriority = -1;
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			unsigned int vertex = candidates[c];
+			if (liveTriangles[vertex] == 0)
+			{
+				continue;
+			}
+
+			int priority = 0;
+			unsigned int age = timeStamp - cacheTime[vertex];
+			if ((age + (2 * liveTriangles[vertex])) <= cacheSize)
+			{
+				priority = (int)age;
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = (int)vertex;
+			}
+		}
+
+		if (next < 0)
+		{
+			next = SkipDeadEnd(liveTriangles, deadEnd, cursor);
+			if ((next >= 0) && (output.size() < nTriangles * 3))
+			{
+				clusters.push_back((unsigned int)(output.size() / 3));
+			}
+		}
+		fanning = next;
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+///////////////////////////////////////////////////
+//	OptimizeOverdraw()
+//
+//	Split the vertex cache clusters wherever the cache
+//  miss ratio so far is within the threshold of the
+//  whole cluster, then sort the pieces by how far
+//  their average normal points away from the center
+//  of the mesh.  Pieces on the outside of a convex
+//  part are drawn first and hide the ones behind.
+///////////////////////////////////////////////////
+void MeshOptimizer::OptimizeOverdraw(
+	unsigned int* indices,
+	size_t nIndices,
+	const float* vertices,
+	size_t nVertices,
+	size_t floatsPerVertex,
+	const std::vector<unsigned int>& clusters,
+	unsigned int cacheSize,
+	float threshold)
+{
+	const size_t nTriangles = nIndices / 3;
+
+	if ((nTriangles == 0) || (clusters.empty() == true))
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < nTriangles * 3; i++)
+	{
+		if (indices[i] >= nVertices)
+		{
+			return;
+		}
+	}
+
+	// split the clusters where the cache order allows it
+	std::vector<unsigned int> pieces;
+	std::vector<unsigned int> cacheTime(nVertices, 0);
+	unsigned int timeStamp = cacheSize + 1;
+
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		size_t start = clusters[c];
+		size_t end = ((c + 1) < clusters.size()) ? clusters[c + 1] : nTriangles;
+		if (start >= end)
+		{
+			continue;
+		}
+
+		// cache misses of the whole cluster, from an empty cache
+		unsigned int clusterMisses = 0;
+		timeStamp += cacheSize + 1;
+		for (size_t i = start * 3; i < end * 3; i++)
+		{
+			clusterMisses += TransformVertex(indices[i], cacheTime, timeStamp, cacheSize);
+		}
+		float pieceThreshold = threshold * (float)clusterMisses / (float)(end - start);
+
+		unsigned int pieceMisses = 0;
+		size_t pieceStart = start;
+		timeStamp += cacheSize + 1;
+		pieces.push_back((unsigned int)start);
+		for (size_t t = start; t < end; t++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				pieceMisses += TransformVertex(indices[(t * 3) + k], cacheTime, timeStamp, cacheSize);
+			}
+
+			if (((t + 1) < end) && ((float)pieceMisses <= pieceThreshold * (float)(t + 1 - pieceStart)))
+			{
+				pieces.push_back((unsigned int)(t + 1));
+				pieceStart = t + 1;
+				pieceMisses = 0;
+				timeStamp += cacheSize + 1;
+			}
+		}
+	}
+	pieces.push_back((unsigned int)nTriangles);
+
+	// area weighted centroid and normal of each piece
+	const size_t nPieces = pieces.size() - 1;
+	std::vector<glm::vec3> centroids(nPieces, glm::vec3(0.0f));
+	std::vector<glm::vec3> normals(nPieces, glm::vec3(0.0f));
+	std::vector<float> areas(nPieces, 0.0f);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t p = 0; p < nPieces; p++)
+	{
+		for (size_t t = pieces[p]; t < pieces[p + 1]; t++)
+		{
+			const float* p0 = vertices + (indices[(t * 3) + 0] * floatsPerVertex);
+			const float* p1 = vertices + (indices[(t * 3) + 1] * floatsPerVertex);
+			const float* p2 = vertices + (indices[(t * 3) + 2] * floatsPerVertex);
+			glm::vec3 v0(p0[0], p0[1], p0[2]);
+			glm::vec3 v1(p1[0], p1[1], p1[2]);
+			glm::vec3 v2(p2[0], p2[1], p2[2]);
+
+			glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+			float area = glm::length(normal);
+
+			centroids[p] += (v0 + v1 + v2) * (area / 3.0f);
+			normals[p] += normal;
+			areas[p] += area;
+		}
+
+		meshCentroid += centroids[p];
+		meshArea += areas[p];
+		if (areas[p] > 0.0f)
+		{
+			centroids[p] *= 1.0f / areas[p];
+		}
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentroid *= 1.0f / meshArea;
+	}
+
+	std::vector<float> sortKeys(nPieces, 0.0f);
+	std::vector<unsigned int> order(nPieces);
+	for (size_t p = 0; p < nPieces; p++)
+	{
+		float normalLength = glm::length(normals[p]);
+		if (normalLength > 0.0f)
+		{
+			sortKeys[p] = glm::dot(centroids[p] - meshCentroid, normals[p]) / normalLength;
+		}
+		order[p] = (unsigned int)p;
+	}
+
+	std::stable_sort(order.begin(), order.end(),
+		[&sortKeys](unsigned int a, unsigned int b) { return(sortKeys[a] > sortKeys[b]); });
+
+	// write the triangles of the pieces in the sorted order
+	std::vector<unsigned int> output;
+	output.reserve(nTriangles * 3);
+	for (size_t p = 0; p < nPieces; p++)
+	{
+		unsigned int piece = order[p];
+		output.insert(output.end(), indices + (pieces[piece] * 3), indices + (pieces[piece + 1] * 3));
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+///////////////////////////////////////////////////
+//	OptimizeVertexFetch()
+//
+//	Store the vertices in the order the indices first
+//  use them, so neighboring triangles read
+//  neighboring memory.
+///////////////////////////////////////////////////
+size_t MeshOptimizer::OptimizeVertexFetch(
+	float* vertices,
+	size_t nVertices,
+	size_t floatsPerVertex,
+	unsigned int* indices,
+	size_t nIndices)
+{
+	std::vector<unsigned int> remap(nVertices, g_Unmapped);
+	unsigned int nUsed = 0;
+
+	for (size_t i = 0; i < nIndices; i++)
+	{
+		if (indices[i] >= nVertices)
+		{
+			// an invalid index would make the remap incomplete
+			return(nVertices);
+		}
+	}
+
+	for (size_t i = 0; i < nIndices; i++)
+	{
+		unsigned int& newIndex = remap[indices[i]];
+		if (newIndex == g_Unmapped)
+		{
+			newIndex = nUsed;
+			nUsed++;
+		}
+		indices[i] = newIndex;
+	}
+
+	unsigned int nextUnused = nUsed;
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		if (remap[v] == g_Unmapped)
+		{
+			remap[v] = nextUnused;
+			nextUnused++;
+		}
+	}
+
+	std::vector<float> source(vertices, vertices + (nVertices * floatsPerVertex));
+	for (size_t v = 0; v < nVertices; v++)
+	{
+		std::copy(source.begin() + (v * floatsPerVertex), source.begin() + ((v + 1) * floatsPerVertex),
+			vertices + ((size_t)remap[v] * floatsPerVertex));
+	}
+
+	return(nUsed);
+}
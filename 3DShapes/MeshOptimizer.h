@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder the triangles and vertices of indexed meshes for the GPU
+//
+// The triangles are first reordered for the post-transform vertex cache with
+// Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+// Locality and Reduced Overdraw", 2007), which fans around one vertex at a
+// time and only needs a cache size, not a model of a particular GPU.  The
+// clusters it produces are then sorted so the ones facing away from the
+// center of the mesh come first, which lets the depth test reject more of the
+// hidden fragments, and the vertices are finally stored in the order they are
+// first used so the vertex fetch reads memory front to back.
+//
+// Everything works on plain arrays on the CPU, without an OpenGL context.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace MeshOptimizer
+{
+	// number of entries of the simulated FIFO post-transform cache
+	const unsigned int DEFAULT_CACHE_SIZE = 16;
+	// how much worse than the vertex cache order a cluster may be
+	// after it is split up for the overdraw sorting
+	const float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+	// result of simulating the post-transform cache over a mesh
+	struct VertexCacheStats
+	{
+		unsigned int nTriangles = 0;		// triangles in the index list
+		unsigned int nVertices = 0;			// distinct vertices the indices use
+		unsigned int nTransforms = 0;		// cache misses, each one transforms a vertex
+		float acmr = 0.0f;					// average cache miss ratio, transforms per triangle
+		float atvr = 0.0f;					// average transform to vertex ratio, 1.0 is ideal
+	};
+
+	// simulate a FIFO post-transform cache of the passed in size
+	// over a triangle list
+	VertexCacheStats AnalyzeVertexCache(
+		const unsigned int* indices,
+		size_t nIndices,
+		size_t nVertices,
+		unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+	// reorder the triangles of a triangle list in place for the
+	// post-transform cache, and return the first triangle of each
+	// cluster that started after a jump to an unconnected vertex
+	void OptimizeVertexCache(
+		unsigned int* indices,
+		size_t nIndices,
+		size_t nVertices,
+		std::vector<unsigned int>& clusters,
+		unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+	// sort the clusters of a vertex cache optimized triangle list in
+	// place, outward facing ones first, after splitting them where the
+	// cache miss ratio does not get worse than the threshold - the
+	// positions are the first three floats of each vertex
+	void OptimizeOverdraw(
+		unsigned int* indices,
+		size_t nIndices,
+		const float* vertices,
+		size_t nVertices,
+		size_t floatsPerVertex,
+		const std::vector<unsigned int>& clusters,
+		unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+		float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+	// reorder the vertices in place into the order the indices first
+	// use them and rewrite the indices, unused vertices are moved to
+	// the end - returns the number of used vertices
+	size_t OptimizeVertexFetch(
+		float* vertices,
+		size_t nVertices,
+		size_t floatsPerVertex,
+		unsigned int* indices,
+		size_t nIndices);
+}
@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.cpp
+// ============
+// stream per-frame data to the GPU through a persistently mapped buffer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RingBuffer.h"
+
+#include <cstddef>
+
+// declaration of global variables
+namespace
+{
+	// the buffer is written by the CPU and read by the GPU while it
+	// stays mapped, and the writes are visible without a flush
+	const GLbitfield g_MapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	// nanoseconds to wait for a fence at a time
+	const GLuint64 g_FenceTimeout = 1000000000;
+}
+
+/***********************************************************
+ *  RingBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RingBuffer::RingBuffer()
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_regionSize = 0;
+	m_regionCount = 0;
+	m_currentRegion = -1;
+	m_waitCount = 0;
+	for (int i = 0; i < MAX_REGIONS; i++)
+	{
+		m_fences[i] = NULL;
+	}
+}
+
+/***********************************************************
+ *  ~RingBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RingBuffer::~RingBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used to check for the immutable buffer
+ *  storage that persistent mapping needs.
+ ***********************************************************/
+bool RingBuffer::IsSupported()
+{
+	return((GLEW_VERSION_4_4 == GL_TRUE) || (GLEW_ARB_buffer_storage == GL_TRUE));
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used to allocate the buffer for all of
+ *  the regions and to map it once, for its whole life.
+ ***********************************************************/
+bool RingBuffer::Create(
+	GLsizeiptr regionSize,
+	int regionCount)
+{
+	Destroy();
+
+	if ((regionSize <= 0) || (regionCount < 1) || (regionCount > MAX_REGIONS) ||
+		(IsSupported() == false))
+	{
+		return(false);
+	}
+
+	const GLsizeiptr bufferSize = regionSize * regionCount;
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, NULL, g_MapFlags);
+	m_pMapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, g_MapFlags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (NULL == m_pMapped)
+	{
+		Destroy();
+		return(false);
+	}
+
+	m_regionSize = regionSize;
+	m_regionCount = regionCount;
+	m_currentRegion = -1;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to unmap and free the buffer.  The
+ *  draws that still read it keep it alive on the GPU.
+ ***********************************************************/
+void RingBuffer::Destroy()
+{
+	for (int i = 0; i < MAX_REGIONS; i++)
+	{
+		if (NULL != m_fences[i])
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = NULL;
+		}
+	}
+
+	if (0 != m_buffer)
+	{
+		if (NULL != m_pMapped)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+
+	m_pMapped = NULL;
+	m_regionSize = 0;
+	m_regionCount = 0;
+	m_currentRegion = -1;
+}
+
+/***********************************************************
+ *  BeginRegion()
+ *
+ *  This method is used to move on to the next region.  The
+ *  commands that read the previous region were all issued
+ *  before this call, so the fence placed now is signaled
+ *  once they are done.  The next region was last read
+ *  frames ago, so its fence is normally signaled already.
+ ***********************************************************/
+void* RingBuffer::BeginRegion()
+{
+	if (NULL == m_pMapped)
+	{
+		return(NULL);
+	}
+
+	if (m_currentRegion >= 0)
+	{
+		m_fences[m_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	m_currentRegion = (m_currentRegion + 1) % m_regionCount;
+
+	GLsync fence = m_fences[m_currentRegion];
+	if (NULL != fence)
+	{
+		// poll first, and only when the GPU is behind wait with the
+		// flush bit, so the fence is sure to reach the GPU
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if ((GL_ALREADY_SIGNALED != result) && (GL_CONDITION_SATISFIED != result))
+		{
+			m_waitCount++;
+			do
+			{
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+			} while (GL_TIMEOUT_EXPIRED == result);
+		}
+
+		glDeleteSync(fence);
+		m_fences[m_currentRegion] = NULL;
+	}
+
+	return(m_pMapped + GetRegionOffset());
+}
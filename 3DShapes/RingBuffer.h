@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// ringbuffer.h
+// ============
+// stream per-frame data to the GPU through a persistently mapped buffer
+//
+// The buffer is split into regions, one for each frame in flight.  The CPU
+// writes a frame straight into the mapped memory of its region, which is
+// coherent, so no unmap or flush is needed before the draws read it.  A fence
+// is placed behind the draws of each region, and a region is only written
+// again once its fence is signaled.  With three regions the CPU can run up to
+// two frames ahead of the GPU without ever waiting for it.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  RingBuffer
+ *
+ *  This class contains the code for a persistently mapped
+ *  buffer whose regions are reused in turn, guarded by
+ *  fences.
+ ***********************************************************/
+class RingBuffer
+{
+public:
+	// number of regions, one for each frame in flight
+	static const int DEFAULT_REGION_COUNT = 3;
+
+	// constructor
+	RingBuffer();
+	// destructor, frees the buffer
+	~RingBuffer();
+
+	// check whether the driver supports persistently mapped buffers
+	static bool IsSupported();
+
+	// allocate and map the buffer with the passed in number of bytes
+	// in each region, returns false when it could not be mapped
+	bool Create(
+		GLsizeiptr regionSize,
+		int regionCount = DEFAULT_REGION_COUNT);
+	// unmap and free the buffer, the GPU keeps it until it is done
+	void Destroy();
+
+	// fence the region that was written last and move on to the next
+	// one, waiting until the GPU has finished reading it - returns the
+	// mapped memory of the region
+	void* BeginRegion();
+
+	// get the OpenGL name of the buffer
+	GLuint GetBuffer() const { return m_buffer; }
+	// get the offset of the current region in the buffer
+	GLintptr GetRegionOffset() const { return (GLintptr)m_regionSize * m_currentRegion; }
+	// get the number of bytes of each region
+	GLsizeiptr GetRegionSize() const { return m_regionSize; }
+	// get the number of times a region was not free yet and the
+	// CPU had to wait for the GPU
+	int GetWaitCount() const { return m_waitCount; }
+
+private:
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	// most regions a buffer can be split into
+	static const int MAX_REGIONS = 4;
+
+	// OpenGL name and mapped memory of the buffer
+	GLuint m_buffer;
+	unsigned char* m_pMapped;
+	// bytes of each region and number of regions
+	GLsizeiptr m_regionSize;
+	int m_regionCount;
+	// region being written, -1 before the first one
+	int m_currentRegion;
+	// fence behind the last draws that read each region
+	GLsync m_fences[MAX_REGIONS];
+	// waits for the GPU so far
+	int m_waitCount;
+};
@@ -14,7 +14,12 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/packing.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <vector>
 
 namespace
@@ -24,18 +29,146 @@ namespace
 	const GLuint g_FloatsPerVertex = 3;	// Number of coordinates per vertex
 	const GLuint g_FloatsPerNormal = 3;	// Number of values per vertex color
 	const GLuint g_FloatsPerUV = 2;		// Number of texture coordinate values
+	const GLuint g_InstanceModelLocation = 3;	// First of the four model matrix attribute locations
+	const GLuint g_InstanceParamsLocation = 7;	// UV scale, material index and texture layer attribute location
+	const GLuint g_PackedNormalLocation = 8;	// octahedral normal attribute location of the packed vertices
+	const GLuint g_InstanceMVPLocation = 9;		// First of the four model view projection attribute locations
+	const GLuint g_InstanceNormalLocation = 13;	// First of the three normal matrix attribute locations
+	// binding point of the instance attributes, past the ones that
+	// glVertexAttribPointer uses for the vertex attributes
+	const GLuint g_InstanceBinding = 15;
+	// instances and commands that the rings hold at first
+	const GLsizei g_InitialRingInstances = 256;
+	const GLsizei g_InitialRingCommands = 64;
+	const float g_MaxHalfFloat = 65504.0f;		// largest value a half float position can hold
+
+	// tessellation of the generated levels of detail 1 to 3
+	const int g_SphereLodRings[] = { 12, 8, 6 };
+	const int g_SphereLodSectors[] = { 12, 10, 8 };
+	const int g_CylinderLodSegments[] = { 24, 16, 8 };
+	const int g_TorusLodMainSegments[] = { 20, 12, 8 };
+	const int g_TorusLodTubeSegments[] = { 16, 10, 6 };
+	// the cone and cylinder sides reach from radius 1 to these
+	constexpr float g_TaperedCylinderTopRadius = 0.5f;
+	constexpr float g_ConeTopRadius = 0.0f;
+
+	// the curved shapes at their default resolution, which are
+	// built by the compiler instead of at startup
+	constexpr auto g_DefaultSphere = MeshGenerator::MakeSphere<
+		MeshGenerator::DEFAULT_SPHERE_RINGS, MeshGenerator::DEFAULT_SPHERE_SECTORS>();
+	constexpr auto g_DefaultCylinder = MeshGenerator::MakeCylinder<
+		MeshGenerator::DEFAULT_CYLINDER_SEGMENTS>(1.0);
+	constexpr auto g_DefaultTaperedCylinder = MeshGenerator::MakeCylinder<
+		MeshGenerator::DEFAULT_CYLINDER_SEGMENTS>(g_TaperedCylinderTopRadius);
+	constexpr auto g_DefaultCone = MeshGenerator::MakeCone<
+		MeshGenerator::DEFAULT_CYLINDER_SEGMENTS>();
+	constexpr auto g_DefaultTorus = MeshGenerator::MakeTorus<
+		MeshGenerator::DEFAULT_TORUS_MAIN_SEGMENTS, MeshGenerator::DEFAULT_TORUS_TUBE_SEGMENTS>(
+		MeshGenerator::DEFAULT_TORUS_THICKNESS);
+
+	///////////////////////////////////////////////////
+	//	HashGenerator()
+	//
+	//	Hash everything a cached shape is generated from,
+	//  its own parameters, the tables of its levels of
+	//  detail and the version of the generator.
+	///////////////////////////////////////////////////
+	uint64_t HashGenerator(
+		int mesh,
+		const float* parameters,
+		size_t nParameters)
+	{
+		const float radii[] = { g_TaperedCylinderTopRadius, g_ConeTopRadius };
+		uint64_t hash = MeshCache::HashBytes(&MeshGenerator::GENERATOR_VERSION, sizeof(MeshGenerator::GENERATOR_VERSION));
+
+		hash = MeshCache::HashBytes(&mesh, sizeof(mesh), hash);
+		hash = MeshCache::HashBytes(parameters, sizeof(float) * nParameters, hash);
+		hash = MeshCache::HashBytes(g_SphereLodRings, sizeof(g_SphereLodRings), hash);
+		hash = MeshCache::HashBytes(g_SphereLodSectors, sizeof(g_SphereLodSectors), hash);
+		hash = MeshCache::HashBytes(g_CylinderLodSegments, sizeof(g_CylinderLodSegments), hash);
+		hash = MeshCache::HashBytes(g_TorusLodMainSegments, sizeof(g_TorusLodMainSegments), hash);
+		hash = MeshCache::HashBytes(g_TorusLodTubeSegments, sizeof(g_TorusLodTubeSegments), hash);
+		hash = MeshCache::HashBytes(radii, sizeof(radii), hash);
+
+		return(hash);
+	}
+
+	///////////////////////////////////////////////////
+	void AppendTriangleFan(std::vector<GLuint>& indices, GLuint first, GLuint count)
+	{
+		for (GLuint i = 1; (i + 1) < count; i++)
+		{
+			indices.push_back(first);
+			indices.push_back(first + i);
+			indices.push_back(first + i + 1);
+		}
+	}
+
+	///////////////////////////////////////////////////
+	//	AppendTriangleStrip()
+	//
+	//	Append the triangle list indices that draw the
+	//  same triangles as a triangle strip.  Every other
+	//  triangle is flipped to keep the strip winding.
+	///////////////////////////////////////////////////
+	void AppendTriangleStrip(std::vector<GLuint>& indices, GLuint first, GLuint count)
+	{
+		for (GLuint i = 0; (i + 2) < count; i++)
+		{
+			if ((i % 2) == 0)
+			{
+				indices.push_back(first + i);
+				indices.push_back(first + i + 1);
+			}
+			else
+			{
+				indices.push_back(first + i + 1);
+				indices.push_back(first + i);
+			}
+			indices.push_back(first + i + 2);
+		}
+	}
 }
 
 ShapeMeshes::ShapeMeshes()
 {
 	m_bMemoryLayoutDone = false;
+	m_vao = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_bBuffersDirty = false;
+	m_packedVAO = 0;
+	m_packedVertexBuffer = 0;
+	m_instanceVBO = 0;
+	m_instanceCapacity = 0;
+	m_indirectBuffer = 0;
+	m_indirectCapacity = 0;
+	m_indirectOffset = 0;
+	m_boundInstanceBuffer = 0;
+	m_boundInstanceOffset = 0;
+	m_nSharedVertices = 0;
+	m_nSharedIndices = 0;
+}
+
+///////////////////////////////////////////////////
+//	~ShapeMeshes()
+//
+//	Close the mapped mesh cache files.
+///////////////////////////////////////////////////
+ShapeMeshes::~ShapeMeshes()
+{
+	for (size_t i = 0; i < m_cacheFiles.size(); i++)
+	{
+		delete m_cacheFiles[i];
+	}
+	m_cacheFiles.clear();
 }
 
 ///////////////////////////////////////////////////
 //	LoadBoxMesh()
 //
 //	Create a box mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//  add it to the shared buffers.  The normals and texture
 //  coordinates are also set.
 //
 //	Correct triangle drawing command:
@@ -105,476 +238,82 @@ void ShapeMeshes::LoadBoxMesh()
 	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_BoxMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshData(m_BoxMesh, verts, m_BoxMesh.nVertices, indices, m_BoxMesh.nIndices);
+	OptimizeMeshData(m_BoxMesh, false);
 }
 
 ///////////////////////////////////////////////////
 //	LoadConeMesh()
 //
-//	Create a cole mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//  Correct triangle drawing commands:
-//
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
+//	Create a cone mesh with the passed in number of
+//  segments around its side and add it to the shared
+//  buffers.  The default resolution is built by the
+//  compiler, any other one is generated here.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadConeMesh()
+void ShapeMeshes::LoadConeMesh(int segments)
 {
-	GLfloat verts[] = {
-		// cone bottom			// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cone sides		// normals									// texture coords
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		1.0f,0.5f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.0f, -0.116841137f, 		0.983f,0.6f,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f, 		0.983f,0.6f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f, 		0.96f,0.68f,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f, 		0.96f,0.68f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f, 		0.92f,0.77f,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f, 		0.92f,0.77f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f, 		0.87f, 0.83f,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f, 		0.87f, 0.83f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f, 		0.83f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f, 		0.83f, 0.87f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f, 		0.77f, 0.92f,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f, 		0.77f, 0.92f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f, 		0.68f, 0.96f,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f, 		0.68f, 0.96f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f, 		0.6f, 0.983f,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f, 		0.6f, 0.983f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 1.0f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, -0.993150651f, 		0.5f, 0.5f,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f, 		0.41f, 0.983f,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f, 		0.41f, 0.983f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, -0.973417103f, 		0.5f, 0.5f,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f, 		0.33f, 0.96f,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f, 		0.33f, 0.96f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, -0.916157305f, 		0.5f, 0.5f,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f, 		0.25f, 0.92f,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f, 		0.25f, 0.92f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, -0.813733339f, 		0.5f, 0.5f,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f, 		0.17f, 0.87f,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f, 		0.17f, 0.87f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, -0.707106769f, 		0.5f, 0.5f,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f, 		0.13f, 0.83f,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f, 		0.13f, 0.83f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, -0.581238329f, 		0.5f, 0.5f,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f, 		0.08f, 0.77f,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f, 		0.08f, 0.77f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, -0.400818795f, 		0.5f, 0.5f,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f, 		0.04f, 0.68f,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f, 		0.04f, 0.68f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, -0.229039446f, 		0.5f, 0.5f,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f, 		0.017f, 0.6f,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f, 		0.017f, 0.6f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.5f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f, 		0.0f, 0.5f,
-		0.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f, 		0.5f, 0.5f,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f, 		0.017f, 0.41f,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f, 		0.017f, 0.41f,
-		0.0f, 1.0f, 0.0f,		-0.973417103f, 0.0f, 0.229039446f, 		0.5f, 0.5f,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f, 		0.04f, 0.33f,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f, 		0.04f, 0.33f,
-		0.0f, 1.0f, 0.0f,		-0.916157305f, 0.0f, 0.400818795f, 		0.5f, 0.5f,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f, 		0.08f, 0.25f,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f, 		0.08f, 0.25f,
-		0.0f, 1.0f, 0.0f,		-0.813733339f, 0.0f, 0.581238329f, 		0.5f, 0.5f,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f, 		0.13f, 0.17f,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f, 		0.13f, 0.17f,
-		0.0f, 1.0f, 0.0f,		-0.707106769f, 0.0f, 0.707106769f, 		0.5f, 0.5f,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f, 		0.17f, 0.13f,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f, 		0.17f, 0.13f,
-		0.0f, 1.0f, 0.0f,		-0.581238329f, 0.0f, 0.813733339f, 		0.5f, 0.5f,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f, 		0.25f, 0.08f,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f, 		0.25f, 0.08f,
-		0.0f, 1.0f, 0.0f,		-0.400818795f, 0.0f, 0.916157305f, 		0.5f, 0.5f,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f, 		0.33f, 0.04f,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f, 		0.33f, 0.04f,
-		0.0f, 1.0f, 0.0f,		-0.229039446f, 0.0f, 0.973417103f, 		0.5f, 0.5f,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f, 		0.41f, 0.017f,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f, 		0.41f, 0.017f,
-		0.0f, 1.0f, 0.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.5f,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.0f, 0.993150651f, 		0.5f, 0.0f,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.0f,
-		0.0f, 1.0f, 0.0f,		0.116841137f, 0.0f, 0.993150651f, 	0.5f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f, 	0.6f, 0.017f,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f, 	0.6f, 0.017f,
-		0.0f, 1.0f, 0.0f,		0.229039446f, 0.0f, 0.973417103f, 	0.5f, 0.5f,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f, 	0.68f, 0.04f,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f, 	0.68f, 0.04f,
-		0.0f, 1.0f, 0.0f,		0.400818795f, 0.0f, 0.916157305f, 	0.5f, 0.5f,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f, 	0.77f, 0.08f,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f, 	0.77f, 0.08f,
-		0.0f, 1.0f, 0.0f,		0.581238329f, 0.0f, 0.813733339f, 	0.5f, 0.5f,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f, 	0.83f, 0.13f,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f, 	0.83f, 0.13f,
-		0.0f, 1.0f, 0.0f,		0.707106769f, 0.0f, 0.707106769f, 	0.5f, 0.5f,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f, 	0.87f, 0.17f,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f, 	0.87f, 0.17f,
-		0.0f, 1.0f, 0.0f,		0.813733339f, 0.0f, 0.581238329f, 	0.5f, 0.5f,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f, 	0.92f, 0.25f,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f, 	0.92f, 0.25f,
-		0.0f, 1.0f, 0.0f,		0.916157305f, 0.0f, 0.400818795f, 	0.5f, 0.5f,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f, 	0.96f, 0.33f,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f, 	0.96f, 0.33f,
-		0.0f, 1.0f, 0.0f,		0.973417103f, 0.0f, 0.229039446f, 	0.5f, 0.5f,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f, 	0.983f, 0.41f,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f, 	0.983f, 0.41f,
-		0.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	0.5f, 0.5f,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f, 	1.0f, 0.5f
-	};
-
-	// store vertex and index count
-	m_ConeMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_ConeMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_ConeMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	const std::string cacheName = "cone_" + std::to_string(segments);
+	const float parameters[] = { (float)segments };
+	const uint64_t generatorHash = HashGenerator(MESH_CONE, parameters, 1);
+	if (LoadCachedMesh(MESH_CONE, cacheName, generatorHash) == true)
+	{
+		return;
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	if (segments == MeshGenerator::DEFAULT_CYLINDER_SEGMENTS)
 	{
-		SetShaderMemoryLayout();
+		AddGeneratedMesh(m_ConeMesh, MeshGenerator::GetMeshView(g_DefaultCone));
+	}
+	else
+	{
+		MeshGenerator::MeshData data;
+		MeshGenerator::GenerateCylinder(segments, g_ConeTopRadius, data);
+		AddGeneratedMesh(m_ConeMesh, MeshGenerator::GetMeshView(data));
 	}
+
+	GenerateMeshLods(MESH_CONE);
+	SaveCachedMesh(MESH_CONE, cacheName, generatorHash);
 }
 
 ///////////////////////////////////////////////////
 //	LoadCylinderMesh()
 //
-//	Create a cylinder mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//  Correct triangle drawing commands:
-//
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//	Create a cylinder mesh with the passed in number
+//  of segments around its side and add it to the
+//  shared buffers.  The default resolution is built
+//  by the compiler, any other one is generated here.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadCylinderMesh()
+void ShapeMeshes::LoadCylinderMesh(int segments)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 1.0f, -0.34f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 1.0f, -0.64f,		0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 1.0f, -0.77f,		0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 1.0f, -0.94f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 1.0f, -0.98f,		0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -1.0f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 1.0f, -0.98f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 1.0f, -0.94f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 1.0f, -0.87f,		0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 1.0f, -0.77f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 1.0f, -0.64f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 1.0f, -0.34f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 1.0f, 0.98f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 1.0f, 0.94f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 1.0f, 0.87f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 1.0f, 0.77f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 1.0f, 0.64f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 1.0f, 0.34f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651f, 0.5f, -0.116841137f,	0.0277,0.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.5f, -0.116841137f,	0.0,1.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,1.0,
-		.98f, 0.0f, -0.17f,		0.973417103f, 0.5f, -0.229039446f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.973417103f, 0.0f, -0.229039446f,	0.0554,0.0,
-		.98f, 1.0f, -0.17f,		0.973417103f, 0.0f, -0.229039446f,	0.0277,1.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.94f, 0.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.916157305f, 0.0f, -0.400818795f,	0.0831,0.0,
-		.94f, 1.0f, -0.34f,		0.916157305f, 0.0f, -0.400818795f,	0.0554,1.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.0f, -0.581238329f,	0.1108,0.0,
-		.87f, 1.0f, -0.5f,		0.813733339f, 0.0f, -0.581238329f,	0.0831,1.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.77f, 0.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.0f, -0.707106769f,	0.1385,0.0,
-		.77f, 1.0f, -0.64f,		0.707106769f, 0.0f, -0.707106769f,	0.1108,1.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,1.0,
-		.64f, 0.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.581238329f, 0.0f, -0.813733339f,	0.1662,0.0,
-		.64f, 1.0f, -0.77f,		0.581238329f, 0.0f, -0.813733339f,	0.1385, 1.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.0f, -0.916157305f,	0.1939, 0.0,
-		.5f, 1.0f, -0.87f,		0.400818795f, 0.0f, -0.916157305f,	0.1662, 1.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.34f, 0.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.0f, -0.973417103f,	0.2216, 0.0,
-		.34f, 1.0f, -0.94f,		0.229039446f, 0.0f, -0.973417103f,	0.1939, 1.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		.17f, 0.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		.17f, 1.0f, -0.98f,		0.116841137f, 0.0f, -0.993150651f,	0.2216, 1.0,
-		0.0f, 1.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		0.0f, 0.0f, -1.0f,		0.116841137f, 0.0f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.0f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -1.0f,		-0.116841137f, 0.0f, -0.993150651f,	0.2493, 1.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.0f, -0.973417103f,	0.3047, 0.0,
-		-.17f, 1.0f, -0.98f,	-0.229039446f, 0.0f, -0.973417103f,	0.277, 1.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.400818795f, 0.0f, -0.916157305f,	0.3324, 0.0,
-		-.34f, 1.0f, -0.94f,	-0.400818795f, 0.0f, -0.916157305f,	0.3047, 1.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.0f, -0.813733339f,	0.3601, 0.0,
-		-.5f, 1.0f, -0.87f,		-0.581238329f, 0.0f, -0.813733339f,	0.3324, 1.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.0f, -0.707106769f,	0.3878, 0.0,
-		-.64f, 1.0f, -0.77f,	-0.707106769f, 0.0f, -0.707106769f,	0.3601, 1.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.813733339f, 0.0f, -0.581238329f,	0.4155, 0.0,
-		-.77f, 1.0f, -0.64f,	-0.813733339f, 0.0f, -0.581238329f,	0.3878, 1.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.0f, -0.400818795f,	0.4432, 0.0,
-		-.87f, 1.0f, -0.5f,		-0.916157305f, 0.0f, -0.400818795f,	0.4155, 1.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.0f, -0.229039446f,	0.4709, 0.0,
-		-.94f, 1.0f, -0.34f,	-0.973417103f, 0.0f, -0.229039446f,	0.4432, 1.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 1.0f, -0.17f,	-0.993150651f, 0.0f, -0.116841137f,	0.4709, 1.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.0f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.0f, 0.116841137f,	0.5263, 0.0,
-		-1.0f, 1.0f, 0.0f,		-0.993150651f, 0.0f, 0.116841137f,	0.4986, 1.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.0f, 0.229039446f,	0.554, 0.0,
-		-.98f, 1.0f, 0.17f,		-0.973417103f, 0.0f, 0.229039446f,	0.5263, 1.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.916157305f, 0.0f, 0.400818795f,	0.5817, 0.0,
-		-.94f, 1.0f, 0.34f,		-0.916157305f, 0.0f, 0.400818795f,	0.554, 1.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.0f, 0.581238329f,	0.6094, 0.0,
-		-.87f, 1.0f, 0.5f,		-0.813733339f, 0.0f, 0.581238329f,	0.5817, 1.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.0f, 0.707106769f,	0.6371, 0.0,
-		-.77f, 1.0f, 0.64f,		-0.707106769f, 0.0f, 0.707106769f,	0.6094, 1.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.581238329f, 0.0f, 0.813733339f,	0.6648, 0.0,
-		-.64f, 1.0f, 0.77f,		-0.581238329f, 0.0f, 0.813733339f,	0.6371, 1.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.0f, 0.916157305f,	0.6925, 0.0,
-		-.5f, 1.0f, 0.87f,		-0.400818795f, 0.0f, 0.916157305f,	0.6648, 1.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.0f, 0.973417103f,	0.7202, 0.0,
-		-.34f, 1.0f, 0.94f,		-0.229039446f, 0.0f, 0.973417103f,	0.6925, 1.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		-.17f, 1.0f, 0.98f,		-0.116841137f, 0.0f, 0.993150651f,	0.7202, 1.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		0.0f, 0.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.0f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 1.0f,		0.116841137f, 0.0f, 0.993150651f,	0.7479, 1.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.17f, 0.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.0f, 0.973417103f,	0.8033, 0.0,
-		.17f, 1.0f, 0.98f,		0.229039446f, 0.0f, 0.973417103f,	0.7756, 1.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.34f, 0.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.400818795f, 0.0f, 0.916157305f,	0.831, 0.0,
-		.34f, 1.0f, 0.94f,		0.400818795f, 0.0f, 0.916157305f,	0.8033, 1.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.0f, 0.813733339f,	0.8587, 0.0,
-		.5f, 1.0f, 0.87f,		0.581238329f, 0.0f, 0.813733339f,	0.831, 1.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.64f, 0.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.0f, 0.707106769f,	0.8864, 0.0,
-		.64f, 1.0f, 0.77f,		0.707106769f, 0.0f, 0.707106769f,	0.8587, 1.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.77f, 0.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.813733339f, 0.0f, 0.581238329f,	0.9141, 0.0,
-		.77f, 1.0f, 0.64f,		0.813733339f, 0.0f, 0.581238329f,	0.8864, 1.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.0f, 0.400818795f,	0.9418, 0.0,
-		.87f, 1.0f, 0.5f,		0.916157305f, 0.0f, 0.400818795f,	0.9141, 1.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.94f, 0.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 0.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.0f, 0.229039446f,	0.9695, 0.0,
-		.94f, 1.0f, 0.34f,		0.973417103f, 0.0f, 0.229039446f,	0.9418, 1.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		.98f, 0.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0,
-		.98f, 1.0f, 0.17f,		0.993150651f, 0.0f, 0.116841137f,	0.9695, 1.0,
-		1.0f, 1.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.0f, 0.116841137f,	1.0, 0.0
-	};
-
-	glm::vec3 normal;
-
-	normal = CalculateTriangleNormal(glm::vec3(.98f, 1.0f, 0.17f), glm::vec3(.98f, 0.0f, 0.17f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-	// store vertex and index count
-	m_CylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_CylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	const std::string cacheName = "cylinder_" + std::to_string(segments);
+	const float parameters[] = { (float)segments };
+	const uint64_t generatorHash = HashGenerator(MESH_CYLINDER, parameters, 1);
+	if (LoadCachedMesh(MESH_CYLINDER, cacheName, generatorHash) == true)
+	{
+		return;
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	if (segments == MeshGenerator::DEFAULT_CYLINDER_SEGMENTS)
 	{
-		SetShaderMemoryLayout();
+		AddGeneratedMesh(m_CylinderMesh, MeshGenerator::GetMeshView(g_DefaultCylinder));
 	}
+	else
+	{
+		MeshGenerator::MeshData data;
+		MeshGenerator::GenerateCylinder(segments, 1.0f, data);
+		AddGeneratedMesh(m_CylinderMesh, MeshGenerator::GetMeshView(data));
+	}
+
+	GenerateMeshLods(MESH_CYLINDER);
+	SaveCachedMesh(MESH_CYLINDER, cacheName, generatorHash);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPlaneMesh()
 //
 //	Create a plane mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//  add it to the shared buffers.  The normals and texture
 //  coordinates are also set.
 // 
 //  Correct triangle drawing command:
@@ -602,29 +341,16 @@ void ShapeMeshes::LoadPlaneMesh()
 	m_PlaneMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
-	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
-
-	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// add the mesh to the shared vertex and index buffers
+	AddMeshData(m_PlaneMesh, verts, m_PlaneMesh.nVertices, indices, m_PlaneMesh.nIndices);
+	OptimizeMeshData(m_PlaneMesh, false);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPrismMesh()
 //
 //	Create a prism mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
+//  add it to the shared buffers.  The normals and texture
 //  coordinates are also set.
 //
 //	Correct triangle drawing command:
@@ -684,25 +410,20 @@ void ShapeMeshes::LoadPrismMesh()
 
 	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_PrismMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	// convert the strip into a triangle list so the mesh
+	// can share the index buffer with the other meshes
+	std::vector<GLuint> indices;
+	AppendTriangleStrip(indices, 0, m_PrismMesh.nVertices);
 
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	AddMeshData(m_PrismMesh, verts, m_PrismMesh.nVertices, indices.data(), (GLuint)indices.size());
+	OptimizeMeshData(m_PrismMesh, false);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPyramid3Mesh()
 //
 //	Create a 3-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
+//  vertices and add it to the shared buffers.  The normals 
 //  and texture coordinates are also set.
 //
 //  Correct triangle drawing command:
@@ -739,24 +460,20 @@ void ShapeMeshes::LoadPyramid3Mesh()
 	// Calculate total defined vertices
 	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	// convert the strip into a triangle list so the mesh
+	// can share the index buffer with the other meshes
+	std::vector<GLuint> indices;
+	AppendTriangleStrip(indices, 0, m_Pyramid3Mesh.nVertices);
 
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	AddMeshData(m_Pyramid3Mesh, verts, m_Pyramid3Mesh.nVertices, indices.data(), (GLuint)indices.size());
+	OptimizeMeshData(m_Pyramid3Mesh, false);
 }
 
 ///////////////////////////////////////////////////
 //	LoadPyramid4Mesh()
 //
 //	Create a 4-sided pyramid mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
+//  vertices and add it to the shared buffers.  The normals 
 //  and texture coordinates are also set.
 //
 //  Correct triangle drawing command:
@@ -802,1386 +519,134 @@ void ShapeMeshes::LoadPyramid4Mesh()
 	// Calculate total defined vertices
 	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	// convert the strip into a triangle list so the mesh
+	// can share the index buffer with the other meshes
+	std::vector<GLuint> indices;
+	AppendTriangleStrip(indices, 0, m_Pyramid4Mesh.nVertices);
 
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	AddMeshData(m_Pyramid4Mesh, verts, m_Pyramid4Mesh.nVertices, indices.data(), (GLuint)indices.size());
+	OptimizeMeshData(m_Pyramid4Mesh, false);
 }
 
 ///////////////////////////////////////////////////
 //	LoadSphereMesh()
 //
-//	Create a sphere mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//  Correct triangle drawing command:
-//
-//	glDrawElements(GL_TRIANGLES, meshes.gSphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+//	Create a sphere mesh with the passed in number of
+//  rings and sectors and add it to the shared buffers.
+//  The default resolution is built by the compiler,
+//  any other one is generated here.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadSphereMesh()
+void ShapeMeshes::LoadSphereMesh(
+	int rings,
+	int sectors)
 {
-	GLfloat verts[] = {
-		// vertex data					// texture coords			// index
-		// top center point
-		0.0f, 1.0f, 0.0f,				0.5f, 1.0f,					//0
-		// ring 1
-		0.0f, 0.9808f, 0.1951f,			0.5f, 0.9375f,				//1
-		0.0747f, 0.9808f, 0.1802f,		0.51219375f, 0.9375f,		//2
-		0.1379f, 0.9808f, 0.1379f,		0.5243875f, 0.9375f,		//3
-		0.1802f, 0.9808f, 0.0747f,		0.53658125f, 0.9375f,		//4
-		0.1951f, 0.9808, 0.0f,			0.548775f, 0.9375f,			//5
-		0.1802f, 0.9808f, -0.0747f,		0.56096875f, 0.9375f,		//6
-		0.1379f, 0.9808f, -0.1379f,		0.5731625f, 0.9375f,		//7
-		0.0747f, 0.9808f, -0.1802f,		0.58535625f, 0.9375f,		//8
-		0.0f, 0.9808f, -0.1951f,		0.59755f, 0.9375f,			//9 - seam
-		0.0f, 0.9808f, -0.1951f,		0.40245f, 0.9375f,			//10 - seam
-		-0.0747f, 0.9808f, -0.1802f,	0.41464375f, 0.9375f,		//11
-		-0.1379f, 0.9808f, -0.1379f,	0.4268375f, 0.9375f,		//12
-		-0.1802f, 0.9808f, -0.0747f,	0.43903125f, 0.9375f,		//13
-		-0.1951f, 0.9808, 0.0f,			0.451225f, 0.9375f,			//14
-		-0.1802f, 0.9808f, 0.0747f,		0.46341875f, 0.9375f,		//15
-		-0.1379f, 0.9808f, 0.1379f,		0.4756125f, 0.9375f,		//16
-		-0.0747f, 0.9808f, 0.1802f,		0.48780625f, 0.9375f,		//17
-		// ring 2
-		0.0f, 0.9239f, 0.3827f,			0.5f, 0.875f,				//18
-		0.1464f, 0.9239f, 0.3536f,		0.52391875f, 0.875f,		//19
-		0.2706f, 0.9239f, 0.2706f,		0.5478375f, 0.875f,			//20
-		0.3536f, 0.9239f, 0.1464f,		0.57175625f, 0.875f,		//21
-		0.3827f, 0.9239f, 0.0f,			0.5956755f, 0.875f,			//22
-		0.3536f, 0.9239f, -0.1464f,		0.61959425f, 0.875f,		//23
-		0.2706f, 0.9239f, -0.2706f,		0.643513f, 0.875f,			//24
-		0.1464f, 0.9239f, -0.3536f,		0.66743175f, 0.875f,		//25
-		0.0f, 0.9239f, -0.3827f,		0.6913505f, 0.875f,			//26 - seam
-		0.0f, 0.9239f, -0.3827f,		0.3086495f, 0.875f,			//27 - seam
-		-0.1464f, 0.9239f, -0.3536f,	0.33256825f, 0.875f,		//28
-		-0.2706f, 0.9239f, -0.2706f,	0.356487f, 0.875f,			//29
-		-0.3536f, 0.9239f, -0.1464f,	0.38040575f, 0.875f,		//30
-		-0.3827f, 0.9239f, 0.0f,		0.4043245f, 0.875f,			//31
-		-0.3536f, 0.9239f, 0.1464f,		0.42824325f, 0.875f,		//32
-		-0.2706f, 0.9239f, 0.2706f,		0.452162f, 0.875f,			//33
-		-0.1464f, 0.9239f, 0.3536f,		0.47608075f, 0.875f,		//34
-		// ring 3
-		0.0f, 0.8315f, 0.5556f,			0.5f, 0.8125f,				//35
-		0.2126f, 0.8315f, 0.5133f,		0.534725f, 0.8125f,			//36
-		0.3928f, 0.8315f, 0.3928f,		0.56945f, 0.8125f,			//37
-		0.5133f, 0.8315f, 0.2126f,		0.604175f, 0.8125f,			//38
-		0.5556f, 0.8315f, 0.0f,			0.6389f, 0.8125f,			//39
-		0.5133f, 0.8315f, -0.2126f,		0.673625f, 0.8125f,			//40
-		0.3928f, 0.8315f, -0.3928f,		0.70835f, 0.8125f,			//41
-		0.2126f, 0.8315f, -0.5133f,		0.743075f, 0.8125f,			//42
-		0.0f, 0.8315f, -0.5556f,		0.7778f, 0.8125f,			//43 - seam
-		0.0f, 0.8315f, -0.5556f,		0.2222f, 0.8125f,			//44 - seam
-		-0.2126f, 0.8315f, -0.5133f,	0.256925f, 0.8125f,			//45
-		-0.3928f, 0.8315f, -0.3928f,	0.29165f, 0.8125f,			//46
-		-0.5133f, 0.8315f, -0.2126f,	0.326375f, 0.8125f,			//47
-		-0.5556f, 0.8315f, 0.0f,		0.3611f, 0.8125f,			//48
-		-0.5133f, 0.8315f, 0.2126f,		0.395825f, 0.8125f,			//49
-		-0.3928f, 0.8315f, 0.3928f,		0.43055f, 0.8125f,			//50
-		-0.2126f, 0.8315f, 0.5133f,		0.465275f, 0.8125f,			//51
-		// ring 4
-		0.0f, 0.7071f, 0.7071f,			0.5f, 0.75f,				//52
-		0.2706f, 0.7071f, 0.6533f,		0.54419375f, 0.75f,			//53
-		0.5f, 0.7071f, 0.5f,			0.5883875f, 0.75f,			//54
-		0.6533f, 0.7071f, 0.2706f,		0.63258125f, 0.75f,			//55
-		0.7071f, 0.7071f, 0.0f,			0.676775f, 0.75f,			//56
-		0.6533f, 0.7071f, -0.2706f,		0.72096875f, 0.75f,			//57
-		0.5f, 0.7071f, -0.5f,			0.7651625f, 0.75f,			//58
-		0.2706f, 0.7071f, -0.6533f,		0.80935625f, 0.75f,			//59
-		0.0f, 0.7071f, -0.7071f,		0.85355f, 0.75f,			//60 - seam
-		0.0f, 0.7071f, -0.7071f,		0.14645f, 0.75f,			//61 - seam
-		-0.2706f, 0.7071f, -0.6533f,	0.19064375f, 0.75f,			//62
-		-0.5f, 0.7071f, -0.5f,			0.2348375f, 0.75f,			//63
-		-0.6533f, 0.7071f, -0.2706f,	0.27903135f, 0.75f,			//64
-		-0.7071f, 0.7071f, 0.0f,		0.323225f, 0.75f,			//65
-		-0.6533f, 0.7071f, 0.2706f,		0.36741875f, 0.75f,			//66
-		-0.5f, 0.7071f, 0.5f,			0.4116125f, 0.75f,			//67
-		-0.2706f, 0.7071f, 0.6533f,		0.45580625f, 0.75f,			//68
-		// ring 5
-		0.0f, 0.5556f, 0.8315f,			0.5f, 0.6875f,				//69
-		0.3182f, 0.5556f, 0.7682f,		0.55196875f, 0.6875f,		//70
-		0.5879f, 0.5556f, 0.5879f,		0.6039375f, 0.6875f,		//71
-		0.7682f, 0.5556f, 0.3182f,		0.65590625f, 0.6875f,		//72
-		0.8315f, 0.5556f, 0.0f,			0.707875f, 0.6875f,			//73
-		0.7682f, 0.5556f, -0.3182f,		0.75984375f, 0.6875f,		//74
-		0.5879f, 0.5556f, -0.5879f,		0.8118125f, 0.6875f,		//75
-		0.3182f, 0.5556f, -0.7682f,		0.86378125f, 0.6875f,		//76
-		0.0f, 0.5556f, -0.8315f,		0.91575f, 0.6875f,			//77 - seam
-		0.0f, 0.5556f, -0.8315f,		0.08425f, 0.6875f,			//78 - seam
-		-0.3182f, 0.5556f, -0.7682f,	0.13621875f, 0.6875f,		//79
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.6875f,		//80
-		-0.7682f, 0.5556f, -0.3182f,	0.24015625f, 0.6875f,		//81
-		-0.8315f, 0.5556f, 0.0f,		0.292125f, 0.6875f,			//82
-		-0.7682f, 0.5556f, 0.3182f,		0.34409375f, 0.6875f,		//83
-		-0.5879f, 0.5556f, 0.5879f,		0.3960625f, 0.6875f,		//84
-		-0.3182f, 0.5556f, 0.7682f,		0.44803125f, 0.6875f,		//85
-		//ring 6
-		0.0f, 0.3827f, 0.9239f,			0.5f, 0.625f,				//86
-		0.3536f, 0.3827f, 0.8536f,		0.55774375f, 0.625f,		//87
-		0.6533f, 0.3827f, 0.6533f,		0.6154875f, 0.625f,			//88
-		0.8536f, 0.3827f, 0.3536f,		0.67323125f, 0.625f,		//89
-		0.9239f, 0.3827f, 0.0f,			0.730975f, 0.625f,			//90
-		0.8536f, 0.3827f, -0.3536f,		0.78871875f, 0.625f,		//91
-		0.6533f, 0.3827f, -0.6533f,		0.8464625f, 0.625f,			//92
-		0.3536f, 0.3827f, -0.8536f,		0.90420625f, 0.625f,		//93
-		0.0f, 0.3827f, -0.9239f,		0.96195f, 0.625f,			//94 - seam
-		0.0f, 0.3827f, -0.9239f,		0.03805f, 0.625f,			//95 - seam
-		-0.3536f, 0.3827f, -0.8536f,	0.09579375f, 0.625f,		//96
-		-0.6533f, 0.3827f, -0.6533f,	0.1535375f, 0.625f,			//97
-		-0.8536f, 0.3827f, -0.3536f,	0.21128125f, 0.625f,		//98
-		-0.9239f, 0.3827f, 0.0f,		0.269025f, 0.625f,			//99
-		-0.8536f, 0.3827f, 0.3536f,		0.32676875f, 0.625f,		//100
-		-0.6533f, 0.3827f, 0.6533f,		0.3845125f, 0.625f,			//101
-		-0.3536f, 0.3827f, 0.8536f,		0.44225625f, 0.625f,		//102
-		// ring 7
-		0.0f, 0.1951f, 0.9808f,			0.5f, 0.5625f,				//103
-		0.3753f, 0.1915f, 0.9061f,		0.5613f, 0.5625f,			//104
-		0.6935f, 0.1915f, 0.6935f,		0.6226f, 0.5625f,			//105
-		0.9061f, 0.1915f, 0.3753f,		0.6839f, 0.5625f,			//106
-		0.9808f, 0.1915f, 0.0f,			0.7452f, 0.5625f,			//107
-		0.9061f, 0.1915f, -0.3753f,		0.8065f, 0.5625f,			//108
-		0.6935f, 0.1915f, -0.6935f,		0.8678f, 0.5625f,			//109
-		0.3753f, 0.1915f, -0.9061f,		0.9291f, 0.5625f,			//110
-		0.0f, 0.1915f, -0.9808f,		0.9904f, 0.5625f,			//111 - seam
-		0.0f, 0.1915f, -0.9808f,		0.0096f, 0.5625f,			//112 - seam
-		-0.3753f, 0.1915f, -0.9061f,	0.0709f, 0.5625f,			//113
-		-0.6935f, 0.1915f, -0.6935f,	0.1322f, 0.5625f,			//114
-		-0.9061f, 0.1915f, -0.3753f,	0.1935f, 0.5625f,			//115
-		-0.9808f, 0.1915f, 0.0f,		0.2548f, 0.5625f,			//116
-		-0.9061f, 0.1915f, 0.3753f,		0.3161f, 0.5625f,			//117
-		-0.6935f, 0.1915f, 0.6935f,		0.3774f, 0.5625f,			//118
-		-0.3753f, 0.1915f, 0.9061f,		0.4387f, 0.5625f,			//119
-		// ring 8
-		0.0f, 0.0f, 1.0f,				0.5f, 0.5f,					//120
-		0.3827f, 0.0f, 0.9239f,			0.5625f, 0.5f,				//121
-		0.7071f, 0.0f, 0.7071f,			0.625f, 0.5f,				//122
-		0.9239f, 0.0f, 0.3827f,			0.6875f, 0.5f,				//123
-		1.0f, 0.0f, 0.0f,				0.75f, 0.5f,				//124
-		0.9239f, 0.0f, -0.3827f,		0.8125f, 0.5f,				//125
-		0.7071f, 0.0f, -0.7071f,		0.875f, 0.5f,				//126
-		0.3827f, 0.0f, -0.9239f,		0.9375f, 0.5f,				//127
-		0.0f, 0.0f, -1.0f,				1.0f, 0.5f,					//128 - seam
-		0.0f, 0.0f, -1.0f, 				0.0f, 0.5f,					//129 - seam
-		-0.3827f, 0.0f, -0.9239f,		0.0625f, 0.5f,				//130
-		-0.7071f, 0.0f, -0.7071f,		0.125f, 0.5f,				//131
-		-0.9239f, 0.0f, -0.3827f,		0.1875f, 0.5f,				//132
-		-1.0f, 0.0f, 0.0f,				0.25f, 0.5f,				//133
-		-0.9239f, 0.0f, 0.3827f,		0.3125f, 0.5f,				//134
-		-0.7071, 0.0, 0.7071f,			0.375f, 0.5f,				//135
-		-0.3827f, 0.0f, 0.9239f,		0.4375f, 0.5f,				//136
-		// ring 9
-		0.0f, -0.1915f, 0.9808f,		0.5f, 0.4375f,				//137
-		0.3753f, -0.1915f, 0.9061f,		0.5613f, 0.4375f,			//138
-		0.6935f, -0.1915f, 0.6935f,		0.6226f, 0.4375f,			//139
-		0.9061f, -0.1915f, 0.3753f,		0.6839f, 0.4375f,			//140
-		0.9808f, -0.1915f, 0.0f,		0.7452f, 0.4375f,			//141
-		0.9061f, -0.1915f, -0.3753f,	0.8065f, 0.4375f,			//142
-		0.6935f, -0.1915f, -0.6935f,	0.8678f, 0.4375f,			//143
-		0.3753f, -0.1915f, -0.9061f,	0.9261f, 0.4375f,			//144
-		0.0f, -0.1915f, -0.9808f,		0.9904f, 0.4375f,			//145 - seam
-		0.0f, -0.1915f, -0.9808f,		0.0096f, 0.4375f,			//146 - seam
-		-0.3753f, -0.1915f, -0.9061f,	0.0709f, 0.4375f,			//147
-		-0.6935f, -0.1915f, -0.6935f,	0.1322f, 0.4375f,			//148
-		-0.9061f, -0.1915f, -0.3753f,	0.1935f, 0.4375f,			//149
-		-0.9808f, -0.1915f, 0.0f,		0.2548f, 0.4375f,			//150
-		-0.9061f, -0.1915f, 0.3753f,	0.3161f, 0.4375f,			//151
-		-0.6935f, -0.1915f, 0.6935f,	0.3774f, 0.4375f,			//152
-		-0.3753f, -0.1915f, 0.9061f,	0.4387f, 0.4375f,			//153
-		// ring 10
-		0.0f, -0.3827f, 0.9239f,		0.5f, 0.375f,				//154
-		0.3536f, -0.3827f, 0.8536f,		0.55774375f, 0.375f,		//155
-		0.6533f, -0.3827f, 0.6533f,		0.6154875f, 0.375f,			//156
-		0.8536f, -0.3827f, 0.3536f,		0.67323125f, 0.375f,		//157
-		0.9239f, -0.3827f, 0.0f,		0.730975f, 0.375f,			//158
-		0.8536f, -0.3827f, -0.3536f,	0.78871875f, 0.375f,		//159
-		0.6533f, -0.3827f, -0.6533f,	0.8464625f, 0.375f,			//160
-		0.3536f, -0.3827f, -0.8536f,	0.90420625f, 0.375f,		//161
-		0.0f, -0.3827f, -0.9239f,		0.96195f, 0.375f,			//162 - seam
-		0.0f, -0.3827f, -0.9239f,		0.03805f, 0.375f,			//163 - seam
-		-0.3536f, -0.3827f, -0.8536f,	0.09579375f, 0.375f,		//164
-		-0.6533f, -0.3827f, -0.6533f,	0.1535375f, 0.375f,			//165
-		-0.8536f, -0.3827f, -0.3536f,	0.21128125f, 0.375f,		//166
-		-0.9239f, -0.3827f, 0.0f,		0.269025f, 0.375f,			//167
-		-0.8536f, -0.3827f, 0.3536f,	0.32676875f, 0.375f,		//168
-		-0.6533f, -0.3827f, 0.6533f,	0.3845125f, 0.375f,			//169
-		-0.3536f, -0.3827f, 0.8536f,	0.44225625f, 0.375f,		//170
-		// ring 11
-		0.0f, -0.5556f, 0.8315f,		0.5f, 0.3125f,				//171
-		0.3182f, -0.5556f, 0.7682f,		0.55196875f, 0.3125f,		//172
-		0.5879f, -0.5556f, 0.5879f,		0.6039375f, 0.3125f,		//173
-		0.7682f, -0.5556f, 0.3182f,		0.65590625f, 0.3125f,		//174
-		0.8315f, -0.5556f, 0.0f,		0.707875f, 0.3125f,			//175
-		0.7682f, -0.5556f, -0.3182f,	0.75984375f, 0.3125f,		//176
-		0.5879f, -0.5556f, -0.5879f,	0.8118125f, 0.3125f,		//177
-		0.3182f, -0.5556f, -0.7682f,	0.86378125f, 0.3125f,		//178
-		0.0f, -0.5556f, -0.8315f,		0.91575f, 0.3125f,			//179 - seam
-		0.0f, -0.5556f, -0.8315f,		0.08425f, 0.3125f,			//180 - seam
-		-0.3182f, -0.5556f, -0.7682f,	0.13621875f, 0.3125f,		//181
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.3125f,		//182
-		-0.7682f, -0.5556f, -0.3182f,	0.24015625f, 0.3125f,		//183
-		-0.8315f, -0.5556f, 0.0f,		0.292125f, 0.3125f,			//184
-		-0.7682f, -0.5556f, 0.3182f,	0.34409375f, 0.3125f,		//185
-		-0.5879f, -0.5556f, 0.5879f,	0.3960625f, 0.3125f,		//186
-		-0.3182f, -0.5556f, 0.7682f,	0.44803125f, 0.3125f,		//187
-		// ring 12
-		0.0f, -0.7071f, 0.7071f,		0.5f, 0.25f,				//188
-		0.2706f, -0.7071f, 0.6533f,		0.54419375f, 0.25f,			//189
-		0.5f, -0.7071f, 0.5f,			0.5883875f, 0.25f,			//190
-		0.6533f, -0.7071f, 0.2706f,		0.63258125f, 0.25f,			//191
-		0.7071f, -0.7071f, 0.0f,		0.676775f, 0.25f,			//192
-		0.6533f, -0.7071f, -0.2706f,	0.72096875f, 0.25f,			//193
-		0.5f, -0.7071f, -0.5f,			0.7651625f, 0.25f,			//194
-		0.2706f, -0.7071f, -0.6533f,	0.80935625f, 0.25f,			//195
-		0.0f, -0.7071f, -0.7071f,		0.85355f, 0.25f,			//196 - seam
-		0.0f, -0.7071f, -0.7071f,		0.14645f, 0.25f,			//197 - seam
-		-0.2706f, -0.7071f, -0.6533f,	0.19064375f, 0.25f,			//198
-		-0.5f, -0.7071f, -0.5f,			0.2348375f, 0.25f,			//199
-		-0.6533f, -0.7071f, -0.2706f,	0.27903135f, 0.25f,			//200
-		-0.7071f, -0.7071f, 0.0f,		0.323225f, 0.25f,			//201
-		-0.6533f, -0.7071f, 0.2706f,	0.36741875f, 0.25f,			//202
-		-0.5f, -0.7071f, 0.5f,			0.4116125f, 0.25f,			//203
-		-0.2706f, -0.7071f, 0.6533f,	0.45580625f, 0.25f,			//204
-		// ring 13
-		0.0f, -0.8315f, 0.5556f,		0.5f, 0.1875f,				//205
-		0.2126f, -0.8315f, 0.5133f,		0.534725f, 0.1875f,			//206
-		0.3928f, -0.8315f, 0.3928f,		0.56945f, 0.1875f,			//207
-		0.5133f, -0.8315f, 0.2126f,		0.604175f, 0.1875f,			//208
-		0.5556f, -0.8315f, 0.0f,		0.6389f, 0.1875f,			//209
-		0.5133f, -0.8315f, -0.2126f,	0.673625f, 0.1875f,			//210
-		0.3928f, -0.8315f, -0.3928f,	0.70835f, 0.1875f,			//211
-		0.2126f, -0.8315f, -0.5133f,	0.743075f, 0.1875f,			//212
-		0.0f, -0.8315f, -0.5556f,		0.7778f, 0.1875f,			//213 - seam
-		0.0f, -0.8315f, -0.5556f,		0.2222f, 0.1875f,			//214 - seam
-		-0.2126f, -0.8315f, -0.5133f,	0.256925f, 0.1875f,			//215
-		-0.3928f, -0.8315f, -0.3928f,	0.29165f, 0.1875f,			//216
-		-0.5133f, -0.8315f, -0.2126f,	0.326375f, 0.1875f,			//217
-		-0.5556f, -0.8315f, 0.0f,		0.3611f, 0.1875f,			//218
-		-0.5133f, -0.8315f, 0.2126f,	0.395825f, 0.1875f,			//219
-		-0.3928f, -0.8315f, 0.3928f,	0.43055f, 0.1875f,			//220
-		-0.2126f, -0.8315f, 0.5133f,	0.465275f, 0.1875f,			//221
-		// ring 14
-		0.0f, -0.9239f, 0.3827f,		0.5f, 0.125f,				//222
-		0.1464f, -0.9239f, 0.3536f,		0.52391875f, 0.125f,		//223
-		0.2706f, -0.9239f, 0.2706f,		0.5478375f, 0.125f,			//224
-		0.3536f, -0.9239f, 0.1464f,		0.57175625f, 0.125f,		//225
-		0.3827f, -0.9239f, 0.0f,		0.5956755f, 0.125f,			//226
-		0.3536f, -0.9239f, -0.1464f,	0.61959425f, 0.125f,		//227
-		0.2706f, -0.9239f, -0.2706f,	0.643513f, 0.125f,			//228
-		0.1464f, -0.9239f, -0.3536f,	0.66743175f, 0.125f,		//229
-		0.0f, -0.9239f, -0.3827f,		0.6913505f, 0.125f,			//230 - seam
-		0.0f, -0.9239f, -0.3827f,		0.3086495f, 0.125f,			//231 - seam
-		-0.1464f, -0.9239f, -0.3536f,	0.33256825f, 0.125f,		//232
-		-0.2706f, -0.9239f, -0.2706f,	0.356487f, 0.125f,			//233
-		-0.3536f, -0.9239f, -0.1464f,	0.38040575f, 0.125f,		//234
-		-0.3827f, -0.9239f, 0.0f,		0.4043245f, 0.125f,			//235
-		-0.3536f, -0.9239f, 0.1464f,	0.42824325f, 0.125f,		//236
-		-0.2706f, -0.9239f, 0.2706f,	0.452162f, 0.125f,			//237
-		-0.1464f, -0.9239f, 0.3536f,	0.47608075f, 0.125f,		//238
-		// ring 15
-		0.0f, -0.9808f, 0.1951f,		0.5f, 0.0625f,				//239
-		0.0747f, -0.9808f, 0.1802f,		0.51219375f, 0.0625f,		//240
-		0.1379f, -0.9808f, 0.1379f,		0.5243875f, 0.0625f,		//241
-		0.1802f, -0.9808f, 0.0747f,		0.53658125f, 0.0625f,		//242
-		0.1951f, -0.9808, 0.0f,			0.548775f, 0.0625f,			//243
-		0.1802f, -0.9808f, -0.0747f,	0.56096875f, 0.0625f,		//244
-		0.1379f, -0.9808f, -0.1379f,	0.5731625f, 0.0625f,		//245
-		0.0747f, -0.9808f, -0.1802f,	0.58535625f, 0.0625f,		//246
-		0.0f, -0.9808f, -0.1951f,		0.59755f, 0.0625f,			//247 - seam
-		0.0f, -0.9808f, -0.1951f,		0.40245f, 0.0625f,			//248 - seam
-		-0.0747f, -0.9808f, -0.1802f,	0.41464375f, 0.0625f,		//249
-		-0.1379f, -0.9808f, -0.1379f,	0.4268375f, 0.0625f,		//250
-		-0.1802f, -0.9808f, -0.0747f,	0.43903125f, 0.0625f,		//251
-		-0.1951f, -0.9808, 0.0f,		0.451225f, 0.0625f,			//252
-		-0.1802f, -0.9808f, 0.0747f,	0.46341875f, 0.0625f,		//253
-		-0.1379f, -0.9808f, 0.1379f,	0.4756125f, 0.0625f,		//254
-		-0.0747f, -0.9808f, 0.1802f,	0.48780625f, 0.0625f,		//255
-		// bottom center point
-		0.0f, -1.0f, 0.0f,				0.5f, 0.0f					//256
-	};
-
-	// index data
-	GLuint indices[] = {
-		//ring 1 - top
-		0,10,11,
-		0,11,12,
-		0,12,13,
-		0,13,14,
-		0,14,15,
-		0,15,16,
-		0,16,17,
-		0,17,1,
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,9,
-		0,9,10,
-
-		// ring 1 to ring 2
-		10,27,28,
-		10,11,28,
-		11,28,29,
-		11,12,29,
-		12,29,30,
-		12,13,30,
-		13,30,31,
-		13,14,31,
-		14,31,32,
-		14,15,32,
-		15,32,33,
-		15,16,33,
-		16,33,34,
-		16,17,34,
-		17,34,18,
-		17,1,18,
-		1,18,19,
-		1,2,19,
-		2,19,20,
-		2,3,20,
-		3,20,21,
-		3,4,21,
-		4,21,22,
-		4,5,22,
-		5,22,23,
-		5,6,23,
-		6,23,24,
-		6,7,24,
-		7,24,25,
-		7,8,25,
-		8,25,26,
-		8,9,26,
-		9,26,27,
-		9,10,27,
-
-		// ring 2 to ring 3
-		27,44,45,
-		27,28,45,
-		28,45,46,
-		28,29,46,
-		29,46,47,
-		29,30,47,
-		30,47,48,
-		30,31,48,
-		31,48,49,
-		31,32,49,
-		32,49,50,
-		32,33,50,
-		33,50,51,
-		33,34,51,
-		34,51,35,
-		34,18,35,
-		18,35,36,
-		18,19,36,
-		19,36,37,
-		19,20,37,
-		20,37,38,
-		20,21,38,
-		21,38,39,
-		21,22,39,
-		22,39,40,
-		22,23,40,
-		23,40,41,
-		23,24,41,
-		24,41,42,
-		24,25,42,
-		25,42,43,
-		25,26,43,
-		26,43,44,
-		26,27,44,
-
-		// ring 3 to ring 4
-		44,61,62,
-		44,45,62,
-		45,62,63,
-		45,46,63,
-		46,63,64,
-		46,47,64,
-		47,64,65,
-		47,48,65,
-		48,65,66,
-		48,49,66,
-		49,66,67,
-		49,50,67,
-		50,67,68,
-		50,51,68,
-		51,68,52,
-		51,35,52,
-		35,52,53,
-		35,36,53,
-		36,53,54,
-		36,37,54,
-		37,54,55,
-		37,38,55,
-		38,55,56,
-		38,39,56,
-		39,56,57,
-		39,40,57,
-		40,57,58,
-		40,41,58,
-		41,58,59,
-		41,42,59,
-		42,59,60,
-		42,43,60,
-		43,60,61,
-		43,44,61,
-
-		// ring 4 to ring 5
-		61,78,79,
-		61,62,79,
-		62,79,80,
-		62,63,80,
-		63,80,81,
-		63,64,81,
-		64,81,82,
-		64,65,82,
-		65,82,83,
-		65,66,83,
-		66,83,84,
-		66,67,84,
-		67,84,85,
-		67,68,85,
-		68,85,69,
-		68,52,69,
-		52,69,70,
-		52,53,70,
-		53,70,71,
-		53,54,71,
-		54,71,72,
-		54,55,72,
-		55,72,73,
-		55,56,73,
-		56,73,74,
-		56,57,74,
-		57,74,75,
-		57,58,75,
-		58,75,76,
-		58,59,76,
-		59,76,77,
-		59,60,77,
-		60,77,78,
-		60,61,78,
-
-		// ring 5 to ring 6
-		78,95,96,
-		78,79,96,
-		79,96,97,
-		79,80,97,
-		80,97,98,
-		80,81,98,
-		81,98,99,
-		81,82,99,
-		82,99,100,
-		82,83,100,
-		83,100,101,
-		83,84,101,
-		84,101,102,
-		84,85,102,
-		85,102,86,
-		85,69,86,
-		69,86,87,
-		69,70,87,
-		70,87,88,
-		70,71,88,
-		71,88,89,
-		71,72,89,
-		72,89,90,
-		72,73,90,
-		73,90,91,
-		73,74,91,
-		74,91,92,
-		74,75,92,
-		75,92,93,
-		75,76,93,
-		76,93,94,
-		76,77,94,
-		77,94,95,
-		77,78,95,
-
-		// ring 6 to ring 7
-		95,112,113,
-		95,96,113,
-		96,113,114,
-		96,97,114,
-		97,114,115,
-		97,98,115,
-		98,115,116,
-		98,99,116,
-		99,116,117,
-		99,100,117,
-		100,117,118,
-		100,101,118,
-		101,118,119,
-		101,102,119,
-		102,119,103,
-		102,86,103,
-		86,103,104,
-		86,87,104,
-		87,104,105,
-		87,88,105,
-		88,105,106,
-		88,89,106,
-		89,106,107,
-		89,90,107,
-		90,107,108,
-		90,91,108,
-		91,108,109,
-		91,92,109,
-		92,109,110,
-		92,93,110,
-		93,110,111,
-		93,94,111,
-		94,111,112,
-		94,95,112,
-
-		// ring 7 to ring 8
-		112,129,130,
-		112,113,130,
-		113,130,131,
-		113,114,131,
-		114,131,132,
-		114,115,132,
-		115,132,133,
-		115,116,133,
-		116,133,134,
-		116,117,134,
-		117,134,135,
-		117,118,135,
-		118,135,136,
-		118,119,136,
-		119,136,120,
-		119,103,120,
-		103,120,121,
-		103,104,121,
-		104,121,122,
-		104,105,122,
-		105,122,123,
-		105,106,123,
-		106,123,124,
-		106,107,124,
-		107,124,125,
-		107,108,125,
-		108,125,126,
-		108,109,126,
-		109,126,127,
-		109,110,127,
-		110,127,128,
-		110,111,128,
-		111,128,129,
-		111,112,129,
-
-		// ring 8 to ring 9
-		129,146,147,
-		129,130,147,
-		130,147,148,
-		130,131,148,
-		131,148,149,
-		131,132,149,
-		132,149,150,
-		132,133,150,
-		133,150,151,
-		133,134,151,
-		134,151,152,
-		134,135,152,
-		135,152,153,
-		135,136,153,
-		136,153,137,
-		136,120,137,
-		120,137,138,
-		120,121,138,
-		121,138,139,
-		121,122,139,
-		122,139,140,
-		122,123,140,
-		123,140,141,
-		123,124,141,
-		124,141,142,
-		124,125,142,
-		125,142,143,
-		125,126,143,
-		126,143,144,
-		126,127,144,
-		127,144,145,
-		127,128,145,
-		128,145,146,
-		128,129,146,
-
-		// ring 9 to ring 10
-		146,163,164,
-		146,147,164,
-		147,164,165,
-		147,148,165,
-		148,165,166,
-		148,149,166,
-		149,166,167,
-		149,150,167,
-		150,167,168,
-		150,151,168,
-		151,168,169,
-		151,152,169,
-		152,169,170,
-		152,153,170,
-		153,170,154,
-		153,137,154,
-		137,154,155,
-		137,138,155,
-		138,155,156,
-		138,139,156,
-		139,156,157,
-		139,140,157,
-		140,157,158,
-		140,141,158,
-		141,158,159,
-		141,142,159,
-		142,159,160,
-		142,143,160,
-		143,160,161,
-		143,144,161,
-		144,161,162,
-		144,145,162,
-		145,162,163,
-		145,146,163,
-
-		// ring 10 to ring 11
-		163,180,181,
-		163,164,181,
-		164,181,182,
-		164,165,182,
-		165,182,183,
-		165,166,183,
-		166,183,184,
-		166,167,184,
-		167,184,185,
-		167,168,185,
-		168,185,186,
-		168,169,186,
-		169,186,187,
-		169,170,187,
-		170,187,171,
-		170,154,171,
-		154,171,172,
-		154,155,172,
-		155,172,173,
-		155,156,173,
-		156,173,174,
-		156,157,174,
-		157,174,175,
-		157,158,175,
-		158,175,176,
-		158,159,176,
-		159,176,177,
-		159,160,177,
-		160,177,178,
-		160,161,178,
-		161,178,179,
-		161,162,179,
-		162,179,180,
-		162,163,180,
-
-		// ring 11 to ring 12
-		180,197,198,
-		180,181,198,
-		181,198,199,
-		181,182,199,
-		182,199,200,
-		182,183,200,
-		183,200,201,
-		183,184,201,
-		184,201,202,
-		184,185,202,
-		185,202,203,
-		185,186,203,
-		186,203,204,
-		186,187,204,
-		187,204,188,
-		187,171,188,
-		171,188,189,
-		171,172,189,
-		172,189,190,
-		172,173,190,
-		173,190,191,
-		173,174,191,
-		174,191,192,
-		174,175,192,
-		175,192,193,
-		175,176,193,
-		176,193,194,
-		176,177,194,
-		177,194,195,
-		177,178,195,
-		178,195,196,
-		178,179,196,
-		179,196,197,
-		179,180,197,
-
-		// ring 12 to ring 13
-		197,214,215,
-		197,198,215,
-		198,215,216,
-		198,199,216,
-		199,216,217,
-		199,200,217,
-		200,217,218,
-		200,201,218,
-		201,218,219,
-		201,202,219,
-		202,219,220,
-		202,203,220,
-		203,220,221,
-		203,204,221,
-		204,221,205,
-		204,188,205,
-		188,205,206,
-		188,189,206,
-		189,206,207,
-		189,190,207,
-		190,207,208,
-		190,191,208,
-		191,208,209,
-		191,192,209,
-		192,209,210,
-		192,193,210,
-		193,210,211,
-		193,194,211,
-		194,211,212,
-		194,195,212,
-		195,212,213,
-		195,196,213,
-		196,213,214,
-		196,197,214,
-
-		// ring 13 to ring 14
-		214,231,232,
-		214,215,232,
-		215,232,233,
-		215,216,233,
-		216,233,234,
-		216,217,234,
-		217,234,235,
-		217,218,235,
-		218,235,236,
-		218,219,236,
-		219,236,237,
-		219,220,237,
-		220,237,238,
-		220,221,238,
-		221,238,222,
-		221,205,222,
-		205,222,223,
-		205,206,223,
-		206,223,224,
-		206,207,224,
-		207,224,225,
-		207,208,225,
-		208,225,226,
-		208,209,226,
-		209,226,227,
-		209,210,227,
-		210,227,228,
-		210,211,228,
-		211,228,229,
-		211,212,229,
-		212,229,230,
-		212,213,230,
-		213,230,231,
-		213,214,231,
-
-		// ring 14 to ring 15
-		231,248,249,
-		231,232,249,
-		232,249,250,
-		232,233,250,
-		233,250,251,
-		233,234,251,
-		234,251,252,
-		234,235,252,
-		235,252,253,
-		235,236,253,
-		236,253,254,
-		236,237,254,
-		237,254,255,
-		237,238,255,
-		238,255,239,
-		238,222,239,
-		222,239,240,
-		222,223,240,
-		223,240,241,
-		223,224,241,
-		224,241,242,
-		224,225,242,
-		225,242,243,
-		225,226,243,
-		226,243,244,
-		226,227,244,
-		227,244,245,
-		227,228,245,
-		228,245,246,
-		228,229,246,
-		229,246,247,
-		229,230,247,
-		230,247,248,
-		230,231,248,
-
-		// ring 15 - bottom
-		248,256,249,
-		249,256,250,
-		250,256,251,
-		251,256,252,
-		252,256,253,
-		253,256,254,
-		254,256,255,
-		255,256,239,
-		239,256,240,
-		240,256,241,
-		241,256,242,
-		242,256,243,
-		243,256,244,
-		244,256,245,
-		245,256,246,
-		246,256,247,
-		247,256,248
-	};
-
-	// total float values per each type
-	const GLuint floatsPerVertex = 3;
-	const GLuint floatsPerNormal = 3;
-	const GLuint floatsPerUV = 2;
-
-	// store vertex and index count
-	m_SphereMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (floatsPerVertex));
-	m_SphereMesh.nIndices = sizeof(indices) / (sizeof(indices[0]));
-
-	glm::vec3 normal;
-	glm::vec3 vert;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	float u, v;
-	std::vector<GLfloat> combined_values;
-
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < sizeof(verts) / (sizeof(verts[0])); i += 5)
-	{
-		vert = glm::vec3(verts[i], verts[i + 1], verts[i + 2]);
-		normal = normalize(vert - center);
-		//u = atan2(normal.x, normal.z) / (2 * M_PI) + 0.5;
-		//v = normal.y * 0.5 + 0.5;
-		combined_values.push_back(vert.x);
-		combined_values.push_back(vert.y);
-		combined_values.push_back(vert.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(verts[i + 3]);
-		combined_values.push_back(verts[i + 4]);
-	}
-
-	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_SphereMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	const std::string cacheName = "sphere_" + std::to_string(rings) + "x" + std::to_string(sectors);
+	const float parameters[] = { (float)rings, (float)sectors };
+	const uint64_t generatorHash = HashGenerator(MESH_SPHERE, parameters, 2);
+	if (LoadCachedMesh(MESH_SPHERE, cacheName, generatorHash) == true)
+	{
+		return;
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	if ((rings == MeshGenerator::DEFAULT_SPHERE_RINGS) &&
+		(sectors == MeshGenerator::DEFAULT_SPHERE_SECTORS))
 	{
-		SetShaderMemoryLayout();
+		AddGeneratedMesh(m_SphereMesh, MeshGenerator::GetMeshView(g_DefaultSphere));
+	}
+	else
+	{
+		MeshGenerator::MeshData data;
+		MeshGenerator::GenerateSphere(rings, sectors, data);
+		AddGeneratedMesh(m_SphereMesh, MeshGenerator::GetMeshView(data));
 	}
+
+	GenerateMeshLods(MESH_SPHERE);
+	SaveCachedMesh(MESH_SPHERE, cacheName, generatorHash);
 }
 
 ///////////////////////////////////////////////////
 //	LoadTaperedCylinderMesh()
 //
-//	Create a tapered cylinder mesh by specifying the 
-//  vertices and store it in a VAO/VBO.  The normals 
-//  and texture coordinates are also set.
-//
-//  Correct triangle drawing commands:
-//
-//	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 72);		//top
-//	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+//	Create a tapered cylinder mesh with the passed in
+//  number of segments around its side and add it to
+//  the shared buffers.  The default resolution is
+//  built by the compiler, any other one is generated
+//  here.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTaperedCylinderMesh()
+void ShapeMeshes::LoadTaperedCylinderMesh(int segments)
 {
-	GLfloat verts[] = {
-		// cylinder bottom		// normals			// texture coords
-		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
-		.98f, 0.0f, -0.17f,		0.0f, -1.0f, 0.0f,	0.41f, 0.983f,
-		.94f, 0.0f, -0.34f,		0.0f, -1.0f, 0.0f,	0.33f, 0.96f,
-		.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.92f,
-		.77f, 0.0f, -0.64f,		0.0f, -1.0f, 0.0f,	0.17f, 0.87f,
-		.64f, 0.0f, -0.77f,		0.0f, -1.0f, 0.0f,	0.13f, 0.83f,
-		.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.77f,
-		.34f, 0.0f, -0.94f,		0.0f, -1.0f, 0.0f,	0.04f, 0.68f,
-		.17f, 0.0f, -0.98f,		0.0f, -1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 0.0f, -1.0f,		0.0f, -1.0f, 0.0f,	0.0f,0.5f,
-		-.17f, 0.0f, -0.98f,	0.0f, -1.0f, 0.0f,	0.017f, 0.41f,
-		-.34f, 0.0f, -0.94f,	0.0f, -1.0f, 0.0f,	0.04f, 0.33f,
-		-.5f, 0.0f, -0.87f,		0.0f, -1.0f, 0.0f,	0.08f, 0.25f,
-		-.64f, 0.0f, -0.77f,	0.0f, -1.0f, 0.0f,	0.13f, 0.17f,
-		-.77f, 0.0f, -0.64f,	0.0f, -1.0f, 0.0f,	0.17f, 0.13f,
-		-.87f, 0.0f, -0.5f,		0.0f, -1.0f, 0.0f,	0.25f, 0.08f,
-		-.94f, 0.0f, -0.34f,	0.0f, -1.0f, 0.0f,	0.33f, 0.04f,
-		-.98f, 0.0f, -0.17f,	0.0f, -1.0f, 0.0f,	0.41f, 0.017f,
-		-1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f, 0.0f,
-		-.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.017f,
-		-.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.04f,
-		-.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.08f,
-		-.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.13f,
-		-.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.17f,
-		-.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.25f,
-		-.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.33f,
-		-.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 0.0f, 1.0f,		0.0f, -1.0f, 0.0f,	1.0f, 0.5f,
-		.17f, 0.0f, 0.98f,		0.0f, -1.0f, 0.0f,	0.983f, 0.6f,
-		.34f, 0.0f, 0.94f,		0.0f, -1.0f, 0.0f,	0.96f, 0.68f,
-		.5f, 0.0f, 0.87f,		0.0f, -1.0f, 0.0f,	0.92f, 0.77f,
-		.64f, 0.0f, 0.77f,		0.0f, -1.0f, 0.0f,	0.87f, 0.83f,
-		.77f, 0.0f, 0.64f,		0.0f, -1.0f, 0.0f,	0.83f, 0.87f,
-		.87f, 0.0f, 0.5f,		0.0f, -1.0f, 0.0f,	0.77f, 0.92f,
-		.94f, 0.0f, 0.34f,		0.0f, -1.0f, 0.0f,	0.68f, 0.96f,
-		.98f, 0.0f, 0.17f,		0.0f, -1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder top			// normals			// texture coords
-		0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f,1.0f,
-		.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.983f,
-		.47f, 1.0f, -0.17f,		0.0f, 1.0f, 0.0f,	0.33f, 0.96f,
-		.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.92f,
-		.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.87f,
-		.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.83f,
-		.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.77f,
-		.17f, 1.0f, -0.47f,		0.0f, 1.0f, 0.0f,	0.04f, 0.68f,
-		.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.6f,
-		0.0f, 1.0f, -0.5f,		0.0f, 1.0f, 0.0f,	0.0f,0.5f,
-		-.085f, 1.0f, -0.49f,	0.0f, 1.0f, 0.0f,	0.017f, 0.41f,
-		-.17f, 1.0f, -0.47f,	0.0f, 1.0f, 0.0f,	0.04f, 0.33f,
-		-.25f, 1.0f, -0.435f,	0.0f, 1.0f, 0.0f,	0.08f, 0.25f,
-		-.32f, 1.0f, -0.385f,	0.0f, 1.0f, 0.0f,	0.13f, 0.17f,
-		-.385f, 1.0f, -0.32f,	0.0f, 1.0f, 0.0f,	0.17f, 0.13f,
-		-.435f, 1.0f, -0.25f,	0.0f, 1.0f, 0.0f,	0.25f, 0.08f,
-		-.47f, 1.0f, -0.17f,	0.0f, 1.0f, 0.0f,	0.33f, 0.04f,
-		-.49f, 1.0f, -0.085f,	0.0f, 1.0f, 0.0f,	0.41f, 0.017f,
-		-0.5f, 1.0f, 0.0f,		0.0f, 1.0f, 0.0f,	0.5f, 0.0f,
-		-.49f, 1.0f, 0.085f,	0.0f, 1.0f, 0.0f,	0.6f, 0.017f,
-		-.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.04f,
-		-.435f, 1.0f, 0.25f,	0.0f, 1.0f, 0.0f,	0.77f, 0.08f,
-		-.385f, 1.0f, 0.32f,	0.0f, 1.0f, 0.0f,	0.83f, 0.13f,
-		-.32f, 1.0f, 0.385f,	0.0f, 1.0f, 0.0f,	0.87f, 0.17f,
-		-.25f, 1.0f, 0.435f,	0.0f, 1.0f, 0.0f,	0.92f, 0.25f,
-		-.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.33f,
-		-.085f, 1.0f, 0.49f,	0.0f, 1.0f, 0.0f,	0.983f, 0.41f,
-		0.0f, 1.0f, 0.5f,		0.0f, 1.0f, 0.0f,	1.0f, 0.5f,
-		.085f, 1.0f, 0.49f,		0.0f, 1.0f, 0.0f,	0.983f, 0.6f,
-		.17f, 1.0f, 0.47f,		0.0f, 1.0f, 0.0f,	0.96f, 0.68f,
-		.25f, 1.0f, 0.435f,		0.0f, 1.0f, 0.0f,	0.92f, 0.77f,
-		.32f, 1.0f, 0.385f,		0.0f, 1.0f, 0.0f,	0.87f, 0.83f,
-		.385f, 1.0f, 0.32f,		0.0f, 1.0f, 0.0f,	0.83f, 0.87f,
-		.435f, 1.0f, 0.25f,		0.0f, 1.0f, 0.0f,	0.77f, 0.92f,
-		.47f, 1.0f, 0.17f,		0.0f, 1.0f, 0.0f,	0.68f, 0.96f,
-		.49f, 1.0f, 0.085f,		0.0f, 1.0f, 0.0f,	0.6f, 0.983f,
-
-		// cylinder body		// normals							// texture coords
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.25,1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f,	0.0,0.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		0.5f, 1.0f, 0.0f,		0.993150651, 0.5f, -0.116841137f, 	0.25,1.0,
-		.49f, 1.0f, -0.085f,	0.993150651, 0.5f, -0.116841137f, 	0.2635,1.0,
-		.98f, 0.0f, -0.17f,		0.993150651, 0.5f, -0.116841137f,	0.0277,0.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.49f, 1.0f, -0.085f,	0.993417103f, 0.5f, -0.229039446f,	0.2635,1.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.94f, 0.0f, -0.34f,		0.993417103f, 0.5f, -0.229039446f,	0.0554,0.0,
-		.87f, 0.0f, -0.5f,		0.993417103f, 0.5f, -0.229039446f,	0.0831,0.0,
-		.47f, 1.0f, -0.17f,		0.993417103f, 0.5f, -0.229039446f,	0.277,1.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.87f, 0.0f, -0.5f,		0.813733339f, 0.5f, -0.581238329f,	0.0831,0.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.435f, 1.0f, -0.25f,	0.813733339f, 0.5f, -0.581238329f,	0.2905,1.0,
-		.385f, 1.0f, -0.32f,	0.813733339f, 0.5f, -0.581238329f,	0.304,1.0,
-		.77f, 0.0f, -0.64f,		0.813733339f, 0.5f, -0.581238329f,	0.1108,0.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.385f, 1.0f, -0.32f,	0.707106769f, 0.5f, -0.707106769f,	0.304,1.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175,1.0,
-		.64f, 0.0f, -0.77f,		0.707106769f, 0.5f, -0.707106769f,	0.1385,0.0,
-		.5f, 0.0f, -0.87f,		0.707106769f, 0.5f, -0.707106769f,	0.1662,0.0,
-		.32f, 1.0f, -0.385f,	0.707106769f, 0.5f, -0.707106769f,	0.3175, 1.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.5f, 0.0f, -0.87f,		0.400818795f, 0.5f, -0.916157305f,	0.1662, 0.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.25f, 1.0f, -0.435f,	0.400818795f, 0.5f, -0.916157305f,	0.331, 1.0,
-		.17f, 1.0f, -0.47f,		0.400818795f, 0.5f, -0.916157305f,	0.3445, 1.0,
-		.34f, 0.0f, -0.94f,		0.400818795f, 0.5f, -0.916157305f,	0.1939, 0.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		.17f, 1.0f, -0.47f,		0.229039446f, 0.5f, -0.973417103f,	0.3445, 1.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		.17f, 0.0f, -0.98f,		0.229039446f, 0.5f, -0.973417103f,	0.2216, 0.0,
-		0.0f, 0.0f, -1.0f,		0.229039446f, 0.5f, -0.973417103f,	0.2493, 0.0,
-		.085f, 1.0f, -0.49f,	0.229039446f, 0.5f, -0.973417103f,	0.358, 1.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		0.0f, 0.0f, -1.0f,		-0.116841137f, 0.5f, -0.993150651f,	0.2493, 0.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		0.0f, 1.0f, -0.5f,		-0.116841137f, 0.5f, -0.993150651f,	0.3715, 1.0,
-		-.085f, 1.0f, -0.49f,	-0.116841137f, 0.5f, -0.993150651f,	0.385, 1.0,
-		-.17f, 0.0f, -0.98f,	-0.116841137f, 0.5f, -0.993150651f,	0.277, 0.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.085f, 1.0f, -0.49f,	-0.229039446f, 0.5f, -0.973417103f,	0.385, 1.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.34f, 0.0f, -0.94f,	-0.229039446f, 0.5f, -0.973417103f,	0.3047, 0.0,
-		-.5f, 0.0f, -0.87f,		-0.229039446f, 0.5f, -0.973417103f,	0.3324, 0.0,
-		-.17f, 1.0f, -0.47f,	-0.229039446f, 0.5f, -0.973417103f,	0.3985, 1.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.5f, 0.0f, -0.87f,		-0.581238329f, 0.5f, -0.581238329f,	0.3324, 0.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.25f, 1.0f, -0.435f,	-0.581238329f, 0.5f, -0.581238329f,	0.412, 1.0,
-		-.32f, 1.0f, -0.385f,	-0.581238329f, 0.5f, -0.581238329f,	0.4255, 1.0,
-		-.64f, 0.0f, -0.77f,	-0.581238329f, 0.5f, -0.581238329f,	0.3601, 0.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.32f, 1.0f, -0.385f,	-0.707106769f, 0.5f, -0.707106769f,	0.4255, 1.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.77f, 0.0f, -0.64f,	-0.707106769f, 0.5f, -0.707106769f,	0.3878, 0.0,
-		-.87f, 0.0f, -0.5f,		-0.707106769f, 0.5f, -0.707106769f,	0.4155, 0.0,
-		-.385f, 1.0f, -0.32f,	-0.707106769f, 0.5f, -0.707106769f,	0.439, 1.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.87f, 0.0f, -0.5f,		-0.916157305f, 0.5f, -0.400818795f,	0.4155, 0.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.435f, 1.0f, -0.25f,	-0.916157305f, 0.5f, -0.400818795f,	0.4525, 1.0,
-		-.47f, 1.0f, -0.17f,	-0.916157305f, 0.5f, -0.400818795f,	0.466, 1.0,
-		-.94f, 0.0f, -0.34f,	-0.916157305f, 0.5f, -0.400818795f,	0.4432, 0.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-.47f, 1.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.466, 1.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-.98f, 0.0f, -0.17f,	-0.973417103f, 0.5f, -0.229039446f,	0.4709, 0.0,
-		-1.0f, 0.0f, 0.0f,		-0.973417103f, 0.5f, -0.229039446f,	0.4986, 0.0,
-		-.49f, 1.0f, -0.085f,	-0.973417103f, 0.5f, -0.229039446f,	0.4795, 1.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.493, 1.0,
-		-1.0f, 0.0f, 0.0f,		-0.993150651f, 0.5f, -0.116841137f,	0.4986, 0.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-0.5f, 1.0f, 0.0f,		-0.993150651f, 0.5f, 0.116841137f,	0.493, 1.0,
-		-.49f, 1.0f, 0.085f,	-0.993150651f, 0.5f, 0.116841137f,	0.5065, 1.0,
-		-.98f, 0.0f, 0.17f,		-0.993150651f, 0.5f, 0.116841137f,	0.5263, 0.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.49f, 1.0f, 0.085f,	-0.973417103f, 0.5f, 0.229039446f,	0.5065, 1.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.94f, 0.0f, 0.34f,		-0.973417103f, 0.5f, 0.229039446f,	0.554, 0.0,
-		-.87f, 0.0f, 0.5f,		-0.973417103f, 0.5f, 0.229039446f,	0.5817, 0.0,
-		-.47f, 1.0f, 0.17f,		-0.973417103f, 0.5f, 0.229039446f,	0.52, 1.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.87f, 0.0f, 0.5f,		-0.813733339f, 0.5f, 0.581238329f,	0.5817, 0.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.435f, 1.0f, 0.25f,	-0.813733339f, 0.5f, 0.581238329f,	0.5335, 1.0,
-		-.385f, 1.0f, 0.32f,	-0.813733339f, 0.5f, 0.581238329f,	0.547, 1.0,
-		-.77f, 0.0f, 0.64f,		-0.813733339f, 0.5f, 0.581238329f,	0.6094, 0.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.385f, 1.0f, 0.32f,	-0.707106769f, 0.5f, 0.707106769f,	0.547, 1.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.64f, 0.0f, 0.77f,		-0.707106769f, 0.5f, 0.707106769f,	0.6371, 0.0,
-		-.5f, 0.0f, 0.87f,		-0.707106769f, 0.5f, 0.707106769f,	0.6648, 0.0,
-		-.32f, 1.0f, 0.385f,	-0.707106769f, 0.5f, 0.707106769f,	0.5605, 1.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.5f, 0.0f, 0.87f,		-0.400818795f, 0.5f, 0.916157305f,	0.6648, 0.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.25f, 1.0f, 0.435f,	-0.400818795f, 0.5f, 0.916157305f,	0.574, 1.0,
-		-.17f, 1.0f, 0.47f,		-0.400818795f, 0.5f, 0.916157305f,	0.5875, 1.0,
-		-.34f, 0.0f, 0.94f,		-0.400818795f, 0.5f, 0.916157305f,	0.6925, 0.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		-.17f, 1.0f, 0.47f,		-0.229039446f, 0.5f, 0.973417103f,	0.5875, 1.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		-.17f, 0.0f, 0.98f,		-0.229039446f, 0.5f, 0.973417103f,	0.7202, 0.0,
-		0.0f, 0.0f, 1.0f,		-0.229039446f, 0.5f, 0.973417103f,	0.7479, 0.0,
-		-.085f, 1.0f, 0.49f,	-0.229039446f, 0.5f, 0.973417103f,	0.601, 1.0,
-		0.0f, 1.0f, 0.5f,		-0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		0.0f, 0.0f, 1.0f,		-0.116841137f, 0.5f, 0.993150651f,	0.7479, 0.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		0.0f, 1.0f, 0.5f,		0.116841137f, 0.5f, 0.993150651f,	0.6145, 1.0,
-		.085f, 1.0f, 0.49f,		0.116841137f, 0.5f, 0.993150651f,	0.628, 1.0,
-		.17f, 0.0f, 0.98f,		0.116841137f, 0.5f, 0.993150651f,	0.7756, 0.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.085f, 1.0f, 0.49f,		0.229039446f, 0.5f, 0.973417103f,	0.628, 1.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.34f, 0.0f, 0.94f,		0.229039446f, 0.5f, 0.973417103f,	0.8033, 0.0,
-		.5f, 0.0f, 0.87f,		0.229039446f, 0.5f, 0.973417103f,	0.831, 0.0,
-		.17f, 1.0f, 0.47f,		0.229039446f, 0.5f, 0.973417103f,	0.6415, 1.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.5f, 0.0f, 0.87f,		0.581238329f, 0.5f, 0.813733339f,	0.831, 0.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.25f, 1.0f, 0.435f,		0.581238329f, 0.5f, 0.813733339f,	0.655, 1.0,
-		.32f, 1.0f, 0.385f,		0.581238329f, 0.5f, 0.813733339f,	0.6685, 1.0,
-		.64f, 0.0f, 0.77f,		0.581238329f, 0.5f, 0.813733339f,	0.8587, 0.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.32f, 1.0f, 0.385f,		0.707106769f, 0.5f, 0.707106769f,	0.6685, 1.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.77f, 0.0f, 0.64f,		0.707106769f, 0.5f, 0.707106769f,	0.8864, 0.0,
-		.87f, 0.0f, 0.5f,		0.707106769f, 0.5f, 0.707106769f,	0.9141, 0.0,
-		.385f, 1.0f, 0.32f,		0.707106769f, 0.5f, 0.707106769f,	0.682, 1.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.87f, 0.0f, 0.5f,		0.916157305f, 0.5f, 0.400818795f,	0.9141, 0.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 0.0,
-		.435f, 1.0f, 0.25f,		0.916157305f, 0.5f, 0.400818795f,	0.6955, 1.0,
-		.47f, 1.0f, 0.17f,		0.916157305f, 0.5f, 0.400818795f,	0.709, 1.0,
-		.94f, 0.0f, 0.34f,		0.916157305f, 0.5f, 0.400818795f,	0.9418, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		.47f, 1.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.709, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		.98f, 0.0f, 0.17f,		0.973417103f, 0.5f, 0.229039446f,	0.9695, 0.0,
-		1.0f, 0.0f, 0.0f,		0.973417103f, 0.5f, 0.229039446f,	1.0, 0.0,
-		.49f, 1.0f, 0.085f,		0.973417103f, 0.5f, 0.229039446f,	0.7225, 1.0,
-		0.5f, 1.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	0.75, 1.0,
-		1.0f, 0.0f, 0.0f,		0.993150651f, 0.5f, 0.116841137f,	1.0, 0.0
-	};
-
-	// store vertex and index count
-	m_TaperedCylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_TaperedCylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	const std::string cacheName = "tapered_cylinder_" + std::to_string(segments);
+	const float parameters[] = { (float)segments };
+	const uint64_t generatorHash = HashGenerator(MESH_TAPERED_CYLINDER, parameters, 1);
+	if (LoadCachedMesh(MESH_TAPERED_CYLINDER, cacheName, generatorHash) == true)
+	{
+		return;
+	}
 
-	if (m_bMemoryLayoutDone == false)
+	if (segments == MeshGenerator::DEFAULT_CYLINDER_SEGMENTS)
 	{
-		SetShaderMemoryLayout();
+		AddGeneratedMesh(m_TaperedCylinderMesh, MeshGenerator::GetMeshView(g_DefaultTaperedCylinder));
+	}
+	else
+	{
+		MeshGenerator::MeshData data;
+		MeshGenerator::GenerateCylinder(segments, g_TaperedCylinderTopRadius, data);
+		AddGeneratedMesh(m_TaperedCylinderMesh, MeshGenerator::GetMeshView(data));
 	}
+
+	GenerateMeshLods(MESH_TAPERED_CYLINDER);
+	SaveCachedMesh(MESH_TAPERED_CYLINDER, cacheName, generatorHash);
 }
 
 ///////////////////////////////////////////////////
 //	LoadTorusMesh()
 //
-//	Create a torus mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
-//
-//	Correct triangle drawing command:
-//
-//	glDrawArrays(GL_TRIANGLES, 0, meshes.gTorusMesh.nVertices);
+//	Create a torus mesh with the passed in tube
+//  thickness and numbers of segments around the ring
+//  and around the tube, and add it to the shared
+//  buffers.  The ring is built from the +X axis
+//  around, so the first half of its indices is the
+//  half torus.  The default torus is built by the
+//  compiler, any other one is generated here.
 ///////////////////////////////////////////////////
-void ShapeMeshes::LoadTorusMesh(float thickness)
+void ShapeMeshes::LoadTorusMesh(
+	float thickness,
+	int mainSegments,
+	int tubeSegments)
 {
-	int _mainSegments = 30;
-	int _tubeSegments = 30;
-	float _mainRadius = 1.0f;
-	float _tubeRadius = .1f;
+	float tubeRadius = 0.1f;
 
 	if (thickness <= 1.0)
 	{
-		_tubeRadius = thickness;
+		tubeRadius = thickness;
 	}
 
-	auto mainSegmentAngleStep = glm::radians(360.0f / float(_mainSegments));
-	auto tubeSegmentAngleStep = glm::radians(360.0f / float(_tubeSegments));
-
-	std::vector<glm::vec3> vertex_list;
-	std::vector<std::vector<glm::vec3>> segments_list;
-	std::vector<glm::vec2> texture_coords;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	glm::vec3 normal;
-	glm::vec3 vertex;
-	glm::vec2 text_coord;
-
-	// generate the torus vertices
-	auto currentMainSegmentAngle = 0.0f;
-	for (auto i = 0; i < _mainSegments; i++)
+	// the thickness is part of the name in thousandths, and part of
+	// the generator hash at full precision
+	const std::string cacheName = "torus_" + std::to_string((int)(thickness * 1000.0f + 0.5f)) + "_" +
+		std::to_string(mainSegments) + "x" + std::to_string(tubeSegments);
+	const float parameters[] = { tubeRadius, (float)mainSegments, (float)tubeSegments };
+	const uint64_t generatorHash = HashGenerator(MESH_TORUS, parameters, 3);
+	if (LoadCachedMesh(MESH_TORUS, cacheName, generatorHash) == true)
 	{
-		// Calculate sine and cosine of main segment angle
-		auto sinMainSegment = sin(currentMainSegmentAngle);
-		auto cosMainSegment = cos(currentMainSegmentAngle);
-		auto currentTubeSegmentAngle = 0.0f;
-		std::vector<glm::vec3> segment_points;
-		for (auto j = 0; j < _tubeSegments; j++)
-		{
-			// Calculate sine and cosine of tube segment angle
-			auto sinTubeSegment = sin(currentTubeSegmentAngle);
-			auto cosTubeSegment = cos(currentTubeSegmentAngle);
-
-			// Calculate vertex position on the surface of torus
-			auto surfacePosition = glm::vec3(
-				(_mainRadius + _tubeRadius * cosTubeSegment) * cosMainSegment,
-				(_mainRadius + _tubeRadius * cosTubeSegment) * sinMainSegment,
-				_tubeRadius * sinTubeSegment);
-
-			//vertex_list.push_back(surfacePosition);
-			segment_points.push_back(surfacePosition);
-
-			// Update current tube angle
-			currentTubeSegmentAngle += tubeSegmentAngleStep;
-		}
-		segments_list.push_back(segment_points);
-		segment_points.clear();
-
-		// Update main segment angle
-		currentMainSegmentAngle += mainSegmentAngleStep;
+		return;
 	}
 
-	float horizontalStep = 1.0 / _mainSegments;
-	float verticalStep = 1.0 / _tubeSegments;
-	float u = 0.0;
-	float v = 0.0;
-
-	// connect the various segments together, forming triangles
-	for (int i = 0; i < _mainSegments; i++)
+	if ((mainSegments == MeshGenerator::DEFAULT_TORUS_MAIN_SEGMENTS) &&
+		(tubeSegments == MeshGenerator::DEFAULT_TORUS_TUBE_SEGMENTS) &&
+		(tubeRadius == MeshGenerator::DEFAULT_TORUS_THICKNESS))
 	{
-		for (int j = 0; j < _tubeSegments; j++)
-		{
-			if (((i + 1) < _mainSegments) && ((j + 1) < _tubeSegments))
-			{
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i][j + 1]);
-				texture_coords.push_back(glm::vec2(u, v + verticalStep));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v + verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i + 1][j]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v - verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-			}
-			else
-			{
-				if (((i + 1) == _mainSegments) && ((j + 1) == _tubeSegments))
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((i + 1) == _mainSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][j + 1]);
-					texture_coords.push_back(glm::vec2(u, v + verticalStep));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((j + 1) == _tubeSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i + 1][j]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-
-			}
-			v += verticalStep;
-		}
-		v = 0.0;
-		u += horizontalStep;
+		AddGeneratedMesh(m_TorusMesh, MeshGenerator::GetMeshView(g_DefaultTorus));
 	}
-
-	std::vector<GLfloat> combined_values;
-
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < vertex_list.size(); i++)
+	else
 	{
-		vertex = vertex_list[i];
-		normal = normalize(vertex);
-		if (vertex.x < 0)
-		{
-			if (normal.x > 0)
-				normal.x *= -1;
-		}
-		else if (vertex.x > 0)
-		{
-			if (normal.x < 0)
-				normal.x *= -1;
-		}
-		if (vertex.y < 0)
-		{
-			if (normal.y > 0)
-				normal.y *= -1;
-		}
-		else if (vertex.y > 0)
-		{
-			if (normal.y < 0)
-				normal.y *= -1;
-		}
-		if (vertex.z < 0)
-		{
-			if (normal.z > 0)
-				normal.z *= -1;
-		}
-		else if (vertex.z > 0)
-		{
-			if (normal.z < 0)
-				normal.z *= -1;
-		}
-		text_coord = texture_coords[i];
-		combined_values.push_back(vertex.x);
-		combined_values.push_back(vertex.y);
-		combined_values.push_back(vertex.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(text_coord.x);
-		combined_values.push_back(text_coord.y);
+		MeshGenerator::MeshData data;
+		MeshGenerator::GenerateTorus(mainSegments, tubeSegments, tubeRadius, data);
+		AddGeneratedMesh(m_TorusMesh, MeshGenerator::GetMeshView(data));
 	}
 
-	// store vertex and index count
-	m_TorusMesh.nVertices = vertex_list.size();
-	m_TorusMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TorusMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	GenerateMeshLods(MESH_TORUS, tubeRadius);
+	SaveCachedMesh(MESH_TORUS, cacheName, generatorHash);
 }
 
 
@@ -2189,42 +654,37 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 ///////////////////////////////////////////////////
 //	DrawBoxMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the box mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMesh()
 {
-	glBindVertexArray(m_BoxMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_BOX);
 }
 
 ///////////////////////////////////////////////////
 //	DrawConeMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the cone mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawConeMesh(
 	bool bDrawBottom)
 {
-	glBindVertexArray(m_ConeMesh.vao);
+	unsigned int parts = MESH_PART_SIDES;
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
+		parts |= MESH_PART_BOTTOM;
 	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
 
-	glBindVertexArray(0);
+	DrawMesh(MESH_CONE, parts);
 }
 
 ///////////////////////////////////////////////////
 //	DrawCylinderMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the cylinder mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawCylinderMesh(
@@ -2232,22 +692,22 @@ void ShapeMeshes::DrawCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
+	unsigned int parts = 0;
 
-	if (bDrawBottom == true)
+	if (bDrawTop == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		parts |= MESH_PART_TOP;
 	}
-	if (bDrawTop == true)
+	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
+		parts |= MESH_PART_BOTTOM;
 	}
 	if (bDrawSides == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		parts |= MESH_PART_SIDES;
 	}
 
-	glBindVertexArray(0);
+	DrawMesh(MESH_CYLINDER, parts);
 }
 
 ///////////////////////////////////////////////////
@@ -2258,92 +718,68 @@ void ShapeMeshes::DrawCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-	
-	glBindVertexArray(0);
+	DrawMesh(MESH_PLANE);
 }
 
 ///////////////////////////////////////////////////
 //	DrawPrismMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the prism mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_PRISM);
 }
 
 ///////////////////////////////////////////////////
 //	DrawPyramid3Mesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the 3-sided pyramid mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_PYRAMID3);
 }
 
 ///////////////////////////////////////////////////
 //	DrawPyramid4Mesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the 4-sided pyramid mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_PYRAMID4);
 }
 
 ///////////////////////////////////////////////////
 //	DrawSphereMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the sphere mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_SPHERE);
 }
 
 ///////////////////////////////////////////////////
 //	DrawHalfSphereMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the half sphere mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
-
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_HALF_SPHERE);
 }
 
 ///////////////////////////////////////////////////
 //	DrawTaperedCylinderMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the tapered cylinder mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTaperedCylinderMesh(
@@ -2351,91 +787,1175 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
+	unsigned int parts = 0;
 
-	if (bDrawBottom == true)
+	if (bDrawTop == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		parts |= MESH_PART_TOP;
 	}
-	if (bDrawTop == true)
+	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 72);	//top
+		parts |= MESH_PART_BOTTOM;
 	}
 	if (bDrawSides == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		parts |= MESH_PART_SIDES;
 	}
 
-	glBindVertexArray(0);
+	DrawMesh(MESH_TAPERED_CYLINDER, parts);
 }
 
 ///////////////////////////////////////////////////
 //	DrawTorusMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the torus mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
-
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
-
-	glBindVertexArray(0);
+	DrawMesh(MESH_TORUS);
 }
 
 ///////////////////////////////////////////////////
 //	DrawHalfTorusMesh()
 //
-//	Transform and draw the plane mesh to the window.
+//	Transform and draw the half torus mesh to the window.
 // 
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	DrawMesh(MESH_HALF_TORUS);
+}
+
+///////////////////////////////////////////////////
+//	DrawMesh()
+//
+//	Draw the identified shape mesh.  The parts flags
+//  are only used by the shapes that have caps.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMesh(
+	MeshID mesh,
+	unsigned int parts)
+{
+	MeshRange range;
+	GLint baseVertex = 0;
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+	if (GetMeshRange(mesh, parts, 0, range, baseVertex) == false)
+	{
+		return;
+	}
 
-	glBindVertexArray(0);
+	BindMeshBuffers(GetMeshVertexFormat(mesh));
+
+	glDrawElementsBaseVertex(GL_TRIANGLES, range.nIndices, GL_UNSIGNED_INT,
+		(void*)(sizeof(GLuint) * range.firstIndex), baseVertex);
 }
 
-glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
+///////////////////////////////////////////////////
+//	DrawMeshInstanced()
+//
+//	Draw many copies of the identified shape mesh.
+//  The vertex shader positions the instances with
+//  their model view projection and normal matrices,
+//  which are filled into the uploaded copy from the
+//  model matrices and the passed in view and
+//  projection, so the caller only sets the model
+//  matrix and the parameters of each instance.
+//  Returns false if the shape has not been loaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::DrawMeshInstanced(
+	MeshID mesh,
+	const InstanceData* pInstances,
+	GLsizei nInstances,
+	const glm::mat4& viewProjection,
+	unsigned int parts)
 {
-	glm::vec3 Normal(0, 0, 0);
-	float v1x = p1.x - p0.x;
-	float v1y = p1.y - p0.y;
-	float v1z = p1.z - p0.z;
-	float v2x = p2.x - p1.x;
-	float v2y = p2.y - p1.y;
-	float v2z = p2.z - p1.z;
-	Normal.x = v1y * v2z - v1z * v2y;
-	Normal.y = v1z * v2x - v1x * v2z;
-	Normal.y = v1x * v2y - v1y * v2x;
-	float len = (float)sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
-	if (len == 0)
+	MeshRange range;
+	GLint baseVertex = 0;
+
+	if (GetMeshRange(mesh, parts, 0, range, baseVertex) == false)
 	{
-		//throw Exception();
+		return(false);
 	}
-	else
+	if ((NULL == pInstances) || (nInstances <= 0))
 	{
-		Normal.x /= len;
-		Normal.y /= len;
-		Normal.z /= len;
+		return(true);
 	}
-	return Normal;
-}
 
+	// the instance buffer is bound to both vertex arrays, so it is
+	// uploaded before the vertex array of the mesh is bound
+	UploadInstanceData(pInstances, nInstances, &viewProjection);
+	BindMeshBuffers(GetMeshVertexFormat(mesh));
 
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.nIndices, GL_UNSIGNED_INT,
+		(void*)(sizeof(GLuint) * range.firstIndex), nInstances, baseVertex);
 
-void ShapeMeshes::SetShaderMemoryLayout()
-{
-	// The following code defines the layout of the mesh data in memory - each mesh needs
-	// to have the same memory layout so that the data is retrieved properly by the shaders
+	return(true);
+}
 
-	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
-	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
+///////////////////////////////////////////////////
+//	DrawBoxMeshInstanced()
+//
+//	Draw one copy of the box mesh for each of the
+//  passed in instances with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawBoxMeshInstanced(
+	const InstanceData* pInstances,
+	GLsizei nInstances,
+	const glm::mat4& viewProjection)
+{
+	DrawMeshInstanced(MESH_BOX, pInstances, nInstances, viewProjection);
+}
 
-	// Create Vertex Attribute Pointers
+///////////////////////////////////////////////////
+//	DrawPlaneMeshInstanced()
+//
+//	Draw one copy of the plane mesh for each of the
+//  passed in instances with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPlaneMeshInstanced(
+	const InstanceData* pInstances,
+	GLsizei nInstances,
+	const glm::mat4& viewProjection)
+{
+	DrawMeshInstanced(MESH_PLANE, pInstances, nInstances, viewProjection);
+}
+
+///////////////////////////////////////////////////
+//	DrawSphereMeshInstanced()
+//
+//	Draw one copy of the sphere mesh for each of the
+//  passed in instances with a single draw call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawSphereMeshInstanced(
+	const InstanceData* pInstances,
+	GLsizei nInstances,
+	const glm::mat4& viewProjection)
+{
+	DrawMeshInstanced(MESH_SPHERE, pInstances, nInstances, viewProjection);
+}
+
+///////////////////////////////////////////////////
+//	UploadMeshBuffers()
+//
+//	Upload the data of all of the loaded meshes into
+//  the shared vertex and index buffers, and set up
+//  the shared vertex array the first time.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadMeshBuffers()
+{
+	if (0 == m_vao)
+	{
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vertexBuffer);
+		glGenBuffers(1, &m_indexBuffer);
+		glGenBuffers(1, &m_instanceVBO);
+		glGenVertexArrays(1, &m_packedVAO);
+		glGenBuffers(1, &m_packedVertexBuffer);
+	}
+
+	// the packed vertex array shares the index and instance buffers
+	glBindVertexArray(m_packedVAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_packedVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(PackedVertex) * m_packedVertexData.size(), m_packedVertexData.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+
+	if (m_bMemoryLayoutDone == false)
+	{
+		SetPackedMemoryLayout();
+		SetInstanceMemoryLayout();
+	}
+
+	glBindVertexArray(m_vao);
+
+	// each mesh is copied into its place from the data copy or
+	// straight from its mapped cache file
+	const GLsizeiptr vertexSize = sizeof(GLfloat) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertexSize * m_nSharedVertices, NULL, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * m_nSharedIndices, NULL, GL_STATIC_DRAW);
+
+	for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+	{
+		for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+		{
+			const GLMesh* pMesh = GetMeshLevel((MeshID)mesh, lod);
+			if ((NULL == pMesh) || (pMesh->bLoaded == false))
+			{
+				continue;
+			}
+
+			glBufferSubData(GL_ARRAY_BUFFER, vertexSize * pMesh->baseVertex,
+				vertexSize * pMesh->nVertices, GetMeshVertexData(*pMesh));
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * pMesh->firstIndex,
+				sizeof(GLuint) * (pMesh->nIndices + pMesh->nCombinationIndices), GetMeshIndexData(*pMesh));
+		}
+	}
+
+	if (m_bMemoryLayoutDone == false)
+	{
+		SetShaderMemoryLayout();
+		SetInstanceMemoryLayout();
+		m_bMemoryLayoutDone = true;
+	}
+
+	m_bBuffersDirty = false;
+}
+
+///////////////////////////////////////////////////
+//	AddDrawCommands()
+//
+//	Add the indirect draw command for the parts of
+//  the identified shape mesh to the passed in list.
+///////////////////////////////////////////////////
+int ShapeMeshes::AddDrawCommands(
+	MeshID mesh,
+	unsigned int parts,
+	int lod,
+	GLuint instanceCount,
+	GLuint baseInstance,
+	std::vector<DrawElementsIndirectCommand>& commands) const
+{
+	MeshRange range;
+	GLint baseVertex = 0;
+
+	if (GetMeshRange(mesh, parts, lod, range, baseVertex) == false)
+	{
+		return(0);
+	}
+
+	DrawElementsIndirectCommand command;
+
+	command.count = range.nIndices;
+	command.instanceCount = instanceCount;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = baseVertex;
+	command.baseInstance = baseInstance;
+	commands.push_back(command);
+
+	return(1);
+}
+
+///////////////////////////////////////////////////
+//	MapInstanceData()
+//
+//	Get the memory for the instance data of a frame.
+//  It is the next region of the persistently mapped
+//  instance ring, which grows when it is too small,
+//  or a staging copy that is uploaded by
+//  UploadIndirectDraws() when there is no ring.
+///////////////////////////////////////////////////
+ShapeMeshes::InstanceData* ShapeMeshes::MapInstanceData(
+	GLsizei nInstances)
+{
+	if (nInstances <= 0)
+	{
+		return(NULL);
+	}
+
+	if ((m_bBuffersDirty == true) || (0 == m_vao))
+	{
+		UploadMeshBuffers();
+	}
+
+	if (RingBuffer::IsSupported() == true)
+	{
+		const GLsizeiptr size = sizeof(InstanceData) * nInstances;
+		if (size > m_instanceRing.GetRegionSize())
+		{
+			GLsizei capacity = g_InitialRingInstances;
+			while (capacity < nInstances)
+			{
+				capacity *= 2;
+			}
+			m_instanceRing.Create(sizeof(InstanceData) * capacity);
+
+			// a new buffer can get the name of the deleted one, which
+			// the vertex arrays still hold on to
+			m_boundInstanceBuffer = 0;
+		}
+
+		InstanceData* pInstances = (InstanceData*)m_instanceRing.BeginRegion();
+		if (NULL != pInstances)
+		{
+			m_stagedInstances.clear();
+			BindInstanceBuffer(m_instanceRing.GetBuffer(), m_instanceRing.GetRegionOffset());
+			return(pInstances);
+		}
+	}
+
+	m_stagedInstances.resize(nInstances);
+	return(m_stagedInstances.data());
+}
+
+///////////////////////////////////////////////////
+//	UploadIndirectDraws()
+//
+//	Upload the indirect draw commands of a frame.
+//  They are written into the next region of the
+//  indirect ring, or into an orphaned buffer when
+//  there is no ring.  The staged instance data is
+//  uploaded too, when there is no instance ring.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadIndirectDraws(
+	const DrawElementsIndirectCommand* pCommands,
+	GLsizei nCommands)
+{
+	if ((NULL == pCommands) || (nCommands <= 0))
+	{
+		return;
+	}
+
+	if (m_stagedInstances.empty() == false)
+	{
+		UploadInstanceData(m_stagedInstances.data(), (GLsizei)m_stagedInstances.size());
+	}
+
+	if (RingBuffer::IsSupported() == true)
+	{
+		const GLsizeiptr size = sizeof(DrawElementsIndirectCommand) * nCommands;
+		if (size > m_indirectRing.GetRegionSize())
+		{
+			GLsizei capacity = g_InitialRingCommands;
+			while (capacity < nCommands)
+			{
+				capacity *= 2;
+			}
+			m_indirectRing.Create(sizeof(DrawElementsIndirectCommand) * capacity);
+		}
+
+		void* pMapped = m_indirectRing.BeginRegion();
+		if (NULL != pMapped)
+		{
+			memcpy(pMapped, pCommands, size);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectRing.GetBuffer());
+			m_indirectOffset = m_indirectRing.GetRegionOffset();
+			return;
+		}
+	}
+
+	if (0 == m_indirectBuffer)
+	{
+		glGenBuffers(1, &m_indirectBuffer);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+	m_indirectOffset = 0;
+
+	// grow the indirect buffer when needed, otherwise orphan the
+	// old storage so the driver does not stall on a previous draw
+	if (nCommands > m_indirectCapacity)
+	{
+		m_indirectCapacity = nCommands;
+	}
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * m_indirectCapacity, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawElementsIndirectCommand) * nCommands, pCommands);
+}
+
+///////////////////////////////////////////////////
+//	DrawIndirect()
+//
+//	Draw a range of the commands that were uploaded
+//  by UploadIndirectDraws() with a single call.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawIndirect(
+	VertexFormat format,
+	GLsizei firstCommand,
+	GLsizei nCommands)
+{
+	if (nCommands <= 0)
+	{
+		return;
+	}
+
+	// the indirect buffer is not part of the vertex array state,
+	// so it stays bound when switching between the formats
+	glBindVertexArray((format == VERTEX_FORMAT_PACKED) ? m_packedVAO : m_vao);
+
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+		(void*)(m_indirectOffset + sizeof(DrawElementsIndirectCommand) * firstCommand), nCommands, 0);
+}
+
+///////////////////////////////////////////////////
+//	AddMeshData()
+//
+//	Append the vertices and indices of a mesh to the
+//  data of the shared buffers.  A mesh that was
+//  already loaded is not added a second time.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddMeshData(
+	GLMesh& mesh,
+	const GLfloat* pVertices,
+	GLuint nVertices,
+	const GLuint* pIndices,
+	GLuint nIndices)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	if (mesh.bLoaded == true)
+	{
+		return;
+	}
+
+	mesh.nVertices = nVertices;
+	mesh.nIndices = nIndices;
+	mesh.baseVertex = (GLint)m_nSharedVertices;
+	mesh.firstIndex = m_nSharedIndices;
+	mesh.dataVertex = (GLuint)(m_vertexData.size() / floatsPerVertex);
+	mesh.dataIndex = (GLuint)m_indexData.size();
+	mesh.bHasParts = false;
+	mesh.bLoaded = true;
+
+	m_vertexData.insert(m_vertexData.end(), pVertices, pVertices + (nVertices * floatsPerVertex));
+	m_indexData.insert(m_indexData.end(), pIndices, pIndices + nIndices);
+	m_nSharedVertices += nVertices;
+	m_nSharedIndices += nIndices;
+	m_bBuffersDirty = true;
+
+	// the bounding box of the vertex positions, and the sphere
+	// around its center that holds all of the vertices
+	glm::vec3 minimum(0.0f);
+	glm::vec3 maximum(0.0f);
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		glm::vec3 position(pVertices[i * floatsPerVertex], pVertices[(i * floatsPerVertex) + 1], pVertices[(i * floatsPerVertex) + 2]);
+		minimum = (i == 0) ? position : glm::min(minimum, position);
+		maximum = (i == 0) ? position : glm::max(maximum, position);
+	}
+
+	glm::vec3 center = (minimum + maximum) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (GLuint i = 0; i < nVertices; i++)
+	{
+		glm::vec3 offset = glm::vec3(pVertices[i * floatsPerVertex], pVertices[(i * floatsPerVertex) + 1], pVertices[(i * floatsPerVertex) + 2]) - center;
+		radiusSquared = glm::max(radiusSquared, glm::dot(offset, offset));
+	}
+
+	mesh.bounds.minimum = minimum;
+	mesh.bounds.maximum = maximum;
+	mesh.bounds.center = center;
+	mesh.bounds.radius = sqrtf(radiusSquared);
+}
+
+///////////////////////////////////////////////////
+//	SetMeshPartRange()
+//
+//	Set the index range of the top, bottom or sides
+//  of a mesh, relative to the first mesh index.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetMeshPartRange(
+	GLMesh& mesh,
+	MeshPart part,
+	GLuint firstIndex,
+	GLuint nIndices)
+{
+	int index = 0;
+
+	switch (part)
+	{
+	case MESH_PART_TOP: index = 0; break;
+	case MESH_PART_BOTTOM: index = 1; break;
+	case MESH_PART_SIDES: index = 2; break;
+	default: return;
+	}
+
+	mesh.parts[index].firstIndex = firstIndex;
+	mesh.parts[index].nIndices = nIndices;
+	mesh.bHasParts = true;
+}
+
+///////////////////////////////////////////////////
+//	GetMeshBounds()
+//
+//	Get the local bounding volumes of a shape mesh.
+//  The half shapes use the bounds of the whole
+//  shapes, which always contain them.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshBounds(
+	MeshID mesh,
+	MeshBounds& bounds) const
+{
+	bool bHalf = false;
+	const GLMesh* pMesh = GetLoadedMesh(mesh, 0, bHalf);
+
+	if (NULL == pMesh)
+	{
+		return(false);
+	}
+
+	bounds = pMesh->bounds;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshLevel()
+//
+//	Get the storage of a whole shape at a level of
+//  detail, whether it is loaded or not.  The half
+//  shapes have no storage of their own.
+///////////////////////////////////////////////////
+ShapeMeshes::GLMesh* ShapeMeshes::GetMeshLevel(
+	MeshID mesh,
+	int lod)
+{
+	if ((mesh < 0) || (mesh >= MESH_COUNT) || (lod < 0) || (lod >= MESH_LOD_COUNT))
+	{
+		return(NULL);
+	}
+	if (lod > 0)
+	{
+		return(&m_LodMeshes[mesh][lod - 1]);
+	}
+
+	switch (mesh)
+	{
+	case MESH_BOX: return(&m_BoxMesh);
+	case MESH_CONE: return(&m_ConeMesh);
+	case MESH_CYLINDER: return(&m_CylinderMesh);
+	case MESH_PLANE: return(&m_PlaneMesh);
+	case MESH_PRISM: return(&m_PrismMesh);
+	case MESH_PYRAMID3: return(&m_Pyramid3Mesh);
+	case MESH_PYRAMID4: return(&m_Pyramid4Mesh);
+	case MESH_SPHERE: return(&m_SphereMesh);
+	case MESH_TAPERED_CYLINDER: return(&m_TaperedCylinderMesh);
+	case MESH_TORUS: return(&m_TorusMesh);
+	default: return(NULL);
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetMeshVertexData()
+//
+//	Get the interleaved vertices of a loaded mesh.
+///////////////////////////////////////////////////
+const GLfloat* ShapeMeshes::GetMeshVertexData(
+	const GLMesh& mesh) const
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	if (NULL != mesh.pMappedVertices)
+	{
+		return(mesh.pMappedVertices);
+	}
+
+	return(m_vertexData.data() + ((size_t)mesh.dataVertex * floatsPerVertex));
+}
+
+///////////////////////////////////////////////////
+//	GetMeshIndexData()
+//
+//	Get the indices of a loaded mesh.
+///////////////////////////////////////////////////
+const GLuint* ShapeMeshes::GetMeshIndexData(
+	const GLMesh& mesh) const
+{
+	if (NULL != mesh.pMappedIndices)
+	{
+		return(mesh.pMappedIndices);
+	}
+
+	return(m_indexData.data() + mesh.dataIndex);
+}
+
+///////////////////////////////////////////////////
+//	SetMeshCacheDirectory()
+//
+//	Enable the mesh cache files in the passed in
+//  directory.  The cache stays disabled when the
+//  directory cannot be created.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetMeshCacheDirectory(
+	const std::string& path)
+{
+	m_cacheDirectory.clear();
+
+	if ((path.empty() == false) && (MeshCache::CreateCacheDirectory(path) == true))
+	{
+		m_cacheDirectory = path;
+	}
+}
+
+///////////////////////////////////////////////////
+//	LoadCachedMesh()
+//
+//	Map the cache file of a shape and point its levels
+//  of detail at the data in the mapping, which stays
+//  open until the meshes are destroyed.  Returns true
+//  when the shape is loaded afterwards, which is also
+//  the case when it was loaded before.
+///////////////////////////////////////////////////
+bool ShapeMeshes::LoadCachedMesh(
+	MeshID mesh,
+	const std::string& name,
+	uint64_t generatorHash)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	GLMesh* pBaseMesh = GetMeshLevel(mesh, 0);
+
+	if (NULL == pBaseMesh)
+	{
+		return(false);
+	}
+	if (pBaseMesh->bLoaded == true)
+	{
+		return(true);
+	}
+	if (m_cacheDirectory.empty() == true)
+	{
+		return(false);
+	}
+
+	MeshCache::MappedFile* pFile = new MeshCache::MappedFile();
+	std::vector<MeshCache::MeshLevel> levels;
+	if ((pFile->Open(m_cacheDirectory + "/" + name + ".mesh") == false) ||
+		(MeshCache::ReadMeshFile(*pFile, floatsPerVertex, generatorHash, levels) == false) ||
+		(levels.size() > (size_t)MESH_LOD_COUNT))
+	{
+		delete pFile;
+		m_cacheStats.nMisses++;
+		return(false);
+	}
+
+	for (size_t lod = 0; lod < levels.size(); lod++)
+	{
+		const MeshCache::LevelRecord& record = levels[lod].record;
+		GLMesh& level = *GetMeshLevel(mesh, (int)lod);
+
+		level = GLMesh();
+		level.nVertices = record.nVertices;
+		level.nIndices = record.nIndices;
+		level.nCombinationIndices = record.nCombinationIndices;
+		level.baseVertex = (GLint)m_nSharedVertices;
+		level.firstIndex = m_nSharedIndices;
+		level.pMappedVertices = levels[lod].vertices;
+		level.pMappedIndices = (const GLuint*)levels[lod].indices;
+		level.bHasParts = (record.bHasParts != 0);
+		for (int i = 0; i < 3; i++)
+		{
+			level.parts[i].firstIndex = record.parts[i][0];
+			level.parts[i].nIndices = record.parts[i][1];
+		}
+		for (int i = 0; i <= MESH_PART_ALL; i++)
+		{
+			level.partCombinations[i].firstIndex = record.partCombinations[i][0];
+			level.partCombinations[i].nIndices = record.partCombinations[i][1];
+		}
+		level.bounds.minimum = glm::vec3(record.boundsMinimum[0], record.boundsMinimum[1], record.boundsMinimum[2]);
+		level.bounds.maximum = glm::vec3(record.boundsMaximum[0], record.boundsMaximum[1], record.boundsMaximum[2]);
+		level.bounds.center = glm::vec3(record.boundsCenter[0], record.boundsCenter[1], record.boundsCenter[2]);
+		level.bounds.radius = record.boundsRadius;
+		level.bOptimized = true;
+		level.bLoaded = true;
+
+		m_nSharedVertices += record.nVertices;
+		m_nSharedIndices += record.nIndices + record.nCombinationIndices;
+	}
+
+	m_cacheFiles.push_back(pFile);
+	m_bBuffersDirty = true;
+	m_cacheStats.nHits++;
+
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	SaveCachedMesh()
+//
+//	Write a generated shape and its levels of detail
+//  into its cache file, after they were optimized,
+//  so the next run maps them in their final form.
+///////////////////////////////////////////////////
+void ShapeMeshes::SaveCachedMesh(
+	MeshID mesh,
+	const std::string& name,
+	uint64_t generatorHash)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	if (m_cacheDirectory.empty() == true)
+	{
+		return;
+	}
+
+	std::vector<MeshCache::MeshLevel> levels;
+	for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+	{
+		const GLMesh* pLevel = GetMeshLevel(mesh, lod);
+		if ((NULL == pLevel) || (pLevel->bLoaded == false))
+		{
+			break;
+		}
+
+		MeshCache::MeshLevel level = {};
+		level.record.nVertices = pLevel->nVertices;
+		level.record.nIndices = pLevel->nIndices;
+		level.record.nCombinationIndices = pLevel->nCombinationIndices;
+		level.record.bHasParts = (pLevel->bHasParts == true) ? 1 : 0;
+		for (int i = 0; i < 3; i++)
+		{
+			level.record.parts[i][0] = pLevel->parts[i].firstIndex;
+			level.record.parts[i][1] = pLevel->parts[i].nIndices;
+		}
+		for (int i = 0; i <= MESH_PART_ALL; i++)
+		{
+			level.record.partCombinations[i][0] = pLevel->partCombinations[i].firstIndex;
+			level.record.partCombinations[i][1] = pLevel->partCombinations[i].nIndices;
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			level.record.boundsMinimum[c] = pLevel->bounds.minimum[c];
+			level.record.boundsMaximum[c] = pLevel->bounds.maximum[c];
+			level.record.boundsCenter[c] = pLevel->bounds.center[c];
+		}
+		level.record.boundsRadius = pLevel->bounds.radius;
+		level.vertices = GetMeshVertexData(*pLevel);
+		level.indices = GetMeshIndexData(*pLevel);
+		levels.push_back(level);
+	}
+
+	if ((levels.empty() == false) &&
+		(MeshCache::WriteMeshFile(m_cacheDirectory + "/" + name + ".mesh", floatsPerVertex, generatorHash, levels) == true))
+	{
+		m_cacheStats.nWritten++;
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetLoadedMesh()
+//
+//	Get the loaded mesh that the identified shape is
+//  drawn from at a level of detail, or NULL when it
+//  has not been loaded.  The half shapes share the
+//  levels of detail of the whole shapes.
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh* ShapeMeshes::GetLoadedMesh(
+	MeshID mesh,
+	int lod,
+	bool& bHalf) const
+{
+	const GLMesh* pMesh = NULL;
+	MeshID lodMesh = mesh;
+	bHalf = false;
+
+	switch (mesh)
+	{
+	case MESH_BOX: pMesh = &m_BoxMesh; break;
+	case MESH_CONE: pMesh = &m_ConeMesh; break;
+	case MESH_CYLINDER: pMesh = &m_CylinderMesh; break;
+	case MESH_PLANE: pMesh = &m_PlaneMesh; break;
+	case MESH_PRISM: pMesh = &m_PrismMesh; break;
+	case MESH_PYRAMID3: pMesh = &m_Pyramid3Mesh; break;
+	case MESH_PYRAMID4: pMesh = &m_Pyramid4Mesh; break;
+	case MESH_SPHERE: pMesh = &m_SphereMesh; break;
+	case MESH_HALF_SPHERE: pMesh = &m_SphereMesh; lodMesh = MESH_SPHERE; bHalf = true; break;
+	case MESH_TAPERED_CYLINDER: pMesh = &m_TaperedCylinderMesh; break;
+	case MESH_TORUS: pMesh = &m_TorusMesh; break;
+	case MESH_HALF_TORUS: pMesh = &m_TorusMesh; lodMesh = MESH_TORUS; bHalf = true; break;
+	default: break;
+	}
+
+	if ((NULL == pMesh) || (pMesh->bLoaded == false))
+	{
+		return(NULL);
+	}
+
+	if ((lod > 0) && (lod < MESH_LOD_COUNT) && (m_LodMeshes[lodMesh][lod - 1].bLoaded == true))
+	{
+		pMesh = &m_LodMeshes[lodMesh][lod - 1];
+	}
+
+	return(pMesh);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshLodCount()
+//
+//	Get the number of levels of detail that are
+//  loaded for a shape mesh.
+///////////////////////////////////////////////////
+int ShapeMeshes::GetMeshLodCount(
+	MeshID mesh) const
+{
+	bool bHalf = false;
+	if (NULL == GetLoadedMesh(mesh, 0, bHalf))
+	{
+		return(0);
+	}
+
+	MeshID lodMesh = mesh;
+	if (mesh == MESH_HALF_SPHERE) lodMesh = MESH_SPHERE;
+	if (mesh == MESH_HALF_TORUS) lodMesh = MESH_TORUS;
+
+	int nLods = 1;
+	while ((nLods < MESH_LOD_COUNT) && (m_LodMeshes[lodMesh][nLods - 1].bLoaded == true))
+	{
+		nLods++;
+	}
+
+	return(nLods);
+}
+
+///////////////////////////////////////////////////
+//	AddGeneratedMesh()
+//
+//	Add a generated mesh to the shared buffers.  The
+//  parts are only set for the shapes that have caps,
+//  so the others can still be drawn as half shapes.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddGeneratedMesh(
+	GLMesh& mesh,
+	const MeshGenerator::MeshView& data)
+{
+	AddMeshData(mesh, data.vertices, data.nVertices, data.indices, data.nIndices);
+
+	if ((data.topIndexCount > 0) || (data.bottomIndexCount > 0))
+	{
+		SetMeshPartRange(mesh, MESH_PART_TOP, data.topFirstIndex, data.topIndexCount);
+		SetMeshPartRange(mesh, MESH_PART_BOTTOM, data.bottomFirstIndex, data.bottomIndexCount);
+		SetMeshPartRange(mesh, MESH_PART_SIDES, data.sidesFirstIndex, data.sidesIndexCount);
+	}
+
+	OptimizeMeshData(mesh, mesh.bHasParts == false);
+	BuildPartCombinations(mesh);
+}
+
+///////////////////////////////////////////////////
+//	BuildPartCombinations()
+//
+//	Find one contiguous index range for each
+//  combination of the parts of a mesh, so that any
+//  of them is drawn with a single command.  Parts
+//  that follow each other are drawn in place, the
+//  others are copied behind the part that ends the
+//  mesh indices, or behind the mesh indices.  The
+//  copies are counted apart from the mesh indices,
+//  so they only take room in the index buffer.
+///////////////////////////////////////////////////
+void ShapeMeshes::BuildPartCombinations(
+	GLMesh& mesh)
+{
+	// the table is only built once, while the mesh is the last one
+	if ((mesh.bHasParts == false) || (mesh.partCombinations[MESH_PART_ALL].nIndices > 0) ||
+		((size_t)mesh.dataIndex + mesh.nIndices + mesh.nCombinationIndices != m_indexData.size()) ||
+		(mesh.firstIndex + mesh.nIndices + mesh.nCombinationIndices != m_nSharedIndices))
+	{
+		return;
+	}
+
+	for (unsigned int combination = 1; combination <= MESH_PART_ALL; combination++)
+	{
+		// the selected parts in index order
+		MeshRange selected[3] = {};
+		int nSelected = 0;
+		const unsigned int partFlags[3] = { MESH_PART_TOP, MESH_PART_BOTTOM, MESH_PART_SIDES };
+		for (int i = 0; i < 3; i++)
+		{
+			if (((combination & partFlags[i]) != 0) && (mesh.parts[i].nIndices > 0))
+			{
+				int j = nSelected++;
+				while ((j > 0) && (selected[j - 1].firstIndex > mesh.parts[i].firstIndex))
+				{
+					selected[j] = selected[j - 1];
+					j--;
+				}
+				selected[j] = mesh.parts[i];
+			}
+		}
+
+		MeshRange& range = mesh.partCombinations[combination];
+		if (nSelected == 0)
+		{
+			range.firstIndex = 0;
+			range.nIndices = 0;
+			continue;
+		}
+
+		bool bContiguous = true;
+		for (int i = 1; i < nSelected; i++)
+		{
+			if ((selected[i - 1].firstIndex + selected[i - 1].nIndices) != selected[i].firstIndex)
+			{
+				bContiguous = false;
+			}
+		}
+
+		if (bContiguous == true)
+		{
+			range.firstIndex = selected[0].firstIndex;
+			range.nIndices = (selected[nSelected - 1].firstIndex + selected[nSelected - 1].nIndices) - range.firstIndex;
+			continue;
+		}
+
+		// a selected part at the end of the indices is extended by
+		// copies of the other ones, else all of them are copied
+		int tail = -1;
+		for (int i = 0; i < nSelected; i++)
+		{
+			if ((selected[i].firstIndex + selected[i].nIndices) == (mesh.nIndices + mesh.nCombinationIndices))
+			{
+				tail = i;
+			}
+		}
+
+		range.firstIndex = (tail >= 0) ? selected[tail].firstIndex : (mesh.nIndices + mesh.nCombinationIndices);
+		for (int i = 0; i < nSelected; i++)
+		{
+			if (i != tail)
+			{
+				size_t first = (size_t)mesh.dataIndex + selected[i].firstIndex;
+				for (GLuint k = 0; k < selected[i].nIndices; k++)
+				{
+					m_indexData.push_back(m_indexData[first + k]);
+				}
+				mesh.nCombinationIndices += selected[i].nIndices;
+				m_nSharedIndices += selected[i].nIndices;
+			}
+		}
+		range.nIndices = (mesh.nIndices + mesh.nCombinationIndices) - range.firstIndex;
+	}
+}
+
+///////////////////////////////////////////////////
+//	OptimizeMeshData()
+//
+//	Reorder the triangles of a mesh for the post-
+//  transform cache and against overdraw, then its
+//  vertices for the vertex fetch.  Only the copy of
+//  the data for the shared buffers is changed, so
+//  this has to run before the mesh is packed.
+///////////////////////////////////////////////////
+void ShapeMeshes::OptimizeMeshData(
+	GLMesh& mesh,
+	bool bHalfShape)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	// the meshes from the cache were optimized before they were written
+	if ((mesh.bLoaded == false) || (mesh.bOptimized == true) || (mesh.nIndices < 3) ||
+		(NULL != mesh.pMappedIndices))
+	{
+		return;
+	}
+	mesh.bOptimized = true;
+
+	GLuint* pIndices = m_indexData.data() + mesh.dataIndex;
+	GLfloat* pVertices = m_vertexData.data() + ((size_t)mesh.dataVertex * floatsPerVertex);
+
+	// the index ranges that are drawn on their own
+	MeshRange ranges[3] = {};
+	int nRanges = 0;
+	if (mesh.bHasParts == true)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (mesh.parts[i].nIndices > 0)
+			{
+				ranges[nRanges++] = mesh.parts[i];
+			}
+		}
+	}
+	else if (bHalfShape == true)
+	{
+		// the same split as the half shapes are drawn with
+		GLuint nHalfIndices = (mesh.nIndices / 2) - ((mesh.nIndices / 2) % 3);
+		ranges[nRanges].firstIndex = 0;
+		ranges[nRanges++].nIndices = nHalfIndices;
+		ranges[nRanges].firstIndex = nHalfIndices;
+		ranges[nRanges++].nIndices = mesh.nIndices - nHalfIndices;
+	}
+	else
+	{
+		ranges[nRanges].firstIndex = 0;
+		ranges[nRanges++].nIndices = mesh.nIndices;
+	}
+
+	MeshOptimizer::VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(
+		pIndices, mesh.nIndices, mesh.nVertices);
+
+	std::vector<unsigned int> clusters;
+	std::vector<GLuint> authoredIndices;
+	for (int i = 0; i < nRanges; i++)
+	{
+		GLuint* pRangeIndices = pIndices + ranges[i].firstIndex;
+		authoredIndices.assign(pRangeIndices, pRangeIndices + ranges[i].nIndices);
+		float authoredACMR = MeshOptimizer::AnalyzeVertexCache(
+			pRangeIndices, ranges[i].nIndices, mesh.nVertices).acmr;
+
+		MeshOptimizer::OptimizeVertexCache(pRangeIndices, ranges[i].nIndices, mesh.nVertices, clusters);
+		MeshOptimizer::OptimizeOverdraw(pRangeIndices, ranges[i].nIndices, pVertices, mesh.nVertices,
+			floatsPerVertex, clusters);
+
+		// strips and fans are already in a good order, so keep
+		// the authored order when the reordering does not help
+		if (MeshOptimizer::AnalyzeVertexCache(pRangeIndices, ranges[i].nIndices, mesh.nVertices).acmr > authoredACMR)
+		{
+			std::copy(authoredIndices.begin(), authoredIndices.end(), pRangeIndices);
+		}
+	}
+	MeshOptimizer::OptimizeVertexFetch(pVertices, mesh.nVertices, floatsPerVertex, pIndices, mesh.nIndices);
+
+	MeshOptimizer::VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(
+		pIndices, mesh.nIndices, mesh.nVertices);
+
+	m_optimizationStats.nMeshes++;
+	m_optimizationStats.nTriangles += before.nTriangles;
+	m_optimizationStats.nVertices += before.nVertices;
+	m_optimizationStats.nTransformsBefore += before.nTransforms;
+	m_optimizationStats.nTransformsAfter += after.nTransforms;
+}
+
+///////////////////////////////////////////////////
+//	GenerateMeshLods()
+//
+//	Generate the coarser levels of detail of a
+//  curved shape from the tessellation tables.  The
+//  thickness is only used for the torus.
+///////////////////////////////////////////////////
+void ShapeMeshes::GenerateMeshLods(
+	MeshID mesh,
+	float thickness)
+{
+	MeshGenerator::MeshData data;
+
+	for (int level = 1; level < MESH_LOD_COUNT; level++)
+	{
+		GLMesh& lodMesh = m_LodMeshes[mesh][level - 1];
+
+		switch (mesh)
+		{
+		case MESH_SPHERE:
+			MeshGenerator::GenerateSphere(g_SphereLodRings[level - 1], g_SphereLodSectors[level - 1], data);
+			break;
+		case MESH_CYLINDER:
+			MeshGenerator::GenerateCylinder(g_CylinderLodSegments[level - 1], 1.0f, data);
+			break;
+		case MESH_TAPERED_CYLINDER:
+			MeshGenerator::GenerateCylinder(g_CylinderLodSegments[level - 1], g_TaperedCylinderTopRadius, data);
+			break;
+		case MESH_CONE:
+			MeshGenerator::GenerateCylinder(g_CylinderLodSegments[level - 1], g_ConeTopRadius, data);
+			break;
+		case MESH_TORUS:
+			MeshGenerator::GenerateTorus(g_TorusLodMainSegments[level - 1], g_TorusLodTubeSegments[level - 1], thickness, data);
+			break;
+		default:
+			return;
+		}
+
+		AddGeneratedMesh(lodMesh, MeshGenerator::GetMeshView(data));
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetMeshRange()
+//
+//	Get the range of the shared index buffer that
+//  holds the requested parts of the identified mesh.
+//  The half shapes are the first half of the indices
+//  of the whole shapes.  Returns false when nothing
+//  is left to draw.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshRange(
+	MeshID mesh,
+	unsigned int parts,
+	int lod,
+	MeshRange& range,
+	GLint& baseVertex) const
+{
+	bool bHalf = false;
+	const GLMesh* pMesh = GetLoadedMesh(mesh, lod, bHalf);
+
+	if (NULL == pMesh)
+	{
+		return(false);
+	}
+
+	baseVertex = (pMesh->format == VERTEX_FORMAT_PACKED) ? pMesh->packedBaseVertex : pMesh->baseVertex;
+
+	// shapes without caps are always drawn whole
+	if (pMesh->bHasParts == false)
+	{
+		GLuint nIndices = pMesh->nIndices;
+		if (bHalf == true)
+		{
+			// keep only whole triangles
+			nIndices = (nIndices / 2) - ((nIndices / 2) % 3);
+		}
+
+		range.firstIndex = pMesh->firstIndex;
+		range.nIndices = nIndices;
+		return(true);
+	}
+
+	const MeshRange& combination = pMesh->partCombinations[parts & MESH_PART_ALL];
+	if (combination.nIndices == 0)
+	{
+		return(false);
+	}
+
+	range.firstIndex = pMesh->firstIndex + combination.firstIndex;
+	range.nIndices = combination.nIndices;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	BindMeshBuffers()
+//
+//	Bind the shared vertex array, uploading the mesh
+//  data first if a mesh was loaded since the last
+//  upload.
+///////////////////////////////////////////////////
+void ShapeMeshes::BindMeshBuffers(
+	VertexFormat format)
+{
+	if ((m_bBuffersDirty == true) || (0 == m_vao))
+	{
+		UploadMeshBuffers();
+	}
+
+	glBindVertexArray((format == VERTEX_FORMAT_PACKED) ? m_packedVAO : m_vao);
+}
+
+glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
+{
+	glm::vec3 Normal(0, 0, 0);
+	float v1x = p1.x - p0.x;
+	float v1y = p1.y - p0.y;
+	float v1z = p1.z - p0.z;
+	float v2x = p2.x - p1.x;
+	float v2y = p2.y - p1.y;
+	float v2z = p2.z - p1.z;
+	Normal.x = v1y * v2z - v1z * v2y;
+	Normal.y = v1z * v2x - v1x * v2z;
+	Normal.y = v1x * v2y - v1y * v2x;
+	float len = (float)sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+	if (len == 0)
+	{
+		//throw Exception();
+	}
+	else
+	{
+		Normal.x /= len;
+		Normal.y /= len;
+		Normal.z /= len;
+	}
+	return Normal;
+}
+
+
+
+void ShapeMeshes::SetShaderMemoryLayout()
+{
+	// The following code defines the layout of the mesh data in memory - each mesh needs
+	// to have the same memory layout so that the data is retrieved properly by the shaders
+
+	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
+	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
+
+	// Create Vertex Attribute Pointers
 	glVertexAttribPointer(0, g_FloatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
 	glEnableVertexAttribArray(0);
 
@@ -2444,4 +1964,368 @@ void ShapeMeshes::SetShaderMemoryLayout()
 
 	glVertexAttribPointer(2, g_FloatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal)));
 	glEnableVertexAttribArray(2);
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////
+//	SetPackedMemoryLayout()
+//
+//	Set the attribute layout of the packed vertices.
+//  The octahedral normal has its own location, as
+//  the vertex shader decodes it into the normal.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetPackedMemoryLayout()
+{
+	GLsizei stride = sizeof(PackedVertex);
+
+	glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(g_PackedNormalLocation, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+	glEnableVertexAttribArray(g_PackedNormalLocation);
+
+	glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(PackedVertex, uv));
+	glEnableVertexAttribArray(2);
+}
+
+///////////////////////////////////////////////////
+//	PackMeshVertices()
+//
+//	Encode the vertices of a mesh into the packed
+//  layout and add them to the packed vertex data.
+//  The normal is projected onto the octahedron and
+//  its lower half is folded over the upper half,
+//  which keeps the error even over the sphere.
+///////////////////////////////////////////////////
+bool ShapeMeshes::PackMeshVertices(
+	GLMesh& mesh)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	if (mesh.packedBaseVertex >= 0)
+	{
+		return(true);
+	}
+
+	const GLfloat* pVertices = GetMeshVertexData(mesh);
+	for (GLuint i = 0; i < mesh.nVertices; i++)
+	{
+		const GLfloat* pVertex = pVertices + (i * floatsPerVertex);
+		for (int c = 0; c < 3; c++)
+		{
+			if (fabsf(pVertex[c]) > g_MaxHalfFloat)
+			{
+				return(false);
+			}
+		}
+		// the texture coordinates cannot repeat in unorm16
+		if ((pVertex[6] < 0.0f) || (pVertex[6] > 1.0f) || (pVertex[7] < 0.0f) || (pVertex[7] > 1.0f))
+		{
+			return(false);
+		}
+	}
+
+	mesh.packedBaseVertex = (GLint)m_packedVertexData.size();
+	m_packedVertexData.reserve(m_packedVertexData.size() + mesh.nVertices);
+
+	for (GLuint i = 0; i < mesh.nVertices; i++)
+	{
+		const GLfloat* pVertex = pVertices + (i * floatsPerVertex);
+		PackedVertex packed;
+
+		packed.position[0] = glm::packHalf1x16(pVertex[0]);
+		packed.position[1] = glm::packHalf1x16(pVertex[1]);
+		packed.position[2] = glm::packHalf1x16(pVertex[2]);
+		packed.position[3] = 0;
+
+		glm::vec3 normal(pVertex[3], pVertex[4], pVertex[5]);
+		float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+		glm::vec2 octahedral(0.0f, 0.0f);
+		if (length > 0.0f)
+		{
+			normal /= length;
+			octahedral = glm::vec2(normal.x, normal.y);
+			if (normal.z < 0.0f)
+			{
+				octahedral.x = (1.0f - fabsf(normal.y)) * ((normal.x >= 0.0f) ? 1.0f : -1.0f);
+				octahedral.y = (1.0f - fabsf(normal.x)) * ((normal.y >= 0.0f) ? 1.0f : -1.0f);
+			}
+		}
+		packed.normal[0] = (GLshort)glm::packSnorm1x16(octahedral.x);
+		packed.normal[1] = (GLshort)glm::packSnorm1x16(octahedral.y);
+
+		packed.uv[0] = glm::packUnorm1x16(pVertex[6]);
+		packed.uv[1] = glm::packUnorm1x16(pVertex[7]);
+
+		m_packedVertexData.push_back(packed);
+	}
+
+	m_bBuffersDirty = true;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	SetMeshVertexFormat()
+//
+//	Switch the vertex layout of a shape mesh and of
+//  its levels of detail.  The float vertices are
+//  kept, so a mesh can be switched back at any time.
+///////////////////////////////////////////////////
+bool ShapeMeshes::SetMeshVertexFormat(
+	MeshID mesh,
+	VertexFormat format)
+{
+	bool bHalf = false;
+	const GLMesh* pBaseMesh = GetLoadedMesh(mesh, 0, bHalf);
+
+	if (NULL == pBaseMesh)
+	{
+		return(false);
+	}
+
+	// the half shapes are drawn from the whole shapes
+	MeshID lodMesh = mesh;
+	if (mesh == MESH_HALF_SPHERE) lodMesh = MESH_SPHERE;
+	if (mesh == MESH_HALF_TORUS) lodMesh = MESH_TORUS;
+
+	// the loaded meshes are members, so they can be changed here
+	GLMesh* pMeshes[MESH_LOD_COUNT] = { const_cast<GLMesh*>(pBaseMesh) };
+	int nMeshes = 1;
+	while ((nMeshes < MESH_LOD_COUNT) && (m_LodMeshes[lodMesh][nMeshes - 1].bLoaded == true))
+	{
+		pMeshes[nMeshes] = &m_LodMeshes[lodMesh][nMeshes - 1];
+		nMeshes++;
+	}
+
+	if (format == VERTEX_FORMAT_PACKED)
+	{
+		for (int i = 0; i < nMeshes; i++)
+		{
+			if (PackMeshVertices(*pMeshes[i]) == false)
+			{
+				return(false);
+			}
+		}
+	}
+
+	for (int i = 0; i < nMeshes; i++)
+	{
+		pMeshes[i]->format = format;
+	}
+
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshVertexFormat()
+//
+//	Get the vertex layout of a shape mesh.
+///////////////////////////////////////////////////
+ShapeMeshes::VertexFormat ShapeMeshes::GetMeshVertexFormat(
+	MeshID mesh) const
+{
+	bool bHalf = false;
+	const GLMesh* pMesh = GetLoadedMesh(mesh, 0, bHalf);
+
+	if (NULL == pMesh)
+	{
+		return(VERTEX_FORMAT_FLOAT);
+	}
+
+	return(pMesh->format);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshSize()
+//
+//	Get the number of vertices and indices of a
+//  shape mesh at full detail.  Returns false if the
+//  shape has not been loaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshSize(
+	MeshID mesh,
+	GLuint& nVertices,
+	GLuint& nIndices) const
+{
+	bool bHalf = false;
+	const GLMesh* pMesh = GetLoadedMesh(mesh, 0, bHalf);
+
+	if (NULL == pMesh)
+	{
+		return(false);
+	}
+
+	nVertices = pMesh->nVertices;
+	nIndices = pMesh->nIndices;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetVertexStride()
+//
+//	Get the number of bytes of one vertex in the
+//  passed in vertex layout.
+///////////////////////////////////////////////////
+GLsizei ShapeMeshes::GetVertexStride(
+	VertexFormat format)
+{
+	if (VERTEX_FORMAT_PACKED == format)
+	{
+		return(sizeof(PackedVertex));
+	}
+
+	return(sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
+}
+
+///////////////////////////////////////////////////
+//	SetInstanceMemoryLayout()
+//
+//	Add the per-instance attributes, read from the
+//  shared instance buffer, to the shared vertex array.
+//  The shared vertex array must already be bound.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetInstanceMemoryLayout()
+{
+	// the attributes read from a separate binding point, so the
+	// buffer and offset they read from can change with a single
+	// call, see BindInstanceBuffer()
+	const GLuint modelOffset = offsetof(InstanceData, model);
+	const GLuint paramsOffset = offsetof(InstanceData, uvScale);
+	const GLuint mvpOffset = offsetof(InstanceData, modelViewProjection);
+	const GLuint normalOffset = offsetof(InstanceData, normalMatrix);
+
+	// a mat4 attribute takes up four consecutive vec4 locations
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glVertexAttribFormat(g_InstanceModelLocation + i, 4, GL_FLOAT, GL_FALSE, modelOffset + (sizeof(glm::vec4) * i));
+		glVertexAttribBinding(g_InstanceModelLocation + i, g_InstanceBinding);
+		glEnableVertexAttribArray(g_InstanceModelLocation + i);
+
+		glVertexAttribFormat(g_InstanceMVPLocation + i, 4, GL_FLOAT, GL_FALSE, mvpOffset + (sizeof(glm::vec4) * i));
+		glVertexAttribBinding(g_InstanceMVPLocation + i, g_InstanceBinding);
+		glEnableVertexAttribArray(g_InstanceMVPLocation + i);
+	}
+
+	// a mat3 attribute takes up three locations, each column is
+	// padded to a vec4 in the instance data
+	for (GLuint i = 0; i < 3; i++)
+	{
+		glVertexAttribFormat(g_InstanceNormalLocation + i, 3, GL_FLOAT, GL_FALSE, normalOffset + (sizeof(glm::vec4) * i));
+		glVertexAttribBinding(g_InstanceNormalLocation + i, g_InstanceBinding);
+		glEnableVertexAttribArray(g_InstanceNormalLocation + i);
+	}
+
+	glVertexAttribFormat(g_InstanceParamsLocation, 4, GL_FLOAT, GL_FALSE, paramsOffset);
+	glVertexAttribBinding(g_InstanceParamsLocation, g_InstanceBinding);
+	glEnableVertexAttribArray(g_InstanceParamsLocation);
+
+	glVertexBindingDivisor(g_InstanceBinding, 1);
+
+	// the instance buffer is bound to the new vertex array next time
+	m_boundInstanceBuffer = 0;
+}
+
+///////////////////////////////////////////////////
+//	UploadInstanceData()
+//
+//	Upload the passed in instance data into the shared
+//  instance buffer.  With a view and projection, the
+//  derived matrices of each instance are filled in
+//  while it is copied into the mapped buffer, so the
+//  instances of the caller are left as they are.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadInstanceData(
+	const InstanceData* pInstances,
+	GLsizei nInstances,
+	const glm::mat4* pViewProjection)
+{
+	if ((NULL == pInstances) || (nInstances <= 0))
+	{
+		return;
+	}
+
+	if ((m_bBuffersDirty == true) || (0 == m_vao))
+	{
+		UploadMeshBuffers();
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+
+	// grow the instance buffer when needed, otherwise orphan the
+	// old storage so the driver does not stall on a previous draw
+	if (nInstances > m_instanceCapacity)
+	{
+		m_instanceCapacity = nInstances;
+	}
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * m_instanceCapacity, NULL, GL_STREAM_DRAW);
+	if (NULL == pViewProjection)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceData) * nInstances, pInstances);
+	}
+	else
+	{
+		// the mapping is only written, each instance is completed
+		// on the stack and then copied in as a whole
+		InstanceData* pCopies = (InstanceData*)glMapBufferRange(GL_ARRAY_BUFFER, 0,
+			sizeof(InstanceData) * nInstances, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (NULL != pCopies)
+		{
+			for (GLsizei i = 0; i < nInstances; i++)
+			{
+				InstanceData instance = pInstances[i];
+				SetInstanceTransforms(instance, *pViewProjection);
+				pCopies[i] = instance;
+			}
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+	}
+
+	BindInstanceBuffer(m_instanceVBO, 0);
+}
+
+///////////////////////////////////////////////////
+//	BindInstanceBuffer()
+//
+//	Point the instance attributes of both shared vertex
+//  arrays at the passed in buffer and offset.  Nothing
+//  is changed when they already read from there.  The
+//  vertex array that is bound afterwards is undefined.
+///////////////////////////////////////////////////
+void ShapeMeshes::BindInstanceBuffer(
+	GLuint buffer,
+	GLintptr offset)
+{
+	if ((buffer == m_boundInstanceBuffer) && (offset == m_boundInstanceOffset))
+	{
+		return;
+	}
+
+	glBindVertexArray(m_vao);
+	glBindVertexBuffer(g_InstanceBinding, buffer, offset, sizeof(InstanceData));
+	glBindVertexArray(m_packedVAO);
+	glBindVertexBuffer(g_InstanceBinding, buffer, offset, sizeof(InstanceData));
+
+	m_boundInstanceBuffer = buffer;
+	m_boundInstanceOffset = offset;
+}
+
+///////////////////////////////////////////////////
+//	SetInstanceTransforms()
+//
+//	Fill in the matrices of an instance that are
+//  derived from its model matrix, once on the CPU
+//  instead of for every vertex.  The normal matrix
+//  keeps the normals perpendicular to the surface
+//  under non-uniform scaling.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetInstanceTransforms(
+	InstanceData& instance,
+	const glm::mat4& viewProjection)
+{
+	const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(instance.model)));
+
+	instance.modelViewProjection = viewProjection * instance.model;
+	for (int i = 0; i < 3; i++)
+	{
+		instance.normalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
+	}
+}
@@ -14,6 +14,14 @@
 
 #include <glm/glm.hpp>
 
+#include "MeshGenerator.h"
+#include "MeshOptimizer.h"
+#include "MeshCache.h"
+#include "RingBuffer.h"
+
+#include <string>
+#include <vector>
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -25,16 +33,138 @@ class ShapeMeshes
 public:
 	// constructor
 	ShapeMeshes();
+	// destructor, closes the mapped mesh cache files
+	~ShapeMeshes();
+
+	// identifies each of the available 3D shapes
+	enum MeshID
+	{
+		MESH_BOX = 0,
+		MESH_CONE,
+		MESH_CYLINDER,
+		MESH_PLANE,
+		MESH_PRISM,
+		MESH_PYRAMID3,
+		MESH_PYRAMID4,
+		MESH_SPHERE,
+		MESH_HALF_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_HALF_TORUS,
+		MESH_COUNT
+	};
+
+	// flags for the parts of the shapes that have caps
+	enum MeshPart
+	{
+		MESH_PART_TOP = 1,
+		MESH_PART_BOTTOM = 2,
+		MESH_PART_SIDES = 4,
+		MESH_PART_ALL = MESH_PART_TOP | MESH_PART_BOTTOM | MESH_PART_SIDES
+	};
+
+	// layouts of the vertices in the shared vertex buffers - the
+	// packed layout stores half float positions, an octahedral
+	// normal in two snorm16 and unorm16 texture coordinates in 16
+	// bytes, and needs bPackedVertices set in the vertex shader
+	enum VertexFormat
+	{
+		VERTEX_FORMAT_FLOAT = 0,
+		VERTEX_FORMAT_PACKED,
+		VERTEX_FORMAT_COUNT
+	};
+
+	// number of levels of detail of the curved shapes, level 0 is
+	// the full detail mesh and each further level is coarser
+	static const int MESH_LOD_COUNT = 4;
+
+	// per-instance data for instanced drawing - the layout
+	// must match the instance attributes in the vertex shader
+	struct InstanceData
+	{
+		glm::mat4 model;		// model transformation matrix
+		glm::vec2 uvScale;		// texture UV scale
+		float materialIndex;	// index of the object material
+		float textureLayer;		// layer of the texture array, -1 for none
+		glm::mat4 modelViewProjection;	// model, view and projection in one, see SetInstanceTransforms()
+		glm::vec4 normalMatrix[3];		// columns of the inverse transpose of the model rotation and scale
+	};
+
+	// one indirect draw, laid out as glMultiDrawElementsIndirect reads it
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;			// number of indices
+		GLuint instanceCount;	// number of instances
+		GLuint firstIndex;		// first index in the shared index buffer
+		GLint baseVertex;		// first vertex in the shared vertex buffer
+		GLuint baseInstance;	// first entry in the instance buffer
+	};
+
+	// bounding volumes of a mesh in its local space
+	struct MeshBounds
+	{
+		glm::vec3 minimum;		// corners of the axis aligned bounding box
+		glm::vec3 maximum;
+		glm::vec3 center;		// center and radius of the bounding sphere
+		float radius;
+	};
+
+	// post-transform cache counters of all of the loaded meshes,
+	// before and after their triangles and vertices were reordered
+	struct OptimizationStats
+	{
+		GLuint nMeshes = 0;				// meshes that were optimized
+		GLuint nTriangles = 0;			// triangles of those meshes
+		GLuint nVertices = 0;			// distinct vertices used by the triangles
+		GLuint nTransformsBefore = 0;	// simulated vertex transforms in authoring order
+		GLuint nTransformsAfter = 0;	// simulated vertex transforms after the reordering
+	};
+
+	// counters of the mesh cache files since the cache was enabled
+	struct MeshCacheStats
+	{
+		GLuint nHits = 0;		// meshes mapped from a cache file
+		GLuint nMisses = 0;		// meshes without a usable cache file
+		GLuint nWritten = 0;	// cache files written for generated meshes
+	};
 
 private:
 
-	// stores the GL data relative to a given mesh
+	// range of the indices of a mesh part
+	struct MeshRange
+	{
+		GLuint firstIndex;	// first index, relative to the start of the mesh
+		GLuint nIndices;	// number of indices
+	};
+
+	// vertex of the packed vertex format, 16 bytes
+	struct PackedVertex
+	{
+		GLushort position[4];	// half floats, the last one is padding
+		GLshort normal[2];		// octahedral encoded unit normal
+		GLushort uv[2];			// texture coordinates from 0 to 1
+	};
+
+	// stores the location of a given mesh in the shared buffers
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
-		GLuint vbos[2];     // Handles for the vertex buffer objects
-		GLuint nVertices;	// Number of vertices for the mesh
-		GLuint nIndices;    // Number of indices for the mesh
+		GLuint nVertices = 0;	// Number of vertices for the mesh
+		GLuint nIndices = 0;    // Number of indices for the mesh
+		GLuint nCombinationIndices = 0;	// part combination copies behind the mesh indices
+		GLint baseVertex = 0;	// first vertex of the mesh in the shared vertex buffer
+		GLint packedBaseVertex = -1;	// first vertex in the packed vertex buffer, once packed
+		VertexFormat format = VERTEX_FORMAT_FLOAT;	// layout the mesh is drawn from
+		GLuint firstIndex = 0;	// first index of the mesh in the shared index buffer
+		GLuint dataVertex = 0;	// first vertex of the mesh in the vertex data copy
+		GLuint dataIndex = 0;	// first index of the mesh in the index data copy
+		const GLfloat* pMappedVertices = NULL;	// vertices in a mapped cache file, instead of the copy
+		const GLuint* pMappedIndices = NULL;	// indices in a mapped cache file, instead of the copy
+		MeshRange parts[3] = {};	// index ranges of the top, bottom and sides
+		MeshRange partCombinations[MESH_PART_ALL + 1] = {};	// one index range for each combination of the part flags
+		bool bHasParts = false;	// the parts can be drawn separately
+		bool bLoaded = false;	// the mesh data was added to the shared buffers
+		bool bOptimized = false;	// the mesh data was reordered for the GPU
+		MeshBounds bounds = {};	// bounding volumes of all of the vertices
 	};
 
 	// the available 3D shapes
@@ -48,22 +178,77 @@ private:
 	GLMesh m_SphereMesh;
 	GLMesh m_TaperedCylinderMesh;
 	GLMesh m_TorusMesh;
+	// generated lower levels of detail of the curved shapes,
+	// indexed by the shape and the level minus one
+	GLMesh m_LodMeshes[MESH_COUNT][MESH_LOD_COUNT - 1];
 
 	bool m_bMemoryLayoutDone;
 
+	// shared vertex array and buffers holding all of the loaded meshes
+	GLuint m_vao;
+	GLuint m_vertexBuffer;
+	GLuint m_indexBuffer;
+	// copy of the generated mesh data that is uploaded into the shared
+	// buffers, the meshes from the cache are uploaded from their files
+	std::vector<GLfloat> m_vertexData;
+	std::vector<GLuint> m_indexData;
+	// number of vertices and indices in the shared buffers
+	GLuint m_nSharedVertices;
+	GLuint m_nSharedIndices;
+	// directory of the mesh cache files, empty when it is disabled
+	std::string m_cacheDirectory;
+	// mapped cache files, which hold the data of the cached meshes
+	std::vector<MeshCache::MappedFile*> m_cacheFiles;
+	// counters of the mesh cache
+	MeshCacheStats m_cacheStats;
+	// a mesh was loaded since the shared buffers were uploaded
+	bool m_bBuffersDirty;
+	// vertex array and buffer of the meshes in the packed format,
+	// which share the index and instance buffers
+	GLuint m_packedVAO;
+	GLuint m_packedVertexBuffer;
+	std::vector<PackedVertex> m_packedVertexData;
+	// cache counters of the meshes optimized so far
+	OptimizationStats m_optimizationStats;
+
+	// shared buffer holding the per-instance data
+	GLuint m_instanceVBO;
+	// number of instances the instance buffer can hold
+	GLsizei m_instanceCapacity;
+	// shared buffer holding the indirect draw commands
+	GLuint m_indirectBuffer;
+	// number of commands the indirect buffer can hold
+	GLsizei m_indirectCapacity;
+	// persistently mapped rings of the instance data and the indirect
+	// draw commands of the frames in flight, when supported
+	RingBuffer m_instanceRing;
+	RingBuffer m_indirectRing;
+	// offset of the commands of this frame in the indirect buffer
+	GLintptr m_indirectOffset;
+	// instance data of this frame, when there is no instance ring
+	std::vector<InstanceData> m_stagedInstances;
+	// instance buffer and offset bound to the shared vertex arrays
+	GLuint m_boundInstanceBuffer;
+	GLintptr m_boundInstanceOffset;
+
 public:
 	// methods for loading the shape mesh data 
 	// into memory
 	void LoadBoxMesh();
-	void LoadConeMesh();
-	void LoadCylinderMesh();
+	void LoadConeMesh(int segments = MeshGenerator::DEFAULT_CYLINDER_SEGMENTS);
+	void LoadCylinderMesh(int segments = MeshGenerator::DEFAULT_CYLINDER_SEGMENTS);
 	void LoadPlaneMesh();
 	void LoadPrismMesh();
 	void LoadPyramid3Mesh();
 	void LoadPyramid4Mesh();
-	void LoadSphereMesh();
-	void LoadTaperedCylinderMesh();
-	void LoadTorusMesh(float thickness = 0.2);
+	void LoadSphereMesh(
+		int rings = MeshGenerator::DEFAULT_SPHERE_RINGS,
+		int sectors = MeshGenerator::DEFAULT_SPHERE_SECTORS);
+	void LoadTaperedCylinderMesh(int segments = MeshGenerator::DEFAULT_CYLINDER_SEGMENTS);
+	void LoadTorusMesh(
+		float thickness = MeshGenerator::DEFAULT_TORUS_THICKNESS,
+		int mainSegments = MeshGenerator::DEFAULT_TORUS_MAIN_SEGMENTS,
+		int tubeSegments = MeshGenerator::DEFAULT_TORUS_TUBE_SEGMENTS);
 
 	// methods for drawing the shape mesh in the
 	// display window
@@ -87,6 +272,112 @@ public:
 	void DrawTorusMesh();
 	void DrawHalfTorusMesh();
 
+	// draw the identified shape mesh, the parts flags
+	// select the caps and sides of the shapes that have them
+	void DrawMesh(
+		MeshID mesh,
+		unsigned int parts = MESH_PART_ALL);
+	// fill in the model view projection and normal matrices of an
+	// instance from its model matrix, which instanced draws need
+	static void SetInstanceTransforms(
+		InstanceData& instance,
+		const glm::mat4& viewProjection);
+	// draw many copies of the identified shape mesh, only the model
+	// matrix and the parameters of the instances are read, their
+	// derived matrices are filled in from the passed in view and
+	// projection - returns false when the shape has not been loaded
+	bool DrawMeshInstanced(
+		MeshID mesh,
+		const InstanceData* pInstances,
+		GLsizei nInstances,
+		const glm::mat4& viewProjection,
+		unsigned int parts = MESH_PART_ALL);
+
+	// get the local bounding volumes of the identified shape mesh,
+	// returns false when the shape has not been loaded
+	bool GetMeshBounds(
+		MeshID mesh,
+		MeshBounds& bounds) const;
+
+	// switch the vertex layout that a shape mesh and its levels of
+	// detail are drawn from, returns false when the mesh is not
+	// loaded or its data does not fit into the packed layout
+	bool SetMeshVertexFormat(
+		MeshID mesh,
+		VertexFormat format);
+	// get the vertex layout that a shape mesh is drawn from
+	VertexFormat GetMeshVertexFormat(
+		MeshID mesh) const;
+	// get the number of vertices and indices of the identified shape
+	// mesh at full detail, returns false when it is not loaded
+	bool GetMeshSize(
+		MeshID mesh,
+		GLuint& nVertices,
+		GLuint& nIndices) const;
+	// get the number of bytes of one vertex in a vertex layout
+	static GLsizei GetVertexStride(
+		VertexFormat format);
+	// get the post-transform cache counters of the loaded meshes
+	const OptimizationStats& GetOptimizationStats() const { return m_optimizationStats; }
+
+	// keep the generated curved shapes in cache files in the passed
+	// in directory, which is created if needed - the meshes loaded
+	// afterwards are mapped from their files when they exist
+	void SetMeshCacheDirectory(
+		const std::string& path);
+	// get the counters of the mesh cache
+	const MeshCacheStats& GetMeshCacheStats() const { return m_cacheStats; }
+
+	// upload the loaded meshes into the shared buffers, this is
+	// also done by the first draw after a mesh has been loaded
+	void UploadMeshBuffers();
+	// get the number of levels of detail that are loaded for
+	// the identified shape mesh, zero when it is not loaded
+	int GetMeshLodCount(
+		MeshID mesh) const;
+
+	// add the indirect draw command for the parts of the identified
+	// shape mesh at a level of detail - any combination of parts is a
+	// single command - returns the number of commands that were added
+	int AddDrawCommands(
+		MeshID mesh,
+		unsigned int parts,
+		int lod,
+		GLuint instanceCount,
+		GLuint baseInstance,
+		std::vector<DrawElementsIndirectCommand>& commands) const;
+	// get the memory to write the instance data of a frame into, the
+	// baseInstance of the commands is an index into it.  The memory is
+	// mapped for writing only, so it should not be read from.
+	InstanceData* MapInstanceData(
+		GLsizei nInstances);
+	// upload the indirect draw commands of a frame, after its
+	// instance data was written
+	void UploadIndirectDraws(
+		const DrawElementsIndirectCommand* pCommands,
+		GLsizei nCommands);
+	// draw a range of the uploaded indirect commands with one
+	// call, the commands must all be for meshes of the format
+	void DrawIndirect(
+		VertexFormat format,
+		GLsizei firstCommand,
+		GLsizei nCommands);
+
+	// methods for drawing many copies of a shape mesh
+	// with a single draw call
+	void DrawBoxMeshInstanced(
+		const InstanceData* pInstances,
+		GLsizei nInstances,
+		const glm::mat4& viewProjection);
+	void DrawPlaneMeshInstanced(
+		const InstanceData* pInstances,
+		GLsizei nInstances,
+		const glm::mat4& viewProjection);
+	void DrawSphereMeshInstanced(
+		const InstanceData* pInstances,
+		GLsizei nInstances,
+		const glm::mat4& viewProjection);
+
 
 private:
 
@@ -98,4 +389,118 @@ private:
 	// called to set the memory layout 
 	// template for shader data
 	void SetShaderMemoryLayout();
+
+	// called to set the memory layout of the packed vertices
+	void SetPackedMemoryLayout();
+
+	// called to add the packed vertices of a mesh to the packed
+	// buffer, returns false when the data does not fit the layout
+	bool PackMeshVertices(
+		GLMesh& mesh);
+
+	// called to set the per-instance memory
+	// layout of the instance buffer
+	void SetInstanceMemoryLayout();
+
+	// called to add the data of a mesh to the shared buffers,
+	// the indices are relative to the first vertex of the mesh
+	void AddMeshData(
+		GLMesh& mesh,
+		const GLfloat* pVertices,
+		GLuint nVertices,
+		const GLuint* pIndices,
+		GLuint nIndices);
+
+	// called to set the index range of a part of a mesh
+	void SetMeshPartRange(
+		GLMesh& mesh,
+		MeshPart part,
+		GLuint firstIndex,
+		GLuint nIndices);
+
+	// called to reorder the triangles and vertices of a mesh in the
+	// shared buffer data for the GPU, the index ranges that are drawn
+	// on their own - the parts, or the halves of a half shape - are
+	// reordered separately so they stay intact
+	void OptimizeMeshData(
+		GLMesh& mesh,
+		bool bHalfShape);
+
+	// called to give every combination of the parts of a mesh one
+	// contiguous index range, adding copies of the parts to the end
+	// of its indices where they are not next to each other - the
+	// mesh has to be the last one that was added
+	void BuildPartCombinations(
+		GLMesh& mesh);
+
+	// called to add the data of a generated mesh to the shared
+	// buffers, together with the index ranges of its parts
+	void AddGeneratedMesh(
+		GLMesh& mesh,
+		const MeshGenerator::MeshView& data);
+
+	// called to generate the lower levels of detail of a shape
+	void GenerateMeshLods(
+		MeshID mesh,
+		float thickness = 0.0f);
+
+	// called to map a shape with its levels of detail from its cache
+	// file, returns true when the shape is loaded afterwards
+	bool LoadCachedMesh(
+		MeshID mesh,
+		const std::string& name,
+		uint64_t generatorHash);
+	// called to write a generated shape with its levels of detail
+	// into its cache file
+	void SaveCachedMesh(
+		MeshID mesh,
+		const std::string& name,
+		uint64_t generatorHash);
+
+	// called to get the storage of a whole shape at a level of
+	// detail, NULL for the half shapes
+	GLMesh* GetMeshLevel(
+		MeshID mesh,
+		int lod);
+	// called to get the vertices and indices of a loaded mesh,
+	// either from the data copy or from its mapped cache file
+	const GLfloat* GetMeshVertexData(
+		const GLMesh& mesh) const;
+	const GLuint* GetMeshIndexData(
+		const GLMesh& mesh) const;
+
+	// called to get the loaded mesh that the identified shape is
+	// drawn from at a level of detail, and whether only half of
+	// it is drawn - missing levels fall back to the full detail
+	const GLMesh* GetLoadedMesh(
+		MeshID mesh,
+		int lod,
+		bool& bHalf) const;
+
+	// called to get the range in the shared index buffer for the
+	// parts of a mesh, returns false when there is nothing to draw
+	bool GetMeshRange(
+		MeshID mesh,
+		unsigned int parts,
+		int lod,
+		MeshRange& range,
+		GLint& baseVertex) const;
+
+	// called to upload the shared buffers if needed and bind
+	// the shared vertex array of the passed in vertex format
+	void BindMeshBuffers(
+		VertexFormat format = VERTEX_FORMAT_FLOAT);
+
+	// called to upload the instance data into the instance buffer,
+	// filling in the derived matrices of the uploaded copy when a
+	// view and projection is passed in
+	void UploadInstanceData(
+		const InstanceData* pInstances,
+		GLsizei nInstances,
+		const glm::mat4* pViewProjection = NULL);
+	// called to read the instance attributes of both shared vertex
+	// arrays from the passed in buffer, starting at the offset
+	void BindInstanceBuffer(
+		GLuint buffer,
+		GLintptr offset);
 };
\ No newline at end of file
@@ -0,0 +1,308 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.cpp
+// ============
+// test the world space bounding boxes of the scene objects against the view
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCuller.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_CULLER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AVX2_FUNCTION
+#else
+#include <cpuid.h>
+#define AVX2_FUNCTION __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+// declaration of global variables
+namespace
+{
+	// number of boxes tested together by the AVX2 loop
+	const int g_BoxesPerBlock = 8;
+
+	/***********************************************************
+	 *  IsAVX2Supported()
+	 *
+	 *  This function is used to check that the processor has
+	 *  AVX2 and FMA, and that the operating system saves the
+	 *  AVX registers on context switches.
+	 ***********************************************************/
+	bool IsAVX2Supported()
+	{
+#if defined(FRUSTUM_CULLER_X86)
+		unsigned int features[4] = { 0, 0, 0, 0 };
+		unsigned int extendedFeatures[4] = { 0, 0, 0, 0 };
+		unsigned long long enabledState = 0;
+
+#if defined(_MSC_VER)
+		int registers[4];
+		__cpuid(registers, 0);
+		if (registers[0] < 7)
+		{
+			return(false);
+		}
+		__cpuid(registers, 1);
+		features[2] = (unsigned int)registers[2];
+		__cpuidex(registers, 7, 0);
+		extendedFeatures[1] = (unsigned int)registers[1];
+#else
+		if (__get_cpuid_max(0, NULL) < 7)
+		{
+			return(false);
+		}
+		__get_cpuid(1, &features[0], &features[1], &features[2], &features[3]);
+		__get_cpuid_count(7, 0, &extendedFeatures[0], &extendedFeatures[1], &extendedFeatures[2], &extendedFeatures[3]);
+#endif
+
+		const unsigned int fmaBit = 1u << 12;
+		const unsigned int osxsaveBit = 1u << 27;
+		const unsigned int avxBit = 1u << 28;
+		const unsigned int avx2Bit = 1u << 5;
+
+		if (((features[2] & (fmaBit | osxsaveBit | avxBit)) != (fmaBit | osxsaveBit | avxBit)) ||
+			((extendedFeatures[1] & avx2Bit) == 0))
+		{
+			return(false);
+		}
+
+		// the SSE and AVX register state must both be enabled
+#if defined(_MSC_VER)
+		enabledState = _xgetbv(0);
+#else
+		unsigned int eax = 0;
+		unsigned int edx = 0;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		enabledState = ((unsigned long long)edx << 32) | eax;
+#endif
+		return((enabledState & 0x6) == 0x6);
+#else
+		return(false);
+#endif
+	}
+}
+
+/***********************************************************
+ *  FrustumCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrustumCuller::FrustumCuller()
+{
+	m_count = 0;
+	m_bUseAVX2 = IsAVX2Supported();
+	m_stats.tested = 0;
+	m_stats.culled = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		m_planes[i] = glm::vec4(0.0f);
+	}
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used to set the number of bounding boxes.
+ *  The arrays are padded with empty boxes to a multiple of
+ *  eight, so the AVX2 loop never reads past their ends.
+ ***********************************************************/
+void FrustumCuller::Resize(int count)
+{
+	size_t paddedCount = (size_t)((count + g_BoxesPerBlock - 1) / g_BoxesPerBlock) * g_BoxesPerBlock;
+
+	m_count = count;
+	m_centerX.resize(paddedCount, 0.0f);
+	m_centerY.resize(paddedCount, 0.0f);
+	m_centerZ.resize(paddedCount, 0.0f);
+	m_extentX.resize(paddedCount, 0.0f);
+	m_extentY.resize(paddedCount, 0.0f);
+	m_extentZ.resize(paddedCount, 0.0f);
+	m_visible.resize(paddedCount, 1);
+}
+
+/***********************************************************
+ *  SetBounds()
+ *
+ *  This method is used to set the world space bounding box
+ *  of an object, as its center and half extents.
+ ***********************************************************/
+void FrustumCuller::SetBounds(int index, const glm::vec3& center, const glm::vec3& extents)
+{
+	m_centerX[index] = center.x;
+	m_centerY[index] = center.y;
+	m_centerZ[index] = center.z;
+	m_extentX[index] = extents.x;
+	m_extentY[index] = extents.y;
+	m_extentZ[index] = extents.z;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used to test all of the bounding boxes
+ *  against the view frustum and record which are visible.
+ ***********************************************************/
+int FrustumCuller::Cull(const glm::mat4& viewProjection)
+{
+	ExtractPlanes(viewProjection);
+
+	if ((true == m_bUseAVX2) && (m_count > 0))
+	{
+		CullAVX2((int)m_visible.size());
+	}
+	else
+	{
+		CullScalar(0, m_count);
+	}
+
+	int visibleCount = 0;
+	for (int i = 0; i < m_count; i++)
+	{
+		visibleCount += m_visible[i];
+	}
+
+	m_stats.tested = m_count;
+	m_stats.culled = m_count - visibleCount;
+
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  TransformBounds()
+ *
+ *  This method is used to transform a local bounding box
+ *  into the world space box that contains it.  The new
+ *  half extents are the old ones projected onto each
+ *  world axis through the absolute values of the matrix.
+ ***********************************************************/
+void FrustumCuller::TransformBounds(
+	const glm::mat4& model,
+	const glm::vec3& localMinimum,
+	const glm::vec3& localMaximum,
+	glm::vec3& center,
+	glm::vec3& extents)
+{
+	glm::vec3 localCenter = (localMinimum + localMaximum) * 0.5f;
+	glm::vec3 localExtents = (localMaximum - localMinimum) * 0.5f;
+
+	center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+	for (int row = 0; row < 3; row++)
+	{
+		extents[row] =
+			(fabsf(model[0][row]) * localExtents.x) +
+			(fabsf(model[1][row]) * localExtents.y) +
+			(fabsf(model[2][row]) * localExtents.z);
+	}
+}
+
+/***********************************************************
+ *  ExtractPlanes()
+ *
+ *  This method is used to extract the left, right, bottom,
+ *  top, near and far planes from the rows of the view
+ *  projection matrix.  The planes are not normalized,
+ *  since the box tests only compare signed distances.
+ ***********************************************************/
+void FrustumCuller::ExtractPlanes(const glm::mat4& viewProjection)
+{
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+			viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	m_planes[0] = rows[3] + rows[0];
+	m_planes[1] = rows[3] - rows[0];
+	m_planes[2] = rows[3] + rows[1];
+	m_planes[3] = rows[3] - rows[1];
+	m_planes[4] = rows[3] + rows[2];
+	m_planes[5] = rows[3] - rows[2];
+}
+
+/***********************************************************
+ *  CullScalar()
+ *
+ *  This method is used to test a range of boxes one at a
+ *  time.  A box is outside when its center is further
+ *  behind any plane than the box reaches towards it.
+ ***********************************************************/
+void FrustumCuller::CullScalar(int first, int count)
+{
+	for (int i = first; i < first + count; i++)
+	{
+		unsigned char bVisible = 1;
+
+		for (int p = 0; (p < 6) && (bVisible != 0); p++)
+		{
+			const glm::vec4& plane = m_planes[p];
+			float distance = (plane.x * m_centerX[i]) + (plane.y * m_centerY[i]) + (plane.z * m_centerZ[i]) + plane.w;
+			float reach = (fabsf(plane.x) * m_extentX[i]) + (fabsf(plane.y) * m_extentY[i]) + (fabsf(plane.z) * m_extentZ[i]);
+
+			if ((distance + reach) < 0.0f)
+			{
+				bVisible = 0;
+			}
+		}
+
+		m_visible[i] = bVisible;
+	}
+}
+
+/***********************************************************
+ *  CullAVX2()
+ *
+ *  This method is used to test the boxes eight at a time,
+ *  with the same test as the scalar loop.  It is only
+ *  called when the processor supports AVX2.
+ ***********************************************************/
+#if defined(FRUSTUM_CULLER_X86)
+AVX2_FUNCTION void FrustumCuller::CullAVX2(int count)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+	for (int i = 0; i < count; i += g_BoxesPerBlock)
+	{
+		__m256 centerX = _mm256_loadu_ps(&m_centerX[i]);
+		__m256 centerY = _mm256_loadu_ps(&m_centerY[i]);
+		__m256 centerZ = _mm256_loadu_ps(&m_centerZ[i]);
+		__m256 extentX = _mm256_loadu_ps(&m_extentX[i]);
+		__m256 extentY = _mm256_loadu_ps(&m_extentY[i]);
+		__m256 extentZ = _mm256_loadu_ps(&m_extentZ[i]);
+		int outsideMask = 0;
+
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 planeX = _mm256_set1_ps(m_planes[p].x);
+			__m256 planeY = _mm256_set1_ps(m_planes[p].y);
+			__m256 planeZ = _mm256_set1_ps(m_planes[p].z);
+			__m256 planeW = _mm256_set1_ps(m_planes[p].w);
+
+			__m256 distance = _mm256_fmadd_ps(planeX, centerX,
+				_mm256_fmadd_ps(planeY, centerY,
+				_mm256_fmadd_ps(planeZ, centerZ, planeW)));
+			__m256 reach = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, planeX), extentX,
+				_mm256_fmadd_ps(_mm256_andnot_ps(signMask, planeY), extentY,
+				_mm256_mul_ps(_mm256_andnot_ps(signMask, planeZ), extentZ)));
+
+			outsideMask |= _mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_LT_OQ));
+		}
+
+		for (int lane = 0; lane < g_BoxesPerBlock; lane++)
+		{
+			m_visible[i + lane] = (unsigned char)(((outsideMask >> lane) & 1) ^ 1);
+		}
+	}
+}
+#else
+void FrustumCuller::CullAVX2(int count)
+{
+	CullScalar(0, count);
+}
+#endif
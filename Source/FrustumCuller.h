@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.h
+// ============
+// test the world space bounding boxes of the scene objects against the view
+//
+// The bounding boxes are stored as centers and half extents in separate arrays,
+// so that eight boxes at a time can be tested against the six planes of the
+// view frustum with AVX2.  A scalar loop is used on processors without AVX2.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  This class contains the code for storing the bounding
+ *  boxes of the scene objects and finding the ones that
+ *  are outside of the view frustum.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+	// counters for the last culled frame
+	struct STATS
+	{
+		int tested;		// bounding boxes tested against the frustum
+		int culled;		// bounding boxes outside of the frustum
+	};
+
+	// constructor
+	FrustumCuller();
+
+	// set the number of bounding boxes, new boxes are empty
+	// and at the origin until their bounds are set
+	void Resize(int count);
+	// set the world space bounding box of an object
+	void SetBounds(int index, const glm::vec3& center, const glm::vec3& extents);
+	// test all bounding boxes against the frustum of the passed
+	// in view projection matrix, returns the number of visible boxes
+	int Cull(const glm::mat4& viewProjection);
+
+	// check whether a bounding box was inside the frustum
+	bool IsVisible(int index) const { return m_visible[index] != 0; }
+	// get the number of bounding boxes
+	int GetCount() const { return m_count; }
+	// get the counters for the last culled frame
+	const STATS& GetStats() const { return m_stats; }
+	// check whether the boxes are tested with AVX2
+	bool IsUsingAVX2() const { return m_bUseAVX2; }
+
+	// transform a local bounding box by a model matrix into the
+	// world space box that contains it
+	static void TransformBounds(
+		const glm::mat4& model,
+		const glm::vec3& localMinimum,
+		const glm::vec3& localMaximum,
+		glm::vec3& center,
+		glm::vec3& extents);
+
+private:
+	// box centers and half extents, padded to a multiple of eight
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_extentX;
+	std::vector<float> m_extentY;
+	std::vector<float> m_extentZ;
+	// the result of the last test for each box
+	std::vector<unsigned char> m_visible;
+	// number of bounding boxes
+	int m_count;
+	// frustum planes as normal and distance, facing inwards
+	glm::vec4 m_planes[6];
+	// the processor and the operating system support AVX2
+	bool m_bUseAVX2;
+	// counters for the last culled frame
+	STATS m_stats;
+
+	// extract the six frustum planes from the view projection matrix
+	void ExtractPlanes(const glm::mat4& viewProjection);
+	// test a range of boxes one at a time
+	void CullScalar(int first, int count);
+	// test the boxes eight at a time, the count is a multiple of eight
+	void CullAVX2(int count);
+};
@@ -0,0 +1,217 @@
+///////////////////////////////////////////////////////////////////////////////
+// gbuffer.cpp
+// ============
+// hold the surface attributes of the deferred geometry pass
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GBuffer.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  GBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GBuffer::GBuffer()
+{
+	m_framebufferID = 0;
+	m_albedoTexture = 0;
+	m_normalTexture = 0;
+	m_materialTexture = 0;
+	m_depthTexture = 0;
+	m_emptyVertexArray = 0;
+	m_width = 0;
+	m_height = 0;
+	m_bComplete = false;
+	m_bBlendEnabled = false;
+}
+
+/***********************************************************
+ *  ~GBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GBuffer::~GBuffer()
+{
+	Destroy();
+
+	if (0 != m_emptyVertexArray)
+	{
+		glDeleteVertexArrays(1, &m_emptyVertexArray);
+		m_emptyVertexArray = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used to create a render target texture
+ *  of the window size.  The lighting pass reads each pixel
+ *  with texelFetch(), so the targets have one level and
+ *  are never filtered.
+ ***********************************************************/
+GLuint GBuffer::CreateTarget(GLenum internalFormat)
+{
+	GLuint textureID = 0;
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, m_width, m_height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used to create the render targets for
+ *  the passed in size.  They are only recreated when the
+ *  size of the window changed.  It returns false when the
+ *  size is empty or the framebuffer is not complete.
+ ***********************************************************/
+bool GBuffer::Resize(int width, int height)
+{
+	if ((0 != m_framebufferID) && (width == m_width) && (height == m_height))
+	{
+		return(m_bComplete);
+	}
+
+	Destroy();
+	if ((width <= 0) || (height <= 0))
+	{
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+	m_albedoTexture = CreateTarget(GL_RGBA8);
+	m_normalTexture = CreateTarget(GL_RGB10_A2);
+	m_materialTexture = CreateTarget(GL_R16UI);
+	m_depthTexture = CreateTarget(GL_DEPTH_COMPONENT32F);
+
+	glGenFramebuffers(1, &m_framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_materialTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+
+	const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, drawBuffers);
+
+	m_bComplete = (GL_FRAMEBUFFER_COMPLETE == glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (m_bComplete == false)
+	{
+		std::cout << "G-buffer of " << width << "x" << height << " is not complete" << std::endl;
+	}
+
+	if (0 == m_emptyVertexArray)
+	{
+		glGenVertexArrays(1, &m_emptyVertexArray);
+	}
+
+	return(m_bComplete);
+}
+
+/***********************************************************
+ *  BeginGeometryPass()
+ *
+ *  This method is used to bind the render targets and
+ *  clear them.  A cleared pixel has no lit flag and the
+ *  far depth, so the lighting pass leaves it to the
+ *  clear color of the window.  Blending would mix the
+ *  normals and the lit flag of overlapping surfaces, so
+ *  it is off until the lighting pass.
+ ***********************************************************/
+void GBuffer::BeginGeometryPass()
+{
+	const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLuint clearMaterial[4] = { 0, 0, 0, 0 };
+	const GLfloat clearDepth = 1.0f;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glClearBufferfv(GL_COLOR, 0, clearColor);
+	glClearBufferfv(GL_COLOR, 1, clearColor);
+	glClearBufferuiv(GL_COLOR, 2, clearMaterial);
+	glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+	m_bBlendEnabled = (GL_TRUE == glIsEnabled(GL_BLEND));
+	glDisable(GL_BLEND);
+}
+
+/***********************************************************
+ *  DrawLightingPass()
+ *
+ *  This method is used to draw the lighting pass into the
+ *  window with the current shader program.  The render
+ *  targets are bound to their texture units, and one
+ *  triangle that covers the whole window is drawn.  The
+ *  lighting pass writes the depth of the geometry pass,
+ *  so the depth test always passes while it is drawn.
+ ***********************************************************/
+void GBuffer::DrawLightingPass()
+{
+	GLint depthFunction = GL_LESS;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (m_bBlendEnabled == true)
+	{
+		glEnable(GL_BLEND);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + ALBEDO_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_albedoTexture);
+	glActiveTexture(GL_TEXTURE0 + NORMAL_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_normalTexture);
+	glActiveTexture(GL_TEXTURE0 + MATERIAL_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_materialTexture);
+	glActiveTexture(GL_TEXTURE0 + DEPTH_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	glGetIntegerv(GL_DEPTH_FUNC, &depthFunction);
+	glDepthFunc(GL_ALWAYS);
+
+	glBindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+
+	glDepthFunc((GLenum)depthFunction);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the framebuffer and its
+ *  render targets.
+ ***********************************************************/
+void GBuffer::Destroy()
+{
+	if (0 != m_framebufferID)
+	{
+		glDeleteFramebuffers(1, &m_framebufferID);
+		m_framebufferID = 0;
+	}
+
+	GLuint* targets[] = { &m_albedoTexture, &m_normalTexture, &m_materialTexture, &m_depthTexture };
+	for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++)
+	{
+		if (0 != *targets[i])
+		{
+			glDeleteTextures(1, targets[i]);
+			*targets[i] = 0;
+		}
+	}
+
+	m_width = 0;
+	m_height = 0;
+	m_bComplete = false;
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// gbuffer.h
+// ============
+// hold the surface attributes of the deferred geometry pass
+//
+// The geometry pass writes the albedo, the normal and the material index of
+// the nearest surface of every pixel, together with its depth.  The lighting
+// pass then reads them back with one full-screen triangle, so each pixel is
+// lit once no matter how many surfaces were drawn over it.  The targets are
+// kept small - RGBA8 albedo, RGB10_A2 normal with the lit flag in the alpha
+// bits, R16UI material index and a 32-bit float depth, 14 bytes per pixel.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  GBuffer
+ *
+ *  This class contains the code for the render targets of
+ *  the deferred geometry pass and the full-screen lighting
+ *  pass that reads them.
+ ***********************************************************/
+class GBuffer
+{
+public:
+	// texture units the lighting pass reads the targets from,
+	// unit 0 stays bound to the texture array of the scene
+	enum TEXTURE_UNIT
+	{
+		ALBEDO_UNIT = 1,
+		NORMAL_UNIT = 2,
+		MATERIAL_UNIT = 3,
+		DEPTH_UNIT = 4
+	};
+
+	// constructor
+	GBuffer();
+	// destructor
+	~GBuffer();
+
+	// create the render targets for the passed in size, or recreate
+	// them when the size changed - returns false when the driver
+	// cannot render into them
+	bool Resize(int width, int height);
+	// bind the render targets and clear them for the geometry pass
+	void BeginGeometryPass();
+	// bind the window again and the render targets as textures,
+	// and draw the full-screen triangle of the lighting pass
+	void DrawLightingPass();
+	// free the render targets
+	void Destroy();
+
+	// check whether the render targets can be drawn into
+	bool IsComplete() const { return m_bComplete; }
+
+private:
+	// framebuffer of the geometry pass and its render targets
+	GLuint m_framebufferID;
+	GLuint m_albedoTexture;
+	GLuint m_normalTexture;
+	GLuint m_materialTexture;
+	GLuint m_depthTexture;
+	// the full-screen triangle has no vertex attributes, but a core
+	// profile context still needs a vertex array to draw
+	GLuint m_emptyVertexArray;
+	// size of the render targets
+	int m_width;
+	int m_height;
+	// the framebuffer passed the completeness check
+	bool m_bComplete;
+	// blending was enabled before the geometry pass
+	bool m_bBlendEnabled;
+
+	// create a render target texture of the passed in format
+	GLuint CreateTarget(GLenum internalFormat);
+};
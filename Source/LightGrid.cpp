@@ -0,0 +1,302 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightgrid.cpp
+// ============
+// assign the point lights of the scene to the clusters of the view frustum
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightGrid.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LIGHT_GRID_SSE
+#include <emmintrin.h>
+#endif
+
+/***********************************************************
+ *  LightGrid()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightGrid::LightGrid()
+{
+	m_minX.resize(CLUSTER_COUNT, 0.0f);
+	m_minY.resize(CLUSTER_COUNT, 0.0f);
+	m_minZ.resize(CLUSTER_COUNT, 0.0f);
+	m_maxX.resize(CLUSTER_COUNT, 0.0f);
+	m_maxY.resize(CLUSTER_COUNT, 0.0f);
+	m_maxZ.resize(CLUSTER_COUNT, 0.0f);
+	m_clusters.resize(CLUSTER_COUNT);
+
+	m_nearDepth = 0.1f;
+	m_farDepth = 100.0f;
+	memset(m_sliceDepths, 0, sizeof(m_sliceDepths));
+	m_projection = glm::mat4(1.0f);
+	m_viewportWidth = 0;
+	m_viewportHeight = 0;
+	m_bBoundsValid = false;
+
+	m_constants.clusterCounts = glm::uvec4(0, 0, 0, 0);
+	m_constants.tileSize = glm::vec4(0.0f);
+	m_constants.depthSlicing = glm::vec4(0.0f);
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/***********************************************************
+ *  BuildClusterBounds()
+ *
+ *  This method is used to build the view space bounding
+ *  box of every cluster.  The corners of each tile are
+ *  moved onto the near plane, and scaled along their view
+ *  ray to the first and last depth of each slice.  The
+ *  projection is a perspective one, so the near and far
+ *  planes are read back from it.
+ ***********************************************************/
+void LightGrid::BuildClusterBounds(const glm::mat4& projection, int viewportWidth, int viewportHeight)
+{
+	m_projection = projection;
+	m_viewportWidth = viewportWidth;
+	m_viewportHeight = viewportHeight;
+	m_bBoundsValid = true;
+
+	m_nearDepth = projection[3][2] / (projection[2][2] - 1.0f);
+	m_farDepth = projection[3][2] / (projection[2][2] + 1.0f);
+
+	const float depthRatio = m_farDepth / m_nearDepth;
+	for (int k = 0; k <= CLUSTERS_Z; k++)
+	{
+		m_sliceDepths[k] = m_nearDepth * std::pow(depthRatio, (float)k / (float)CLUSTERS_Z);
+	}
+
+	// the shaders find the slice from the log of the view depth
+	const float logRatio = std::log(depthRatio);
+	m_constants.clusterCounts = glm::uvec4(CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z, 0);
+	m_constants.tileSize = glm::vec4(
+		(float)viewportWidth / (float)CLUSTERS_X,
+		(float)viewportHeight / (float)CLUSTERS_Y, 0.0f, 0.0f);
+	m_constants.depthSlicing = glm::vec4(
+		(float)CLUSTERS_Z / logRatio,
+		-(float)CLUSTERS_Z * std::log(m_nearDepth) / logRatio, 0.0f, 0.0f);
+
+	const glm::mat4 inverseProjection = glm::inverse(projection);
+
+	for (int j = 0; j < CLUSTERS_Y; j++)
+	{
+		for (int i = 0; i < CLUSTERS_X; i++)
+		{
+			// the corners of the tile on the near plane
+			glm::vec3 corners[4];
+			for (int c = 0; c < 4; c++)
+			{
+				float x = -1.0f + (2.0f * (float)(i + (c & 1)) / (float)CLUSTERS_X);
+				float y = -1.0f + (2.0f * (float)(j + (c >> 1)) / (float)CLUSTERS_Y);
+				glm::vec4 corner = inverseProjection * glm::vec4(x, y, -1.0f, 1.0f);
+				corners[c] = glm::vec3(corner) / corner.w;
+			}
+
+			for (int k = 0; k < CLUSTERS_Z; k++)
+			{
+				glm::vec3 minimum = glm::vec3(FLT_MAX);
+				glm::vec3 maximum = glm::vec3(-FLT_MAX);
+
+				for (int c = 0; c < 4; c++)
+				{
+					// the near plane corner is at the near depth, so
+					// scaling it moves it along its view ray
+					glm::vec3 nearCorner = corners[c] * (m_sliceDepths[k] / m_nearDepth);
+					glm::vec3 farCorner = corners[c] * (m_sliceDepths[k + 1] / m_nearDepth);
+					minimum = glm::min(minimum, glm::min(nearCorner, farCorner));
+					maximum = glm::max(maximum, glm::max(nearCorner, farCorner));
+				}
+
+				int index = (((k * CLUSTERS_Y) + j) * CLUSTERS_X) + i;
+				m_minX[index] = minimum.x;
+				m_minY[index] = minimum.y;
+				m_minZ[index] = minimum.z;
+				m_maxX[index] = maximum.x;
+				m_maxY[index] = maximum.y;
+				m_maxZ[index] = maximum.z;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetSlice()
+ *
+ *  This method is used to get the depth slice that holds
+ *  the passed in view depth, clamped to the slices.
+ ***********************************************************/
+int LightGrid::GetSlice(float viewDepth) const
+{
+	if (viewDepth <= m_nearDepth)
+	{
+		return(0);
+	}
+
+	int slice = (int)std::floor((std::log(viewDepth) * m_constants.depthSlicing.x) + m_constants.depthSlicing.y);
+
+	return(std::min(std::max(slice, 0), CLUSTERS_Z - 1));
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used to build the light lists of the
+ *  clusters for the passed in view.  The assignments are
+ *  collected in light order and then grouped by cluster
+ *  with a counting sort, so the lights of each cluster
+ *  stay in light order.
+ ***********************************************************/
+void LightGrid::Update(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportWidth,
+	int viewportHeight,
+	const std::vector<POINT_LIGHT>& lights)
+{
+	if ((m_bBoundsValid == false) || (projection != m_projection) ||
+		(viewportWidth != m_viewportWidth) || (viewportHeight != m_viewportHeight))
+	{
+		BuildClusterBounds(projection, viewportWidth, viewportHeight);
+	}
+
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_stats.lights = (int)lights.size();
+
+	m_assignedClusters.clear();
+	m_assignedLights.clear();
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		if (lights[i].radius <= 0.0f)
+		{
+			continue;
+		}
+
+		size_t assignmentCount = m_assignedClusters.size();
+		glm::vec3 center = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+		AssignLight((unsigned int)i, center, lights[i].radius);
+
+		if (m_assignedClusters.size() > assignmentCount)
+		{
+			m_stats.visibleLights++;
+		}
+	}
+
+	for (int c = 0; c < CLUSTER_COUNT; c++)
+	{
+		m_clusters[c].firstLight = 0;
+		m_clusters[c].lightCount = 0;
+	}
+	for (size_t a = 0; a < m_assignedClusters.size(); a++)
+	{
+		m_clusters[m_assignedClusters[a]].lightCount++;
+	}
+
+	unsigned int firstLight = 0;
+	for (int c = 0; c < CLUSTER_COUNT; c++)
+	{
+		m_clusters[c].firstLight = firstLight;
+		firstLight += m_clusters[c].lightCount;
+		m_stats.maxClusterLights = std::max(m_stats.maxClusterLights, (int)m_clusters[c].lightCount);
+
+		// the count is rebuilt while the lists are filled
+		m_clusters[c].lightCount = 0;
+	}
+
+	m_lightIndices.resize(m_assignedClusters.size());
+	for (size_t a = 0; a < m_assignedClusters.size(); a++)
+	{
+		LIGHT_CLUSTER& cluster = m_clusters[m_assignedClusters[a]];
+		m_lightIndices[cluster.firstLight + cluster.lightCount] = m_assignedLights[a];
+		cluster.lightCount++;
+	}
+	m_stats.assignments = (int)m_lightIndices.size();
+}
+
+/***********************************************************
+ *  AssignLight()
+ *
+ *  This method is used to test the sphere of a light in
+ *  view space against the clusters of the depth slices it
+ *  reaches.  The distance from the center to each box is
+ *  measured per axis, so four neighbouring clusters of a
+ *  row are tested together with SSE.
+ ***********************************************************/
+void LightGrid::AssignLight(unsigned int lightIndex, const glm::vec3& center, float radius)
+{
+	// the camera looks down the negative Z axis in view space
+	const float depth = -center.z;
+	if (((depth + radius) < m_nearDepth) || ((depth - radius) > m_farDepth))
+	{
+		return;
+	}
+
+	const int firstSlice = GetSlice(depth - radius);
+	const int lastSlice = GetSlice(depth + radius);
+	const float radiusSquared = radius * radius;
+
+#if defined(LIGHT_GRID_SSE)
+	const __m128 centerX = _mm_set1_ps(center.x);
+	const __m128 centerY = _mm_set1_ps(center.y);
+	const __m128 centerZ = _mm_set1_ps(center.z);
+	const __m128 reach = _mm_set1_ps(radiusSquared);
+	const __m128 zero = _mm_setzero_ps();
+#endif
+
+	for (int k = firstSlice; k <= lastSlice; k++)
+	{
+		for (int j = 0; j < CLUSTERS_Y; j++)
+		{
+			const int rowStart = ((k * CLUSTERS_Y) + j) * CLUSTERS_X;
+
+#if defined(LIGHT_GRID_SSE)
+			for (int i = 0; i < CLUSTERS_X; i += 4)
+			{
+				const int index = rowStart + i;
+
+				// only one of the two distances of an axis is positive
+				__m128 dx = _mm_add_ps(
+					_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minX[index]), centerX), zero),
+					_mm_max_ps(_mm_sub_ps(centerX, _mm_loadu_ps(&m_maxX[index])), zero));
+				__m128 dy = _mm_add_ps(
+					_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minY[index]), centerY), zero),
+					_mm_max_ps(_mm_sub_ps(centerY, _mm_loadu_ps(&m_maxY[index])), zero));
+				__m128 dz = _mm_add_ps(
+					_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minZ[index]), centerZ), zero),
+					_mm_max_ps(_mm_sub_ps(centerZ, _mm_loadu_ps(&m_maxZ[index])), zero));
+				__m128 distanceSquared = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+				int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, reach));
+				for (int lane = 0; (lane < 4) && (0 != mask); lane++)
+				{
+					if (0 != (mask & (1 << lane)))
+					{
+						m_assignedClusters.push_back((unsigned int)(index + lane));
+						m_assignedLights.push_back(lightIndex);
+					}
+				}
+			}
+#else
+			for (int i = 0; i < CLUSTERS_X; i++)
+			{
+				const int index = rowStart + i;
+
+				float dx = std::max(m_minX[index] - center.x, 0.0f) + std::max(center.x - m_maxX[index], 0.0f);
+				float dy = std::max(m_minY[index] - center.y, 0.0f) + std::max(center.y - m_maxY[index], 0.0f);
+				float dz = std::max(m_minZ[index] - center.z, 0.0f) + std::max(center.z - m_maxZ[index], 0.0f);
+
+				if (((dx * dx) + (dy * dy) + (dz * dz)) <= radiusSquared)
+				{
+					m_assignedClusters.push_back((unsigned int)index);
+					m_assignedLights.push_back(lightIndex);
+				}
+			}
+#endif
+		}
+	}
+}
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightgrid.h
+// ============
+// assign the point lights of the scene to the clusters of the view frustum
+//
+// The view frustum is split into clusters, tiles of the window along x and y
+// and slices of the view depth that grow logarithmically with the distance.
+// Every frame each point light is moved into view space and its sphere is
+// tested against the clusters of the depth slices it reaches, four clusters
+// at a time with SSE.  The lights of each cluster are listed one after
+// another, so the fragment shader only loops over the lights that reach the
+// cluster it is in.  The bounds of the clusters only change with the
+// projection.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderBlocks.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  LightGrid
+ *
+ *  This class contains the code for building the lists
+ *  of the point lights that reach each cluster of the
+ *  view frustum.
+ ***********************************************************/
+class LightGrid
+{
+public:
+	// clusters along the x, y and depth axes of the view, the x
+	// count is a multiple of the four clusters tested together
+	static const int CLUSTERS_X = 16;
+	static const int CLUSTERS_Y = 9;
+	static const int CLUSTERS_Z = 24;
+	static const int CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+
+	// counters for the last updated frame
+	struct STATS
+	{
+		int lights;				// point lights in the scene
+		int visibleLights;		// point lights reaching at least one cluster
+		int assignments;		// entries of the light index lists
+		int maxClusterLights;	// lights of the most crowded cluster
+	};
+
+	// constructor
+	LightGrid();
+
+	// build the light lists of the clusters for the passed in view,
+	// the bounds of the clusters are rebuilt when the projection
+	// or the size of the viewport changed
+	void Update(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportWidth,
+		int viewportHeight,
+		const std::vector<POINT_LIGHT>& lights);
+
+	// get the layout of the clusters for the shaders
+	const LIGHT_GRID_CONSTANTS& GetConstants() const { return m_constants; }
+	// get the range of the light index list of each cluster
+	const std::vector<LIGHT_CLUSTER>& GetClusters() const { return m_clusters; }
+	// get the light index lists of all clusters
+	const std::vector<unsigned int>& GetLightIndices() const { return m_lightIndices; }
+	// get the counters for the last updated frame
+	const STATS& GetStats() const { return m_stats; }
+
+private:
+	// view space bounding boxes of the clusters, by cluster index
+	std::vector<float> m_minX;
+	std::vector<float> m_minY;
+	std::vector<float> m_minZ;
+	std::vector<float> m_maxX;
+	std::vector<float> m_maxY;
+	std::vector<float> m_maxZ;
+	// view depth of the near and far plane, and the first
+	// depth of each slice
+	float m_nearDepth;
+	float m_farDepth;
+	float m_sliceDepths[CLUSTERS_Z + 1];
+	// the projection and viewport the bounds were built for
+	glm::mat4 m_projection;
+	int m_viewportWidth;
+	int m_viewportHeight;
+	bool m_bBoundsValid;
+
+	// layout of the clusters for the shaders
+	LIGHT_GRID_CONSTANTS m_constants;
+	// range of the light index list of each cluster
+	std::vector<LIGHT_CLUSTER> m_clusters;
+	// light index lists of all clusters, one after another
+	std::vector<unsigned int> m_lightIndices;
+	// cluster and light of each assignment, in light order
+	std::vector<unsigned int> m_assignedClusters;
+	std::vector<unsigned int> m_assignedLights;
+	// counters for the last updated frame
+	STATS m_stats;
+
+	// build the view space bounds of the clusters and the
+	// depth slicing for the passed in projection
+	void BuildClusterBounds(const glm::mat4& projection, int viewportWidth, int viewportHeight);
+	// get the depth slice that contains the passed in view depth
+	int GetSlice(float viewDepth) const;
+	// test a light against the clusters of its depth slices and
+	// record the clusters it reaches
+	void AssignLight(unsigned int lightIndex, const glm::vec3& center, float radius);
+};
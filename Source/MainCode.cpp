@@ -14,6 +14,11 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "MeshCache.h"
+#include "VertexFormatBenchmark.h"
+
+#include <chrono>
+#include <cstring>
 
 // Namespace for declaring global variables
 namespace
@@ -30,12 +35,24 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+
+	// directory of the linked shader programs, next to the cached meshes
+	const char* g_ProgramCacheDirectory = "../../7-1_FinalProjectMilestones/Utilities/cache";
+
+	// seconds between the frame statistics reports
+	const double g_StatsReportInterval = 5.0;
+	// time of the last frame statistics report
+	double g_LastStatsReportTime = 0.0;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool HasCommandLineOption(int argc, char* argv[], const char* option);
+void ReportFrameStatistics();
+void ReportMeshOptimization();
+void ReportStartupTime(std::chrono::steady_clock::time_point startTime);
 
 
 /***********************************************************
@@ -46,6 +63,10 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// the time to the first frame includes the loading of the meshes
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	bool bFirstFrame = true;
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -67,15 +88,63 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
+	// the cold path compiles the shaders, for comparing the startup time
+	if ((HasCommandLineOption(argc, argv, "--no-shader-cache") == false) &&
+		(MeshCache::CreateCacheDirectory(g_ProgramCacheDirectory) == true))
+	{
+		g_ShaderManager->SetProgramCacheDirectory(g_ProgramCacheDirectory);
+	}
+
+	// start loading the shader code from the external GLSL files - the
+	// driver compiles it while the scene meshes and textures are loaded
+	if (g_ShaderManager->BeginLoadShaders(
 		"../../7-1_FinalProjectMilestones/Utilities/shaders/vertexShader.glsl",
-		"../../7-1_FinalProjectMilestones/Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+		"../../7-1_FinalProjectMilestones/Utilities/shaders/fragmentShader.glsl") == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	if (HasCommandLineOption(argc, argv, "--vertex-benchmark"))
+	{
+		if (g_ShaderManager->WaitForShaders() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_ShaderManager->use();
+
+		// compare the vertex layouts instead of showing the scene
+		VertexFormatBenchmark benchmark(g_ShaderManager);
+		benchmark.Run();
+		glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+	}
+	else
+	{
+		// try to create a new scene manager object and prepare the 3D scene
+		g_SceneManager = new SceneManager(g_ShaderManager);
+		// the cold path regenerates all meshes, for comparing the startup time
+		g_SceneManager->SetMeshCacheEnabled(!HasCommandLineOption(argc, argv, "--no-mesh-cache"));
+		g_SceneManager->SetTextureCacheEnabled(!HasCommandLineOption(argc, argv, "--no-texture-cache"));
+		// the objects are lit per pixel of a G-buffer instead of per drawn
+		// fragment, for comparing the two on views with a lot of overdraw
+		g_SceneManager->SetDeferredShading(HasCommandLineOption(argc, argv, "--deferred"));
+		g_SceneManager->PrepareScene();
+		ReportMeshOptimization();
+
+		// keep uploading the decoded textures and serving the window
+		// events until the driver has linked the shader program
+		while (g_ShaderManager->IsProgramReady() == false)
+		{
+			g_SceneManager->UpdateTextures();
+			glfwWaitEventsTimeout(0.001);
+		}
 
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+		// the first frame needs the linked program
+		if (g_ShaderManager->WaitForShaders() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_ShaderManager->use();
+	}
 
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
@@ -94,10 +163,19 @@ int main(int argc, char* argv[])
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
 
+		// periodically output the rendering counters
+		ReportFrameStatistics();
+
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
+		if (bFirstFrame == true)
+		{
+			ReportStartupTime(startTime);
+			bFirstFrame = false;
+		}
+
 		// query the latest GLFW events
 		glfwPollEvents();
 	}
@@ -175,4 +253,126 @@ bool InitializeGLEW()
 	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
 
 	return(true);
+}
+
+/***********************************************************
+ *	HasCommandLineOption()
+ *
+ *  This function is used to check whether an option was
+ *  passed on the command line.
+ ***********************************************************/
+bool HasCommandLineOption(int argc, char* argv[], const char* option)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (0 == strcmp(argv[i], option))
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *	ReportMeshOptimization()
+ *
+ *  This function is used to output the simulated vertex
+ *  cache counters of the loaded meshes, before and after
+ *  they were reordered for the GPU.
+ ***********************************************************/
+void ReportMeshOptimization()
+{
+	const ShapeMeshes::OptimizationStats& stats = g_SceneManager->GetMeshOptimizationStats();
+	if ((0 == stats.nTriangles) || (0 == stats.nVertices))
+	{
+		return;
+	}
+
+	std::cout << "INFO: Mesh optimization - meshes: " << stats.nMeshes
+		<< ", triangles: " << stats.nTriangles
+		<< ", ACMR: " << (float)stats.nTransformsBefore / stats.nTriangles
+		<< " -> " << (float)stats.nTransformsAfter / stats.nTriangles
+		<< ", ATVR: " << (float)stats.nTransformsBefore / stats.nVertices
+		<< " -> " << (float)stats.nTransformsAfter / stats.nVertices << std::endl;
+}
+
+/***********************************************************
+ *	ReportStartupTime()
+ *
+ *  This function is used to output the time from the start
+ *  of the application to the first presented frame, how
+ *  many meshes came from the cache files, and whether the
+ *  shader variants had to be compiled.
+ ***********************************************************/
+void ReportStartupTime(std::chrono::steady_clock::time_point startTime)
+{
+	const std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::steady_clock::now() - startTime;
+
+	std::cout << "INFO: Time to first frame: " << elapsed.count() << " ms";
+	if (NULL != g_SceneManager)
+	{
+		const ShapeMeshes::MeshCacheStats& cacheStats = g_SceneManager->GetMeshCacheStats();
+		std::cout << ", mesh cache hits: " << cacheStats.nHits
+			<< ", misses: " << cacheStats.nMisses
+			<< ", written: " << cacheStats.nWritten;
+	}
+	std::cout << ", shader programs: " << g_ShaderManager->GetVariantCount()
+		<< ((g_ShaderManager->IsProgramFromCache() == true) ? " cached" : " compiled")
+		<< " (waited " << g_ShaderManager->GetShaderWaitTime() << " ms)";
+	std::cout << std::endl;
+}
+
+/***********************************************************
+ *	ReportFrameStatistics()
+ *
+ *  This function is used to periodically output the
+ *  rendering counters of the last frame.
+ ***********************************************************/
+void ReportFrameStatistics()
+{
+	double currentTime = glfwGetTime();
+	if ((currentTime - g_LastStatsReportTime) < g_StatsReportInterval)
+	{
+		return;
+	}
+	g_LastStatsReportTime = currentTime;
+
+	std::cout << "INFO: Renderer - " << ((g_SceneManager->IsDeferredShading() == true) ? "deferred" : "forward")
+		<< " shading, scene GPU time: " << g_SceneManager->GetSceneGpuTime() << " ms" << std::endl;
+
+	const RenderQueue::STATS& queueStats = g_SceneManager->GetRenderQueueStats();
+	std::cout << "INFO: Render queue - packets: " << queueStats.packets
+		<< ", batches: " << queueStats.batches
+		<< ", mesh changes: " << queueStats.meshChanges
+		<< ", program changes: " << queueStats.programChanges
+		<< ", unsorted state changes: " << queueStats.unsortedStateChanges
+		<< ", sorted state changes: " << queueStats.sortedStateChanges
+		<< ", state changes avoided: " << queueStats.stateChangesAvoided << std::endl;
+	std::cout << "INFO: Scene graph - world matrices updated: "
+		<< g_SceneManager->GetTransformUpdateCount() << std::endl;
+
+	const FrustumCuller::STATS& cullingStats = g_SceneManager->GetCullingStats();
+	std::cout << "INFO: Frustum culling - objects tested: " << cullingStats.tested
+		<< ", culled: " << cullingStats.culled << std::endl;
+
+	const OcclusionCuller::STATS& occlusionStats = g_SceneManager->GetOcclusionStats();
+	std::cout << "INFO: Occlusion culling - occluders: " << occlusionStats.occluders
+		<< ", triangles: " << occlusionStats.triangles
+		<< ", tested: " << occlusionStats.tested
+		<< ", occluded: " << occlusionStats.occluded << std::endl;
+
+	const LightGrid::STATS& lightGridStats = g_SceneManager->GetLightGridStats();
+	std::cout << "INFO: Light clusters - point lights: " << lightGridStats.lights
+		<< ", visible: " << lightGridStats.visibleLights
+		<< ", assignments: " << lightGridStats.assignments
+		<< ", max per cluster: " << lightGridStats.maxClusterLights << std::endl;
+
+	std::cout << "INFO: Mesh LODs - objects per level:";
+	for (int lod = 0; lod < ShapeMeshes::MESH_LOD_COUNT; lod++)
+	{
+		std::cout << " " << g_SceneManager->GetLodObjectCount(lod);
+	}
+	std::cout << std::endl;
 }
\ No newline at end of file
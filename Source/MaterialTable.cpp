@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// materialtable.cpp
+// ============
+// structure-of-arrays storage of the object materials
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MaterialTable.h"
+
+/***********************************************************
+ *  MaterialTable()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MaterialTable::MaterialTable()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used to remove all of the materials.
+ ***********************************************************/
+void MaterialTable::Clear()
+{
+	m_tags.clear();
+	m_ambientColors.clear();
+	m_ambientStrengths.clear();
+	m_diffuseColors.clear();
+	m_specularColors.clear();
+	m_shininess.clear();
+	m_tagIndex.clear();
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used to add a material to the table and
+ *  return its id.  A tag that is already defined keeps
+ *  its id, so ids that were handed out stay valid.
+ ***********************************************************/
+MaterialId MaterialTable::AddMaterial(
+	const std::string& tag,
+	glm::vec3 ambientColor,
+	float ambientStrength,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float shininess)
+{
+	MaterialId id = FindMaterial(tag);
+
+	if (id == INVALID_MATERIAL)
+	{
+		id = GetCount();
+		m_tags.push_back(tag);
+		m_ambientColors.push_back(ambientColor);
+		m_ambientStrengths.push_back(ambientStrength);
+		m_diffuseColors.push_back(diffuseColor);
+		m_specularColors.push_back(specularColor);
+		m_shininess.push_back(shininess);
+		m_tagIndex[tag] = id;
+	}
+	else
+	{
+		m_ambientColors[id] = ambientColor;
+		m_ambientStrengths[id] = ambientStrength;
+		m_diffuseColors[id] = diffuseColor;
+		m_specularColors[id] = specularColor;
+		m_shininess[id] = shininess;
+	}
+
+	return(id);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used to find the id of a material by
+ *  its tag, returns INVALID_MATERIAL if it is not defined.
+ ***********************************************************/
+MaterialId MaterialTable::FindMaterial(const std::string& tag) const
+{
+	std::unordered_map<std::string, MaterialId>::const_iterator it = m_tagIndex.find(tag);
+
+	if (it == m_tagIndex.end())
+	{
+		return(INVALID_MATERIAL);
+	}
+
+	return(it->second);
+}
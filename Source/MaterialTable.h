@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// materialtable.h
+// ============
+// structure-of-arrays storage of the object materials
+//
+// Materials are defined once while the scene is prepared.  Each definition
+// returns a MaterialId, a stable index into the table, and draws reference
+// their material by that id instead of by its tag.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// identifies a material in the material table
+typedef int MaterialId;
+const MaterialId INVALID_MATERIAL = -1;
+
+/***********************************************************
+ *  MaterialTable
+ *
+ *  This class contains the code for storing the object
+ *  materials and resolving their tags to ids.
+ ***********************************************************/
+class MaterialTable
+{
+public:
+	// constructor
+	MaterialTable();
+
+	// remove all of the materials
+	void Clear();
+
+	// add a material and return its id, defining a tag a second
+	// time replaces the values and keeps the existing id
+	MaterialId AddMaterial(
+		const std::string& tag,
+		glm::vec3 ambientColor,
+		float ambientStrength,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float shininess);
+
+	// find the id of a material by its tag, only meant to be
+	// used while building the scene and not for each draw
+	MaterialId FindMaterial(const std::string& tag) const;
+
+	// check that the id refers to a defined material
+	bool IsValid(MaterialId id) const { return (id >= 0) && (id < GetCount()); }
+	// get the number of defined materials
+	int GetCount() const { return (int)m_tags.size(); }
+
+	// get the values of a defined material
+	const std::string& GetTag(MaterialId id) const { return m_tags[id]; }
+	const glm::vec3& GetAmbientColor(MaterialId id) const { return m_ambientColors[id]; }
+	float GetAmbientStrength(MaterialId id) const { return m_ambientStrengths[id]; }
+	const glm::vec3& GetDiffuseColor(MaterialId id) const { return m_diffuseColors[id]; }
+	const glm::vec3& GetSpecularColor(MaterialId id) const { return m_specularColors[id]; }
+	float GetShininess(MaterialId id) const { return m_shininess[id]; }
+
+private:
+	// material values, indexed by MaterialId
+	std::vector<std::string> m_tags;
+	std::vector<glm::vec3> m_ambientColors;
+	std::vector<float> m_ambientStrengths;
+	std::vector<glm::vec3> m_diffuseColors;
+	std::vector<glm::vec3> m_specularColors;
+	std::vector<float> m_shininess;
+	// material ids by tag
+	std::unordered_map<std::string, MaterialId> m_tagIndex;
+};
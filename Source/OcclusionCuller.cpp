@@ -0,0 +1,495 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// hide the scene objects that are behind large occluders, on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OCCLUSION_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// resolution of the occlusion depth buffer, the width is
+	// a multiple of the four pixels that are filled together
+	const int g_DepthWidth = 256;
+	const int g_DepthHeight = 128;
+	// corners closer to the camera than this clip space w are
+	// not rasterized, and bounds that reach them are visible
+	const float g_MinClipW = 0.001f;
+	// number of finer pyramid levels that are tried when the
+	// coarse level cannot decide whether a box is hidden
+	const int g_RefineLevels = 2;
+
+	// the two triangles of each face of a box, by corner index
+	// where bit 0 selects the maximum x, bit 1 y and bit 2 z
+	const int g_BoxTriangles[12][3] =
+	{
+		{ 0, 2, 6 }, { 0, 6, 4 },	// -x
+		{ 1, 5, 7 }, { 1, 7, 3 },	// +x
+		{ 0, 4, 5 }, { 0, 5, 1 },	// -y
+		{ 2, 3, 7 }, { 2, 7, 6 },	// +y
+		{ 0, 1, 3 }, { 0, 3, 2 },	// -z
+		{ 4, 6, 7 }, { 4, 7, 5 }	// +z
+	};
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller()
+{
+	m_viewProjection = glm::mat4(1.0f);
+	m_bDepthValid = false;
+	m_bJobPending = false;
+	m_bStopping = false;
+	m_stats.occluders = 0;
+	m_stats.triangles = 0;
+	m_stats.tested = 0;
+	m_stats.occluded = 0;
+
+	// every level halves the size of the previous one, down to 1x1
+	int width = g_DepthWidth;
+	int height = g_DepthHeight;
+	for (;;)
+	{
+		m_minDepths.push_back(std::vector<float>((size_t)width * height, 1.0f));
+		m_maxDepths.push_back(std::vector<float>((size_t)width * height, 1.0f));
+		if ((width == 1) && (height == 1))
+		{
+			break;
+		}
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+
+	m_worker = std::thread(&OcclusionCuller::WorkerLoop, this);
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_jobCondition.notify_one();
+
+	if (m_worker.joinable())
+	{
+		m_worker.join();
+	}
+}
+
+/***********************************************************
+ *  BeginRasterize()
+ *
+ *  This method is used to hand the occluders of a frame to
+ *  the worker thread.  The occluders are copied, so the
+ *  caller can reuse its list right away.
+ ***********************************************************/
+void OcclusionCuller::BeginRasterize(
+	const glm::mat4& viewProjection,
+	const std::vector<OCCLUDER>& occluders)
+{
+	WaitForRasterize();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_viewProjection = viewProjection;
+		m_occluders = occluders;
+		m_bDepthValid = false;
+		m_bJobPending = true;
+		m_stats.occluders = (int)occluders.size();
+		m_stats.triangles = 0;
+		m_stats.tested = 0;
+		m_stats.occluded = 0;
+	}
+	m_jobCondition.notify_one();
+}
+
+/***********************************************************
+ *  WaitForRasterize()
+ *
+ *  This method is used to wait until the worker thread has
+ *  built the depth pyramid for the last occluders.
+ ***********************************************************/
+void OcclusionCuller::WaitForRasterize()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_bJobPending == true)
+	{
+		m_doneCondition.wait(lock);
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by the worker thread.  It waits for
+ *  the occluders of a frame and builds their depth pyramid.
+ ***********************************************************/
+void OcclusionCuller::WorkerLoop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	for (;;)
+	{
+		while ((m_bJobPending == false) && (m_bStopping == false))
+		{
+			m_jobCondition.wait(lock);
+		}
+		if (m_bStopping == true)
+		{
+			return;
+		}
+
+		// the job data is not touched by the main thread until
+		// the job is done, so the lock is not needed meanwhile
+		lock.unlock();
+		RasterizeOccluders();
+		BuildPyramid();
+		lock.lock();
+
+		m_bDepthValid = true;
+		m_bJobPending = false;
+		m_doneCondition.notify_all();
+	}
+}
+
+/***********************************************************
+ *  RasterizeOccluders()
+ *
+ *  This method is used to clear the depth buffer and draw
+ *  the faces of all occluder boxes into it.  Faces with a
+ *  corner behind the camera are skipped, which can only
+ *  make the occluders smaller.
+ ***********************************************************/
+void OcclusionCuller::RasterizeOccluders()
+{
+	std::fill(m_minDepths[0].begin(), m_minDepths[0].end(), 1.0f);
+
+	for (size_t i = 0; i < m_occluders.size(); i++)
+	{
+		const OCCLUDER& occluder = m_occluders[i];
+		glm::mat4 transform = m_viewProjection * occluder.model;
+		glm::vec3 corners[8];
+		bool bInFront[8];
+
+		for (int c = 0; c < 8; c++)
+		{
+			glm::vec4 local(
+				(c & 1) ? occluder.maximum.x : occluder.minimum.x,
+				(c & 2) ? occluder.maximum.y : occluder.minimum.y,
+				(c & 4) ? occluder.maximum.z : occluder.minimum.z,
+				1.0f);
+			glm::vec4 clip = transform * local;
+
+			bInFront[c] = (clip.w > g_MinClipW);
+			if (bInFront[c] == true)
+			{
+				corners[c] = glm::vec3(
+					((clip.x / clip.w) * 0.5f + 0.5f) * g_DepthWidth,
+					((clip.y / clip.w) * 0.5f + 0.5f) * g_DepthHeight,
+					(clip.z / clip.w) * 0.5f + 0.5f);
+			}
+		}
+
+		for (int t = 0; t < 12; t++)
+		{
+			const int* pTriangle = g_BoxTriangles[t];
+			if ((bInFront[pTriangle[0]] == true) && (bInFront[pTriangle[1]] == true) && (bInFront[pTriangle[2]] == true))
+			{
+				RasterizeTriangle(corners[pTriangle[0]], corners[pTriangle[1]], corners[pTriangle[2]]);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  RasterizeTriangle()
+ *
+ *  This method is used to draw a triangle into the depth
+ *  buffer, keeping the nearest depth of every pixel.  The
+ *  edge functions and the depth are evaluated at the pixel
+ *  centers, four neighbouring pixels at a time.
+ ***********************************************************/
+void OcclusionCuller::RasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2)
+{
+	float area = ((v1.x - v0.x) * (v2.y - v0.y)) - ((v1.y - v0.y) * (v2.x - v0.x));
+	if (fabsf(area) < 1e-6f)
+	{
+		return;
+	}
+	// both windings are drawn, so make the edge functions positive inside
+	if (area < 0.0f)
+	{
+		std::swap(v1, v2);
+		area = -area;
+	}
+
+	int minX = std::max((int)floorf(std::min(v0.x, std::min(v1.x, v2.x))), 0);
+	int maxX = std::min((int)ceilf(std::max(v0.x, std::max(v1.x, v2.x))), g_DepthWidth - 1);
+	int minY = std::max((int)floorf(std::min(v0.y, std::min(v1.y, v2.y))), 0);
+	int maxY = std::min((int)ceilf(std::max(v0.y, std::max(v1.y, v2.y))), g_DepthHeight - 1);
+	if ((minX > maxX) || (minY > maxY))
+	{
+		return;
+	}
+	minX &= ~3;
+
+	m_stats.triangles++;
+
+	// the edge function of each edge, as a * x + b * y + c, is the
+	// weight of the vertex that is opposite of the edge
+	const glm::vec3 edgeStart[3] = { v1, v2, v0 };
+	const glm::vec3 edgeEnd[3] = { v2, v0, v1 };
+	float edgeA[3];
+	float edgeB[3];
+	float edgeC[3];
+	for (int e = 0; e < 3; e++)
+	{
+		edgeA[e] = edgeStart[e].y - edgeEnd[e].y;
+		edgeB[e] = edgeEnd[e].x - edgeStart[e].x;
+		edgeC[e] = -((edgeA[e] * edgeStart[e].x) + (edgeB[e] * edgeStart[e].y));
+	}
+
+	// the depth is a plane in screen space as well
+	float inverseArea = 1.0f / area;
+	float depthA = ((edgeA[0] * v0.z) + (edgeA[1] * v1.z) + (edgeA[2] * v2.z)) * inverseArea;
+	float depthB = ((edgeB[0] * v0.z) + (edgeB[1] * v1.z) + (edgeB[2] * v2.z)) * inverseArea;
+	float depthC = ((edgeC[0] * v0.z) + (edgeC[1] * v1.z) + (edgeC[2] * v2.z)) * inverseArea;
+
+	std::vector<float>& depth = m_minDepths[0];
+
+#if defined(OCCLUSION_CULLER_SSE)
+	const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		__m128 pixelY = _mm_set1_ps((float)y + 0.5f);
+		float* pRow = &depth[(size_t)y * g_DepthWidth];
+
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+			for (int e = 0; e < 3; e++)
+			{
+				__m128 weight = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[e]), pixelX), _mm_mul_ps(_mm_set1_ps(edgeB[e]), pixelY)),
+					_mm_set1_ps(edgeC[e]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(weight, zero));
+			}
+
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 triangleDepth = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), pixelX), _mm_mul_ps(_mm_set1_ps(depthB), pixelY)),
+				_mm_set1_ps(depthC));
+			__m128 oldDepth = _mm_loadu_ps(pRow + x);
+			__m128 newDepth = _mm_min_ps(oldDepth, triangleDepth);
+
+			_mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, newDepth), _mm_andnot_ps(inside, oldDepth)));
+		}
+	}
+#else
+	for (int y = minY; y <= maxY; y++)
+	{
+		float pixelY = (float)y + 0.5f;
+		float* pRow = &depth[(size_t)y * g_DepthWidth];
+
+		for (int x = minX; (x <= maxX) && (x < g_DepthWidth); x++)
+		{
+			float pixelX = (float)x + 0.5f;
+			bool bInside = true;
+
+			for (int e = 0; e < 3; e++)
+			{
+				if (((edgeA[e] * pixelX) + (edgeB[e] * pixelY) + edgeC[e]) < 0.0f)
+				{
+					bInside = false;
+				}
+			}
+
+			if (bInside == true)
+			{
+				pRow[x] = std::min(pRow[x], (depthA * pixelX) + (depthB * pixelY) + depthC);
+			}
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  BuildPyramid()
+ *
+ *  This method is used to build each level of the depth
+ *  pyramid from the nearest and farthest depth of 2x2
+ *  texels of the level below it.
+ ***********************************************************/
+void OcclusionCuller::BuildPyramid()
+{
+	m_maxDepths[0] = m_minDepths[0];
+
+	int sourceWidth = g_DepthWidth;
+	int sourceHeight = g_DepthHeight;
+	for (size_t level = 1; level < m_minDepths.size(); level++)
+	{
+		int width = std::max(sourceWidth / 2, 1);
+		int height = std::max(sourceHeight / 2, 1);
+		const std::vector<float>& sourceMin = m_minDepths[level - 1];
+		const std::vector<float>& sourceMax = m_maxDepths[level - 1];
+
+		for (int y = 0; y < height; y++)
+		{
+			int y0 = std::min(y * 2, sourceHeight - 1);
+			int y1 = std::min((y * 2) + 1, sourceHeight - 1);
+
+			for (int x = 0; x < width; x++)
+			{
+				int x0 = std::min(x * 2, sourceWidth - 1);
+				int x1 = std::min((x * 2) + 1, sourceWidth - 1);
+				size_t i00 = ((size_t)y0 * sourceWidth) + x0;
+				size_t i01 = ((size_t)y0 * sourceWidth) + x1;
+				size_t i10 = ((size_t)y1 * sourceWidth) + x0;
+				size_t i11 = ((size_t)y1 * sourceWidth) + x1;
+
+				m_minDepths[level][((size_t)y * width) + x] =
+					std::min(std::min(sourceMin[i00], sourceMin[i01]), std::min(sourceMin[i10], sourceMin[i11]));
+				m_maxDepths[level][((size_t)y * width) + x] =
+					std::max(std::max(sourceMax[i00], sourceMax[i01]), std::max(sourceMax[i10], sourceMax[i11]));
+			}
+		}
+
+		sourceWidth = width;
+		sourceHeight = height;
+	}
+}
+
+/***********************************************************
+ *  TestBounds()
+ *
+ *  This method is used to test a world space bounding box
+ *  against the depth pyramid.  The level is chosen so the
+ *  screen rectangle of the box covers at most 2x2 texels.
+ *  The box is hidden when every covered texel is nearer
+ *  than the box at its farthest, and visible when one is
+ *  farther than the box at its nearest.  Otherwise the
+ *  finer levels are tried, and boxes that are still
+ *  undecided after them are drawn.
+ ***********************************************************/
+bool OcclusionCuller::TestBounds(const glm::vec3& center, const glm::vec3& extents)
+{
+	if (m_bDepthValid == false)
+	{
+		return(true);
+	}
+
+	m_stats.tested++;
+
+	float minX = 0.0f;
+	float maxX = 0.0f;
+	float minY = 0.0f;
+	float maxY = 0.0f;
+	float nearest = 1.0f;
+
+	for (int c = 0; c < 8; c++)
+	{
+		glm::vec4 corner(
+			center.x + ((c & 1) ? extents.x : -extents.x),
+			center.y + ((c & 2) ? extents.y : -extents.y),
+			center.z + ((c & 4) ? extents.z : -extents.z),
+			1.0f);
+		glm::vec4 clip = m_viewProjection * corner;
+
+		// boxes that reach behind the camera are always drawn
+		if (clip.w <= g_MinClipW)
+		{
+			return(true);
+		}
+
+		float x = ((clip.x / clip.w) * 0.5f + 0.5f) * g_DepthWidth;
+		float y = ((clip.y / clip.w) * 0.5f + 0.5f) * g_DepthHeight;
+		float z = (clip.z / clip.w) * 0.5f + 0.5f;
+
+		minX = (c == 0) ? x : std::min(minX, x);
+		maxX = (c == 0) ? x : std::max(maxX, x);
+		minY = (c == 0) ? y : std::min(minY, y);
+		maxY = (c == 0) ? y : std::max(maxY, y);
+		nearest = std::min(nearest, z);
+	}
+
+	// boxes outside of the screen are left to the frustum culling
+	if ((maxX < 0.0f) || (maxY < 0.0f) || (minX >= (float)g_DepthWidth) || (minY >= (float)g_DepthHeight))
+	{
+		return(true);
+	}
+
+	int x0 = std::max((int)minX, 0);
+	int x1 = std::min((int)maxX, g_DepthWidth - 1);
+	int y0 = std::max((int)minY, 0);
+	int y1 = std::min((int)maxY, g_DepthHeight - 1);
+
+	int topLevel = (int)m_minDepths.size() - 1;
+	int level = 0;
+	while ((level < topLevel) &&
+		((((x1 >> level) - (x0 >> level)) > 1) || (((y1 >> level) - (y0 >> level)) > 1)))
+	{
+		level++;
+	}
+
+	for (int l = level; l >= std::max(level - g_RefineLevels, 0); l--)
+	{
+		int width = std::max(g_DepthWidth >> l, 1);
+		int height = std::max(g_DepthHeight >> l, 1);
+		bool bAllNearer = true;
+		bool bAnyFarther = false;
+
+		for (int ty = std::min(y0 >> l, height - 1); ty <= std::min(y1 >> l, height - 1); ty++)
+		{
+			for (int tx = std::min(x0 >> l, width - 1); tx <= std::min(x1 >> l, width - 1); tx++)
+			{
+				size_t index = ((size_t)ty * width) + tx;
+				if (m_maxDepths[l][index] >= nearest)
+				{
+					bAllNearer = false;
+				}
+				if (m_minDepths[l][index] >= nearest)
+				{
+					bAnyFarther = true;
+				}
+			}
+		}
+
+		if (bAllNearer == true)
+		{
+			m_stats.occluded++;
+			return(false);
+		}
+		if (bAnyFarther == true)
+		{
+			return(true);
+		}
+	}
+
+	return(true);
+}
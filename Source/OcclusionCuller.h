@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// hide the scene objects that are behind large occluders, on the CPU
+//
+// A few designated occluder boxes are rasterized into a small depth buffer,
+// four pixels at a time with SSE, and a pyramid of the nearest and farthest
+// depth of every 2x2 block is built on top of it.  An object is occluded when
+// the nearest point of its bounding box is behind the farthest occluder depth
+// over the whole screen rectangle it covers.  The rasterization runs on a
+// worker thread, so it overlaps with the rest of the frame preparation while
+// the GPU is still busy with the previous frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  OcclusionCuller
+ *
+ *  This class contains the code for rasterizing occluders
+ *  into a hierarchical depth buffer and testing bounding
+ *  boxes against it.
+ ***********************************************************/
+class OcclusionCuller
+{
+public:
+	// a solid box that hides what is behind it, given as the
+	// local bounds of a mesh and its world matrix
+	struct OCCLUDER
+	{
+		glm::mat4 model;
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	// counters for the last culled frame
+	struct STATS
+	{
+		int occluders;		// occluder boxes rasterized
+		int triangles;		// occluder triangles rasterized
+		int tested;			// bounding boxes tested against the depth
+		int occluded;		// bounding boxes hidden by the occluders
+	};
+
+	// constructor, starts the worker thread
+	OcclusionCuller();
+	// destructor, stops the worker thread
+	~OcclusionCuller();
+
+	// start rasterizing the passed in occluders on the worker thread
+	void BeginRasterize(
+		const glm::mat4& viewProjection,
+		const std::vector<OCCLUDER>& occluders);
+	// wait until the depth pyramid for the last occluders is built
+	void WaitForRasterize();
+
+	// test a world space bounding box against the depth pyramid,
+	// returns false when the box is hidden by the occluders
+	bool TestBounds(const glm::vec3& center, const glm::vec3& extents);
+
+	// get the counters for the last culled frame
+	const STATS& GetStats() const { return m_stats; }
+
+private:
+	// view projection matrix and occluders of the current frame
+	glm::mat4 m_viewProjection;
+	std::vector<OCCLUDER> m_occluders;
+	// nearest and farthest depth of each level, level 0 is
+	// the rasterized depth buffer
+	std::vector<std::vector<float> > m_minDepths;
+	std::vector<std::vector<float> > m_maxDepths;
+	// the pyramid was built for the current frame
+	bool m_bDepthValid;
+	// counters for the last culled frame
+	STATS m_stats;
+
+	// worker thread and its synchronization
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_jobCondition;
+	std::condition_variable m_doneCondition;
+	bool m_bJobPending;
+	bool m_bStopping;
+
+	// wait for jobs and run them on the worker thread
+	void WorkerLoop();
+	// rasterize the occluders into the depth buffer
+	void RasterizeOccluders();
+	// rasterize one triangle given in pixel coordinates and depth
+	void RasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2);
+	// build the coarser levels of the depth pyramid
+	void BuildPyramid();
+};
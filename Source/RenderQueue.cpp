@@ -0,0 +1,300 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// collect, sort and submit the draw packets for one frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// number of bits for the mesh and texture fields in the sort key
+	const int g_StateBits = 8;
+	const uint64_t g_StateMask = (1u << g_StateBits) - 1;
+	// the material field is wider, so hundreds of materials still sort
+	const int g_MaterialBits = 16;
+	const uint64_t g_MaterialMask = (1u << g_MaterialBits) - 1;
+	// total bits of the render state in the sort key
+	const int g_KeyStateBits = g_MaterialBits + (2 * g_StateBits);
+	// number of bits for the shader variant in the sort key, variant
+	// keys that do not fit only sort less well
+	const int g_VariantBits = 7;
+	const uint64_t g_VariantMask = (1u << g_VariantBits) - 1;
+	// number of bits for the quantized depth in the sort key
+	const int g_DepthBits = 24;
+	const uint64_t g_DepthMask = (1u << g_DepthBits) - 1;
+	// the transparent flag is the most significant bit, so all
+	// transparent packets are sorted after the opaque packets
+	const int g_TransparentShift = 63;
+	// the radix sort handles one byte of the key per pass
+	const int g_RadixBits = 8;
+	const int g_RadixBuckets = 1 << g_RadixBits;
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+	m_maxDepth = 100.0f;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used to start collecting the packets
+ *  for a new frame.
+ ***********************************************************/
+void RenderQueue::Begin(float maxDepth)
+{
+	m_packets.clear();
+	m_keys.clear();
+	m_order.clear();
+	m_maxDepth = (maxDepth > 0.0f) ? maxDepth : 1.0f;
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used to add a draw packet to the queue.
+ ***********************************************************/
+void RenderQueue::Submit(const DRAW_PACKET& packet)
+{
+	m_order.push_back((uint32_t)m_packets.size());
+	m_keys.push_back(MakeSortKey(packet));
+	m_packets.push_back(packet);
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method is used to build the 64-bit sort key for
+ *  a packet.  Opaque keys put the render state in the
+ *  high bits and the depth below it, so that packets are
+ *  grouped by state and drawn front-to-back in each group.
+ *  The shader variant is the most significant state, since
+ *  switching the program is the most expensive change.
+ *  The texture layer and the material are read by the
+ *  shaders for each draw, so they are only sorted below
+ *  the mesh to keep the draws of the same mesh together.
+ *  The mesh field holds the mesh and its level of detail,
+ *  so the draws of the same level are neighbours.
+ *  Transparent keys put the inverted depth first, so they
+ *  are drawn back-to-front.
+ *
+ *    opaque:      0 | variant:7 | mesh:8 | texture:8 | material:16 | depth:24
+ *    transparent: 1 | ~depth:24 | variant:7 | mesh:8 | texture:8 | material:16
+ ***********************************************************/
+uint64_t RenderQueue::MakeSortKey(const DRAW_PACKET& packet) const
+{
+	// slot and index of -1 (no texture or material) sort first
+	uint64_t material = (uint64_t)(packet.materialID + 1) & g_MaterialMask;
+	uint64_t texture = (uint64_t)(packet.textureSlot + 1) & g_StateMask;
+	uint64_t mesh = (uint64_t)((packet.meshID * ShapeMeshes::MESH_LOD_COUNT) + packet.meshLod) & g_StateMask;
+
+	float normalizedDepth = packet.depth / m_maxDepth;
+	if (normalizedDepth < 0.0f) normalizedDepth = 0.0f;
+	if (normalizedDepth > 1.0f) normalizedDepth = 1.0f;
+	uint64_t depth = (uint64_t)(normalizedDepth * (float)g_DepthMask) & g_DepthMask;
+
+	uint64_t variant = (uint64_t)packet.shaderVariant & g_VariantMask;
+
+	uint64_t state = (mesh << (g_StateBits + g_MaterialBits)) | (texture << g_MaterialBits) | material;
+
+	if (packet.bTransparent == true)
+	{
+		return ((uint64_t)1 << g_TransparentShift) |
+			((g_DepthMask - depth) << (g_KeyStateBits + g_VariantBits)) |
+			(variant << g_KeyStateBits) | state;
+	}
+
+	return (variant << (g_KeyStateBits + g_DepthBits)) | (state << g_DepthBits) | depth;
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used to sort the queued packets.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	if (m_order.size() > 1)
+	{
+		RadixSort();
+	}
+}
+
+/***********************************************************
+ *  RadixSort()
+ *
+ *  This method sorts the packet order by the sort keys, one
+ *  byte per pass from the least significant byte up.  Each
+ *  pass is stable, and passes where every key has the same
+ *  byte value are skipped.
+ ***********************************************************/
+void RenderQueue::RadixSort()
+{
+	const size_t count = m_order.size();
+	m_scratch.resize(count);
+
+	uint32_t* pSource = &m_order[0];
+	uint32_t* pDestination = &m_scratch[0];
+
+	for (int shift = 0; shift < 64; shift += g_RadixBits)
+	{
+		size_t histogram[g_RadixBuckets];
+		memset(histogram, 0, sizeof(histogram));
+
+		for (size_t i = 0; i < count; i++)
+		{
+			histogram[(m_keys[pSource[i]] >> shift) & (g_RadixBuckets - 1)]++;
+		}
+
+		// skip the pass when all keys fall into the same bucket
+		if (histogram[(m_keys[pSource[0]] >> shift) & (g_RadixBuckets - 1)] == count)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < g_RadixBuckets; bucket++)
+		{
+			size_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t index = pSource[i];
+			pDestination[histogram[(m_keys[index] >> shift) & (g_RadixBuckets - 1)]++] = index;
+		}
+
+		uint32_t* pSwap = pSource;
+		pSource = pDestination;
+		pDestination = pSwap;
+	}
+
+	// the sorted order ends up in the scratch buffer after an odd
+	// number of passes
+	if (pSource != &m_order[0])
+	{
+		memcpy(&m_order[0], pSource, count * sizeof(uint32_t));
+	}
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used to submit the sorted packets to
+ *  the passed in executor, in batches of neighbouring
+ *  packets that can be drawn with a single call.
+ ***********************************************************/
+void RenderQueue::Flush(Executor& executor)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_stats.packets = (int)m_packets.size();
+
+	// the sorting is measured by the state changes of the packets
+	// in the order they were queued and in the sorted order
+	m_stats.unsortedStateChanges = CountStateChanges(false);
+	m_stats.sortedStateChanges = CountStateChanges(true);
+	m_stats.stateChangesAvoided = m_stats.unsortedStateChanges - m_stats.sortedStateChanges;
+
+	// split the sorted packets into batches of neighbours that
+	// share their state, each batch is drawn with a single call
+	m_sorted.clear();
+	m_batchStarts.clear();
+	for (size_t i = 0; i < m_order.size(); i++)
+	{
+		const DRAW_PACKET* pPacket = &m_packets[m_order[i]];
+
+		if (m_sorted.empty() || IsStateChange(*m_sorted.back(), *pPacket))
+		{
+			m_batchStarts.push_back(m_sorted.size());
+		}
+		m_sorted.push_back(pPacket);
+	}
+	m_stats.batches = (int)m_batchStarts.size();
+	m_batchStarts.push_back(m_sorted.size());
+
+	// collect and upload the draws of all batches before drawing
+	for (int b = 0; b < m_stats.batches; b++)
+	{
+		executor.PrepareBatch(&m_sorted[m_batchStarts[b]], m_batchStarts[b + 1] - m_batchStarts[b]);
+	}
+	executor.SubmitBatches();
+
+	int lastMesh = -1;
+	long long lastVariant = -1;
+	for (int b = 0; b < m_stats.batches; b++)
+	{
+		if ((long long)m_sorted[m_batchStarts[b]]->shaderVariant != lastVariant)
+		{
+			lastVariant = (long long)m_sorted[m_batchStarts[b]]->shaderVariant;
+			m_stats.programChanges++;
+		}
+
+		for (size_t i = m_batchStarts[b]; i < m_batchStarts[b + 1]; i++)
+		{
+			if ((int)m_sorted[i]->meshID != lastMesh)
+			{
+				lastMesh = (int)m_sorted[i]->meshID;
+				m_stats.meshChanges++;
+			}
+		}
+
+		executor.DrawBatch(b);
+	}
+}
+
+/***********************************************************
+ *  CountStateChanges()
+ *
+ *  This method is used to count the state changes that
+ *  drawing the packets one by one would need, with a
+ *  texture bind for each texture, in the order they were
+ *  queued or in the sorted order.
+ ***********************************************************/
+int RenderQueue::CountStateChanges(bool bSorted) const
+{
+	int changes = 0;
+	int lastTexture = -2;
+	int lastMesh = -1;
+	long long lastVariant = -1;
+
+	for (size_t i = 0; i < m_packets.size(); i++)
+	{
+		const DRAW_PACKET& packet = m_packets[(bSorted == true) ? m_order[i] : i];
+		if (packet.textureSlot != lastTexture) changes++;
+		if ((int)packet.meshID != lastMesh) changes++;
+		if ((long long)packet.shaderVariant != lastVariant) changes++;
+		lastTexture = packet.textureSlot;
+		lastMesh = (int)packet.meshID;
+		lastVariant = (long long)packet.shaderVariant;
+	}
+
+	return(changes);
+}
+
+/***********************************************************
+ *  IsStateChange()
+ *
+ *  This method is used to check whether two neighbouring
+ *  packets need different state.  The texture and the
+ *  material do not count, because every draw carries its
+ *  own texture layer and material id.  Packets without a
+ *  texture are drawn with the color of their batch, so a
+ *  change of color starts a new batch, and every batch is
+ *  drawn with one shader variant.
+ ***********************************************************/
+bool RenderQueue::IsStateChange(const DRAW_PACKET& previous, const DRAW_PACKET& packet)
+{
+	return((previous.color != packet.color) || (previous.shaderVariant != packet.shaderVariant));
+}
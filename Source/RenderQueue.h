@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// collect, sort and submit the draw packets for one frame
+//
+// Draw packets are sorted with a 64-bit key so that opaque objects are grouped
+// by their render state and drawn front-to-back within each group, and
+// transparent objects are drawn back-to-front after all opaque objects.
+// When the queue is flushed, neighbouring packets that share their state are
+// grouped into batches that the executor can draw with a single call.  The
+// textures are layers of one array texture that every draw can select from,
+// so only the shader variant and the color of untextured draws separate the
+// batches.  The variant is the most significant state, so each program is
+// switched to once per frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeMeshes.h"
+#include "MaterialTable.h"
+
+#include <vector>
+#include <cstdint>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class contains the code for sorting the draw
+ *  packets of a frame and submitting the state deltas.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// everything needed to draw one object, or one
+	// instanced batch of objects
+	struct DRAW_PACKET
+	{
+		ShapeMeshes::MeshID meshID;
+		unsigned int meshParts;		// ShapeMeshes::MeshPart flags
+		int meshLod;				// level of detail of the mesh
+		int textureSlot;			// texture array layer, -1 draws with the color
+		unsigned int shaderVariant;	// ShaderManager variant key
+		MaterialId materialID;
+		glm::mat4 model;
+		glm::vec2 uvScale;
+		glm::vec4 color;
+		float depth;				// view space distance from the camera
+		bool bTransparent;
+		const ShapeMeshes::InstanceData* pInstances;	// instance batch, or NULL
+		GLsizei nInstances;
+	};
+
+	// counters for the last flushed frame
+	struct STATS
+	{
+		int packets;				// draw packets submitted
+		int batches;				// batches of packets sharing their state
+		int meshChanges;			// mesh switches between packets
+		int programChanges;			// shader variant switches between batches
+		int unsortedStateChanges;	// state changes submission order would need
+		int sortedStateChanges;		// state changes the sorted order needs
+		int stateChangesAvoided;	// unsorted minus sorted state changes
+	};
+
+	// receives the batches while the queue is flushed, every
+	// batch is prepared before any of the batches are drawn
+	class Executor
+	{
+	public:
+		virtual ~Executor() {}
+		// collect the draws for a batch of packets that share their state
+		virtual void PrepareBatch(const DRAW_PACKET* const* ppPackets, size_t nPackets) = 0;
+		// upload the draws that were collected for all of the batches
+		virtual void SubmitBatches() = 0;
+		// draw a prepared batch
+		virtual void DrawBatch(size_t batchIndex) = 0;
+	};
+
+	// constructor
+	RenderQueue();
+
+	// start collecting the packets for a new frame, depths are
+	// quantized over the range from zero to the passed in depth
+	void Begin(float maxDepth);
+	// add a draw packet to the queue
+	void Submit(const DRAW_PACKET& packet);
+	// sort the queued packets by their sort keys
+	void Sort();
+	// submit the sorted packets in batches of shared state
+	void Flush(Executor& executor);
+
+	// get the counters for the last flushed frame
+	const STATS& GetStats() const { return m_stats; }
+
+private:
+	// the draw packets in submission order
+	std::vector<DRAW_PACKET> m_packets;
+	// sort key for each packet
+	std::vector<uint64_t> m_keys;
+	// packet indices in sorted order, plus scratch space for sorting
+	std::vector<uint32_t> m_order;
+	std::vector<uint32_t> m_scratch;
+	// the packets in sorted order, and the start of each batch
+	std::vector<const DRAW_PACKET*> m_sorted;
+	std::vector<size_t> m_batchStarts;
+	// depth range used for quantizing the packet depths
+	float m_maxDepth;
+	// counters for the last flushed frame
+	STATS m_stats;
+
+	// build the sort key for the passed in packet
+	uint64_t MakeSortKey(const DRAW_PACKET& packet) const;
+	// least significant digit radix sort of the packet order
+	void RadixSort();
+	// true when the two packets cannot be drawn in the same batch
+	static bool IsStateChange(const DRAW_PACKET& previous, const DRAW_PACKET& packet);
+	// count the texture, mesh and shader variant changes of the
+	// packets in submission order or in sorted order
+	int CountStateChanges(bool bSorted) const;
+};
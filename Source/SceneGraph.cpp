@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.cpp
+// ============
+// retained store of the scene nodes and their transformations
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneGraph.h"
+
+#include <glm/gtx/transform.hpp>
+
+/***********************************************************
+ *  SceneGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneGraph::SceneGraph()
+{
+	m_bAnyDirty = false;
+	m_lastUpdateCount = 0;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used to remove all of the nodes.
+ ***********************************************************/
+void SceneGraph::Clear()
+{
+	m_parents.clear();
+	m_scales.clear();
+	m_rotations.clear();
+	m_positions.clear();
+	m_localMatrices.clear();
+	m_worldMatrices.clear();
+	m_dirty.clear();
+	m_updated.clear();
+	m_bAnyDirty = false;
+	m_lastUpdateCount = 0;
+}
+
+/***********************************************************
+ *  CreateNode()
+ *
+ *  This method is used to create a new node.  Because a
+ *  parent is always created before its children, the
+ *  world matrices can be updated in a single pass over
+ *  the nodes in creation order.
+ ***********************************************************/
+NodeID SceneGraph::CreateNode(
+	NodeID parent,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	NodeID node = (NodeID)m_parents.size();
+
+	if ((parent < 0) || (parent >= node))
+	{
+		parent = INVALID_NODE;
+	}
+
+	m_parents.push_back(parent);
+	m_scales.push_back(scaleXYZ);
+	m_rotations.push_back(glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees));
+	m_positions.push_back(positionXYZ);
+	m_localMatrices.push_back(glm::mat4(1.0f));
+	m_worldMatrices.push_back(glm::mat4(1.0f));
+	m_dirty.push_back(1);
+	m_updated.push_back(0);
+	m_bAnyDirty = true;
+
+	return(node);
+}
+
+/***********************************************************
+ *  SetLocalTransform()
+ *
+ *  This method is used to change the local transformation
+ *  of a node and flag it for the next update.
+ ***********************************************************/
+void SceneGraph::SetLocalTransform(
+	NodeID node,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((node < 0) || (node >= GetNodeCount()))
+	{
+		return;
+	}
+
+	m_scales[node] = scaleXYZ;
+	m_rotations[node] = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	m_positions[node] = positionXYZ;
+	MarkDirty(node);
+}
+
+/***********************************************************
+ *  SetLocalPosition()
+ *
+ *  This method is used to move a node and flag it for
+ *  the next update.
+ ***********************************************************/
+void SceneGraph::SetLocalPosition(NodeID node, glm::vec3 positionXYZ)
+{
+	if ((node < 0) || (node >= GetNodeCount()))
+	{
+		return;
+	}
+
+	m_positions[node] = positionXYZ;
+	MarkDirty(node);
+}
+
+/***********************************************************
+ *  MarkDirty()
+ *
+ *  This method is used to flag a node for the next update.
+ ***********************************************************/
+void SceneGraph::MarkDirty(NodeID node)
+{
+	if ((node < 0) || (node >= GetNodeCount()))
+	{
+		return;
+	}
+
+	m_dirty[node] = 1;
+	m_bAnyDirty = true;
+}
+
+/***********************************************************
+ *  UpdateWorldTransforms()
+ *
+ *  This method is used to recompute the matrices of the
+ *  dirty nodes.  A node whose parent was recomputed in
+ *  this pass inherits the change, so moving a parent
+ *  updates its whole subtree and nothing else.
+ ***********************************************************/
+int SceneGraph::UpdateWorldTransforms()
+{
+	m_lastUpdateCount = 0;
+
+	// nothing has changed, which is every frame of a static scene
+	if (m_bAnyDirty == false)
+	{
+		return(0);
+	}
+
+	const int nodeCount = GetNodeCount();
+	for (int i = 0; i < nodeCount; i++)
+	{
+		NodeID parent = m_parents[i];
+		bool bParentUpdated = (parent != INVALID_NODE) && (m_updated[parent] != 0);
+
+		m_updated[i] = 0;
+		if ((m_dirty[i] == 0) && (bParentUpdated == false))
+		{
+			continue;
+		}
+
+		if (m_dirty[i] != 0)
+		{
+			m_localMatrices[i] = ComposeTransform(
+				m_scales[i],
+				m_rotations[i].x,
+				m_rotations[i].y,
+				m_rotations[i].z,
+				m_positions[i]);
+			m_dirty[i] = 0;
+		}
+
+		if (parent != INVALID_NODE)
+		{
+			m_worldMatrices[i] = m_worldMatrices[parent] * m_localMatrices[i];
+		}
+		else
+		{
+			m_worldMatrices[i] = m_localMatrices[i];
+		}
+
+		m_updated[i] = 1;
+		m_lastUpdateCount++;
+	}
+
+	m_bAnyDirty = false;
+
+	return(m_lastUpdateCount);
+}
+
+/***********************************************************
+ *  ComposeTransform()
+ *
+ *  This method is used to build the transformation matrix
+ *  for the passed in scale, rotation and position.
+ ***********************************************************/
+glm::mat4 SceneGraph::ComposeTransform(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	scale = glm::scale(scaleXYZ);
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	translation = glm::translate(positionXYZ);
+
+	return(translation * rotationX * rotationY * rotationZ * scale);
+}
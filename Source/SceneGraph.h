@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.h
+// ============
+// retained store of the scene nodes and their transformations
+//
+// Each node keeps its local scale, rotation and position.  The local and world
+// matrices are only recomputed when the node, or one of its parents, has been
+// marked dirty, so a static scene costs no matrix math per frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// identifies a node in the scene graph
+typedef int NodeID;
+const NodeID INVALID_NODE = -1;
+
+/***********************************************************
+ *  SceneGraph
+ *
+ *  This class contains the code for storing the scene
+ *  node hierarchy and updating the world matrices.
+ ***********************************************************/
+class SceneGraph
+{
+public:
+	// constructor
+	SceneGraph();
+
+	// remove all of the nodes
+	void Clear();
+
+	// create a node with the passed in local transformation, the
+	// parent must be created before any of its children
+	NodeID CreateNode(
+		NodeID parent,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// change the local transformation of a node
+	void SetLocalTransform(
+		NodeID node,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// change only the local position of a node
+	void SetLocalPosition(NodeID node, glm::vec3 positionXYZ);
+
+	// flag a node so its matrices, and the world matrices of
+	// all of its children, are recomputed on the next update
+	void MarkDirty(NodeID node);
+
+	// recompute the world matrices of the dirty nodes, returns
+	// the number of world matrices that were recomputed
+	int UpdateWorldTransforms();
+
+	// get the world matrix of a node from the last update
+	const glm::mat4& GetWorldMatrix(NodeID node) const { return m_worldMatrices[node]; }
+	// get the parent of a node
+	NodeID GetParent(NodeID node) const { return m_parents[node]; }
+	// get the number of nodes
+	int GetNodeCount() const { return (int)m_parents.size(); }
+	// get the number of world matrices recomputed by the last update
+	int GetLastUpdateCount() const { return m_lastUpdateCount; }
+	// check whether the world matrix of a node was recomputed by the
+	// last update, only meaningful when that update count is not zero
+	bool WasUpdated(NodeID node) const { return m_updated[node] != 0; }
+
+	// build the matrix for the passed in scale, rotation and position
+	static glm::mat4 ComposeTransform(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+private:
+	// node data, indexed by NodeID - parents always come first
+	std::vector<NodeID> m_parents;
+	std::vector<glm::vec3> m_scales;
+	std::vector<glm::vec3> m_rotations;		// degrees around X, Y and Z
+	std::vector<glm::vec3> m_positions;
+	std::vector<glm::mat4> m_localMatrices;
+	std::vector<glm::mat4> m_worldMatrices;
+	// the local transformation changed since the last update
+	std::vector<unsigned char> m_dirty;
+	// the world matrix was recomputed during the current update
+	std::vector<unsigned char> m_updated;
+	// at least one node is dirty
+	bool m_bAnyDirty;
+	// number of world matrices recomputed by the last update
+	int m_lastUpdateCount;
+};
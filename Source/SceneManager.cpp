@@ -16,14 +16,40 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <utility>
+
 // declaration of global variables
 namespace
 {
 	const char* g_ModelName = "model";
+	const char* g_ModelViewProjectionName = "modelViewProjection";
+	const char* g_NormalMatrixName = "normalMatrix";
 	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
+	const char* g_TextureValueName = "objectTextures";
+	const char* g_TextureLayerName = "textureLayer";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_PackedVerticesName = "bPackedVertices";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_MaterialIndexName = "materialIndex";
+	const char* g_ActiveLightsName = "activeLights";
+
+	// far plane distance of the view, used to quantize object depths
+	const float g_MaxSceneDepth = 100.0f;
+
+	// texture unit that the texture array is bound to
+	const GLuint g_TextureArrayUnit = 0;
+	// neutral grey shown on the objects whose texture is still loading
+	const unsigned char g_PlaceholderColor[4] = { 128, 128, 128, 255 };
+	// directory of the cooked textures, next to the cached meshes
+	const char* g_TextureCacheDirectory = "../../7-1_FinalProjectMilestones/Utilities/cache";
+
+	// screen size below which each coarser level of detail is used,
+	// as the bounding radius over the half height of the view
+	const float g_LodScreenSizes[] = { 0.25f, 0.1f, 0.04f };
+	// the size has to pass a threshold by this fraction before the
+	// level changes, so objects at the threshold do not flicker
+	const float g_LodHysteresis = 0.15f;
 }
 
 /***********************************************************
@@ -35,6 +61,34 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
 	m_basicMeshes = new ShapeMeshes();
+	m_bUseMeshCache = true;
+	m_bUseTextureCache = true;
+	m_bDeferredShading = false;
+	for (int i = 0; i < GPU_TIME_QUERY_COUNT; i++)
+	{
+		m_gpuTimeQueries[i] = 0;
+	}
+	m_gpuTimeQueryFrame = 0;
+	m_sceneGpuTime = 0.0;
+	m_lightBlock = LIGHT_BLOCK();
+	m_bLightsDirty = true;
+	m_lightCount = 0;
+	m_bUseLighting = false;
+	m_bPointLightsDirty = true;
+	m_mugNode = INVALID_NODE;
+	m_bBoundsDirty = true;
+	for (int lod = 0; lod < ShapeMeshes::MESH_LOD_COUNT; lod++)
+	{
+		m_lodCounts[lod] = 0;
+	}
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
+	{
+		m_indirectCommandOffsets[format] = 0;
+	}
+
+	// the shaders are still compiling while the scene is prepared,
+	// their uniforms are resolved in ConnectShaders()
+	m_bShadersConnected = false;
 }
 
 /***********************************************************
@@ -45,24 +99,82 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	DestroyGLTextures();
+	if (0 != m_gpuTimeQueries[0])
+	{
+		glDeleteQueries(GPU_TIME_QUERY_COUNT, m_gpuTimeQueries);
+	}
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
 }
 
+/***********************************************************
+ *  ResolveShaderUniforms()
+ *
+ *  This method is used for looking up the handles of the
+ *  shader uniforms that are set while rendering, so that
+ *  no uniform names need to be resolved for each draw.
+ ***********************************************************/
+void SceneManager::ResolveShaderUniforms()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	m_uniforms.model = m_pShaderManager->GetUniformHandle(g_ModelName);
+	m_uniforms.modelViewProjection = m_pShaderManager->GetUniformHandle(g_ModelViewProjectionName);
+	m_uniforms.normalMatrix = m_pShaderManager->GetUniformHandle(g_NormalMatrixName);
+	m_uniforms.objectColor = m_pShaderManager->GetUniformHandle(g_ColorValueName);
+	m_uniforms.objectTextures = m_pShaderManager->GetUniformHandle(g_TextureValueName);
+	m_uniforms.textureLayer = m_pShaderManager->GetUniformHandle(g_TextureLayerName);
+	m_uniforms.useLighting = m_pShaderManager->GetUniformHandle(g_UseLightingName);
+	m_uniforms.useInstancing = m_pShaderManager->GetUniformHandle(g_UseInstancingName);
+	m_uniforms.packedVertices = m_pShaderManager->GetUniformHandle(g_PackedVerticesName);
+	m_uniforms.UVscale = m_pShaderManager->GetUniformHandle(g_UVScaleName);
+	m_uniforms.materialIndex = m_pShaderManager->GetUniformHandle(g_MaterialIndexName);
+	m_uniforms.activeLights = m_pShaderManager->GetUniformHandle(g_ActiveLightsName);
+}
+
+/***********************************************************
+ *  ConnectShaders()
+ *
+ *  This method is called on the first frame, when the
+ *  generic shader variant is linked and in use, to resolve
+ *  the uniform handles and to set the uniforms that keep
+ *  their value for every frame.  The scene is prepared
+ *  before this, while the shaders are still being compiled.
+ *  The specialized variants need none of these uniforms.
+ ***********************************************************/
+void SceneManager::ConnectShaders()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ResolveShaderUniforms();
+
+	// the texture array stays bound to its unit while rendering
+	m_pShaderManager->setIntValue(m_uniforms.objectTextures, (int)g_TextureArrayUnit);
+	m_pShaderManager->setBoolValue(m_uniforms.useLighting, m_bUseLighting);
+
+	m_bShadersConnected = true;
+}
+
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for loading textures from image files
+ *  and adding them as the next layer of the texture array.
+ *  The images are resampled to the layer size, so there is
+ *  no limit on the size or the number of loaded textures.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
 	int width = 0;
 	int height = 0;
 	int colorChannels = 0;
-	GLuint textureID = 0;
 
 	// indicate to always flip images vertically when loaded
 	stbi_set_flip_vertically_on_load(true);
@@ -80,39 +192,18 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 	{
 		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
 
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+		int layer = m_textures.AddImage(image, width, height, colorChannels);
 
 		// free the image data from local memory
 		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+
+		if (layer < 0)
+		{
+			return false;
+		}
 
 		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+		m_textureLayers[tag] = layer;
 
 		return true;
 	}
@@ -124,120 +215,209 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 }
 
 /***********************************************************
- *  BindGLTextures()
+ *  LoadTextureAsync()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for starting to load a texture image
+ *  on a worker thread.  A layer filled with a placeholder
+ *  color is added right away and associated with the tag,
+ *  so objects can use the texture before it is loaded.
+ *  The decoded image replaces the placeholder in
+ *  UpdateTextures(), which runs on the rendering thread.
  ***********************************************************/
-void SceneManager::BindGLTextures()
+std::shared_future<bool> SceneManager::LoadTextureAsync(const char* filename, std::string tag)
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	PENDING_TEXTURE pending;
+	std::shared_future<bool> uploaded = pending.uploaded.get_future().share();
+
+	pending.layer = m_textures.AddSolidLayer(g_PlaceholderColor);
+	if (pending.layer < 0)
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		pending.uploaded.set_value(false);
+		return(uploaded);
 	}
-}
 
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
+	// register the texture and associate it with the special tag string
+	m_textureLayers[tag] = pending.layer;
+
+	if (m_pendingTextures.empty() == true)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		m_textureLoadStart = std::chrono::steady_clock::now();
 	}
+
+	pending.filename = filename;
+	pending.image = m_textureLoader.Decode(pending.filename, m_textures.GetLayerSize());
+	m_pendingTextures.push_back(std::move(pending));
+
+	return(uploaded);
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  UpdateTextures()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for uploading the texture images
+ *  that were decoded since the last call.  It does not
+ *  wait for the images that are still being decoded.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+void SceneManager::UpdateTextures()
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
+	if (m_pendingTextures.empty() == true)
+	{
+		return;
+	}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	bool bUploaded = false;
+	size_t i = 0;
+	while (i < m_pendingTextures.size())
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		PENDING_TEXTURE& pending = m_pendingTextures[i];
+		if (pending.image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			i++;
+			continue;
+		}
+
+		TextureLoader::DECODED_IMAGE image = pending.image.get();
+		bool bLoaded = false;
+		if (image.bLoaded == true)
+		{
+			bLoaded = (image.bCompressed == true) ?
+				m_textures.SetCompressedLayer(pending.layer, image.compressedLevels) :
+				m_textures.SetLayerPixels(pending.layer, &image.layerPixels[0]);
+		}
+
+		if (bLoaded == true)
 		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
+			std::cout << "Successfully loaded image:" << pending.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels
+				<< ((image.bFromCache == true) ? ", cooked" : "") << std::endl;
+			bUploaded = true;
 		}
 		else
-			index++;
+		{
+			// the placeholder stays in the layer
+			std::cout << "Could not load image:" << pending.filename << std::endl;
+		}
+
+		pending.uploaded.set_value(bLoaded);
+		m_pendingTextures.erase(m_pendingTextures.begin() + i);
+	}
+
+	if (bUploaded == true)
+	{
+		BindGLTextures();
+	}
+
+	if (m_pendingTextures.empty() == true)
+	{
+		const std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::steady_clock::now() - m_textureLoadStart;
+		std::cout << "INFO: Textures loaded in " << elapsed.count() << " ms on "
+			<< m_textureLoader.GetWorkerCount() << " worker threads" << std::endl;
 	}
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for generating the mipmaps of the
+ *  loaded textures and binding the texture array to its
+ *  texture unit.  The array stays bound while rendering,
+ *  since draws select their texture by the layer index.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	m_textures.GenerateMipmaps();
+	m_textures.Bind(g_TextureArrayUnit);
+}
 
-	return(textureID);
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory of all the
+ *  loaded textures.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	// the images that are still being decoded are dropped
+	m_pendingTextures.clear();
+	m_textures.Destroy();
+	m_textureLayers.clear();
 }
 
 /***********************************************************
  *  FindTextureSlot()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for getting the texture array layer
+ *  of the previously loaded texture bitmap associated with
+ *  the passed in tag.
  ***********************************************************/
 int SceneManager::FindTextureSlot(std::string tag)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	std::unordered_map<std::string, int>::const_iterator found = m_textureLayers.find(tag);
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	if (found == m_textureLayers.end())
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
+		return(-1);
 	}
 
-	return(textureSlot);
+	return(found->second);
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  DefineMaterial()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for adding a material to the
+ *  material table.  The returned id is what the scene
+ *  objects use to reference the material.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+MaterialId SceneManager::DefineMaterial(const OBJECT_MATERIAL& material)
 {
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
+	return(m_materials.AddMaterial(
+		material.tag,
+		material.ambientColor,
+		material.ambientStrength,
+		material.diffuseColor,
+		material.specularColor,
+		material.shininess));
+}
+
+/***********************************************************
+ *  CalculateTransformation()
+ *
+ *  This method is used for calculating the model matrix
+ *  from the passed in transformation values.
+ ***********************************************************/
+glm::mat4 SceneManager::CalculateTransformation(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	return(SceneGraph::ComposeTransform(
+		scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ));
+}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in model matrix.  The model view
+ *  projection and normal matrices are derived from it
+ *  here, once for the draw instead of for every vertex,
+ *  with the camera of the current frame, so it is called
+ *  after the view was prepared.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	const glm::mat4& model)
+{
+	if (NULL != m_pShaderManager)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
+		const FRAME_CONSTANTS& frame = m_pShaderManager->GetFrameConstants();
 
-	return(true);
+		m_pShaderManager->setMat4Value(m_uniforms.model, model);
+		m_pShaderManager->setMat4Value(m_uniforms.modelViewProjection, frame.projection * frame.view * model);
+		m_pShaderManager->setMat3Value(m_uniforms.normalMatrix, glm::transpose(glm::inverse(glm::mat3(model))));
+	}
 }
 
 /***********************************************************
@@ -255,27 +435,15 @@ void SceneManager::SetTransformations(
 {
 	// variables for this method
 	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
+	modelView = CalculateTransformation(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	SetTransformations(modelView);
 }
 
 /***********************************************************
@@ -300,8 +468,8 @@ void SceneManager::SetShaderColor(
 
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_pShaderManager->setIntValue(m_uniforms.textureLayer, -1);
+		m_pShaderManager->setVec4Value(m_uniforms.objectColor, currentColor);
 	}
 }
 
@@ -316,11 +484,9 @@ void SceneManager::SetShaderTexture(
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		int textureLayer = -1;
+		textureLayer = FindTextureSlot(textureTag);
+		m_pShaderManager->setIntValue(m_uniforms.textureLayer, textureLayer);
 	}
 }
 
@@ -334,7 +500,7 @@ void SceneManager::SetTextureUVScale(float u, float v)
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_pShaderManager->setVec2Value(m_uniforms.UVscale, glm::vec2(u, v));
 	}
 }
 
@@ -345,21 +511,305 @@ void SceneManager::SetTextureUVScale(float u, float v)
  *  into the shader.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	const std::string& materialTag)
+{
+	SetShaderMaterial(m_materials.FindMaterial(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the values of the
+ *  identified material into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	MaterialId materialID)
+{
+	if (m_materials.IsValid(materialID) == false)
+	{
+		return;
+	}
+
+	// the material values are already in the material buffer,
+	// so only the index of the material is passed to the shader
+	m_pShaderManager->setIntValue(m_uniforms.materialIndex, materialID);
+}
+
+/***********************************************************
+ *  UploadMaterials()
+ *
+ *  This method is used for uploading all of the defined
+ *  materials into the material storage buffer, where the
+ *  shaders read them by material id.
+ ***********************************************************/
+void SceneManager::UploadMaterials()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	std::vector<GPU_MATERIAL> gpuMaterials(m_materials.GetCount());
+	for (MaterialId id = 0; id < m_materials.GetCount(); id++)
+	{
+		GPU_MATERIAL& material = gpuMaterials[id];
+
+		material.ambientColor = m_materials.GetAmbientColor(id);
+		material.ambientStrength = m_materials.GetAmbientStrength(id);
+		material.diffuseColor = m_materials.GetDiffuseColor(id);
+		material.shininess = m_materials.GetShininess(id);
+		material.specularColor = m_materials.GetSpecularColor(id);
+		material.padding = 0.0f;
+	}
+
+	m_pShaderManager->UpdateMaterialBuffer(gpuMaterials.data(), (int)gpuMaterials.size());
+}
+
+/***********************************************************
+ *  BuildObjectPacket()
+ *
+ *  This method is used for building the draw packet of an
+ *  object.  The object is drawn once the packet is added
+ *  to the render queue and the queue is flushed.
+ ***********************************************************/
+void SceneManager::BuildObjectPacket(
+	ShapeMeshes::MeshID meshID,
+	unsigned int meshParts,
+	int meshLod,
+	const glm::mat4& model,
+	int textureSlot,
+	glm::vec2 uvScale,
+	MaterialId materialID,
+	RenderQueue::DRAW_PACKET& packet)
+{
+	packet.meshID = meshID;
+	packet.meshParts = meshParts;
+	packet.meshLod = meshLod;
+	packet.textureSlot = textureSlot;
+	packet.shaderVariant = GetShaderVariant(textureSlot, materialID);
+	packet.materialID = materialID;
+	packet.model = model;
+	packet.uvScale = uvScale;
+	packet.color = glm::vec4(1.0f);
+	packet.depth = CalculateViewDepth(glm::vec3(model[3]));
+	// a draw that is not fully opaque is blended back-to-front
+	packet.bTransparent = (packet.color.a < 1.0f);
+	packet.pInstances = NULL;
+	packet.nInstances = 0;
+}
+
+/***********************************************************
+ *  BuildInstancesPacket()
+ *
+ *  This method is used for building the draw packet of an
+ *  instanced batch of objects.  The transforms and UV
+ *  scales come from the passed in instance data.
+ ***********************************************************/
+bool SceneManager::BuildInstancesPacket(
+	ShapeMeshes::MeshID meshID,
+	unsigned int meshParts,
+	int meshLod,
+	const std::vector<ShapeMeshes::InstanceData>& instances,
+	int textureSlot,
+	MaterialId materialID,
+	RenderQueue::DRAW_PACKET& packet)
+{
+	if (instances.empty())
+	{
+		return(false);
+	}
+
+	packet.meshID = meshID;
+	packet.meshParts = meshParts;
+	packet.meshLod = meshLod;
+	packet.textureSlot = textureSlot;
+	packet.shaderVariant = GetShaderVariant(textureSlot, materialID);
+	packet.materialID = materialID;
+	packet.model = glm::mat4(1.0f);
+	packet.uvScale = glm::vec2(1.0f, 1.0f);
+	packet.color = glm::vec4(1.0f);
+	packet.depth = CalculateViewDepth(glm::vec3(instances[0].model[3]));
+	// a draw that is not fully opaque is blended back-to-front
+	packet.bTransparent = (packet.color.a < 1.0f);
+	packet.pInstances = instances.data();
+	packet.nInstances = (GLsizei)instances.size();
+
+	return(true);
+}
+
+/***********************************************************
+ *  CalculateViewDepth()
+ *
+ *  This method is used for calculating the distance from
+ *  the camera to the passed in point along the view axis.
+ ***********************************************************/
+float SceneManager::CalculateViewDepth(const glm::vec3& position) const
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(0.0f);
+	}
+
+	glm::vec4 viewPosition = m_pShaderManager->GetFrameConstants().view * glm::vec4(position, 1.0f);
+
+	// the camera looks down the negative Z axis in view space
+	return(-viewPosition.z);
+}
+
+/***********************************************************
+ *  PrepareBatch()
+ *
+ *  This method is called by the render queue to collect
+ *  the draws of a batch of packets that share their
+ *  shader variant and color.  Every packet becomes one or more indirect
+ *  draw commands, and its transform, material id and
+ *  texture layer go into the instance data that the
+ *  commands refer to.
+ ***********************************************************/
+void SceneManager::PrepareBatch(const RenderQueue::DRAW_PACKET* const* ppPackets, size_t nPackets)
+{
+	DRAW_BATCH batch;
+	int lastMesh = -1;
+	unsigned int lastParts = 0;
+	int lastLod = -1;
+	int lastCommandCount = 0;
+
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
+	{
+		batch.firstCommand[format] = (GLsizei)m_drawCommands[format].size();
+	}
+	batch.color = ppPackets[0]->color;
+	batch.shaderVariant = ppPackets[0]->shaderVariant;
+
+	for (size_t i = 0; i < nPackets; i++)
+	{
+		const RenderQueue::DRAW_PACKET& packet = *ppPackets[i];
+		GLuint baseInstance = (GLuint)m_drawInstances.size();
+		GLuint instanceCount = 0;
+
+		if (NULL != packet.pInstances)
+		{
+			m_drawInstances.insert(m_drawInstances.end(), packet.pInstances, packet.pInstances + packet.nInstances);
+			instanceCount = (GLuint)packet.nInstances;
+
+			// the texture of the packet applies to all of its instances
+			for (size_t n = baseInstance; n < m_drawInstances.size(); n++)
+			{
+				m_drawInstances[n].textureLayer = (float)packet.textureSlot;
+			}
+		}
+		else
+		{
+			ShapeMeshes::InstanceData instance;
+
+			instance.model = packet.model;
+			instance.uvScale = packet.uvScale;
+			instance.materialIndex = (float)packet.materialID;
+			instance.textureLayer = (float)packet.textureSlot;
+			m_drawInstances.push_back(instance);
+			instanceCount = 1;
+		}
+
+		// the meshes of each vertex format are drawn from their own
+		// vertex array, so their commands are kept apart
+		std::vector<ShapeMeshes::DrawElementsIndirectCommand>& commands =
+			m_drawCommands[m_basicMeshes->GetMeshVertexFormat(packet.meshID)];
+
+		// the instance data of neighbouring packets that draw the same
+		// mesh parts is contiguous, so the previous commands only need
+		// more instances instead of new commands
+		if (((int)packet.meshID == lastMesh) && (packet.meshParts == lastParts) &&
+			(packet.meshLod == lastLod))
+		{
+			for (size_t c = commands.size() - lastCommandCount; c < commands.size(); c++)
+			{
+				commands[c].instanceCount += instanceCount;
+			}
+		}
+		else
+		{
+			lastCommandCount = m_basicMeshes->AddDrawCommands(packet.meshID, packet.meshParts,
+				packet.meshLod, instanceCount, baseInstance, commands);
+			lastMesh = (int)packet.meshID;
+			lastParts = packet.meshParts;
+			lastLod = packet.meshLod;
+		}
+	}
+
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
+	{
+		batch.nCommands[format] = (GLsizei)m_drawCommands[format].size() - batch.firstCommand[format];
+	}
+	m_drawBatches.push_back(batch);
+}
+
+/***********************************************************
+ *  SubmitBatches()
+ *
+ *  This method is called by the render queue to upload
+ *  the draw commands and instance data of all batches.
+ *  The model view projection and normal matrices of each
+ *  instance are computed once here, and the instances
+ *  are written straight into the mapped instance ring.
+ *  The commands of the vertex formats are uploaded one
+ *  after another into the same indirect buffer.
+ ***********************************************************/
+void SceneManager::SubmitBatches()
 {
-	if (m_objectMaterials.size() > 0)
+	const FRAME_CONSTANTS& frame = m_pShaderManager->GetFrameConstants();
+	const glm::mat4 viewProjection = frame.projection * frame.view;
+
+	ShapeMeshes::InstanceData* pInstances =
+		m_basicMeshes->MapInstanceData((GLsizei)m_drawInstances.size());
+	if (NULL != pInstances)
+	{
+		for (size_t i = 0; i < m_drawInstances.size(); i++)
+		{
+			// the mapped memory is only written, reading it back
+			// would be slow, so the matrices are set in the copy
+			ShapeMeshes::SetInstanceTransforms(m_drawInstances[i], viewProjection);
+			pInstances[i] = m_drawInstances[i];
+		}
+	}
+
+	m_indirectCommands.clear();
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		m_indirectCommandOffsets[format] = (GLsizei)m_indirectCommands.size();
+		m_indirectCommands.insert(m_indirectCommands.end(),
+			m_drawCommands[format].begin(), m_drawCommands[format].end());
+	}
+
+	m_basicMeshes->UploadIndirectDraws(
+		m_indirectCommands.data(), (GLsizei)m_indirectCommands.size());
+}
+
+/***********************************************************
+ *  DrawBatch()
+ *
+ *  This method is called by the render queue to draw a
+ *  batch with its shader variant and color, with one call
+ *  for the meshes of each vertex format.  The batches are
+ *  sorted by variant, so the program is only switched
+ *  between the groups of batches.  Uniform values belong
+ *  to a program, so the ones of the batch are always set.
+ ***********************************************************/
+void SceneManager::DrawBatch(size_t batchIndex)
+{
+	const DRAW_BATCH& batch = m_drawBatches[batchIndex];
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+	m_pShaderManager->UseVariant(batch.shaderVariant);
+	m_pShaderManager->setBoolValue(m_uniforms.useInstancing, true);
+	m_pShaderManager->setVec4Value(m_uniforms.objectColor, batch.color);
+
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
+	{
+		if (batch.nCommands[format] > 0)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_pShaderManager->setBoolValue(m_uniforms.packedVertices,
+				format == ShapeMeshes::VERTEX_FORMAT_PACKED);
+			m_basicMeshes->DrawIndirect((ShapeMeshes::VertexFormat)format,
+				m_indirectCommandOffsets[format] + batch.firstCommand[format], batch.nCommands[format]);
 		}
 	}
 }
@@ -380,30 +830,40 @@ void SceneManager::SetShaderMaterial(
   ***********************************************************/
 void SceneManager::LoadSceneTextures()
 {
-	bool bReturn = false;
+	// the textures are compressed when the driver supports BC1, they are
+	// cooked from the image files once and read from the cache after that
+	bool bCook = (m_bUseTextureCache == true) && (GLEW_EXT_texture_compression_s3tc == GL_TRUE) &&
+		(m_textures.SetCompressed(true) == true);
+	if (bCook == true)
+	{
+		bool bCacheDirectory = MeshCache::CreateCacheDirectory(g_TextureCacheDirectory);
+		m_textureLoader.SetCooking(true, (bCacheDirectory == true) ? g_TextureCacheDirectory : "");
+	}
 
-	bReturn = CreateGLTexture(
+	// the files are decoded in parallel, the objects show a
+	// placeholder until their texture is uploaded
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/coffee.jpg", "coffee");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/stainless.jpg", "stainless");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/Light-blond-oak.jpg", "oak");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/tissue.jpg", "mug");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/black-texture.jpg", "blktx");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/rubber.jpg", "rubber");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/drywall.jpg", "drywall");
 
-	bReturn = CreateGLTexture(
+	LoadTextureAsync(
 		"../../7-1_FinalProjectMilestones/Utilities/textures/Kali-Linux_13.jpg", "Kali");
 
 	BindGLTextures();
@@ -430,7 +890,7 @@ void SceneManager::DefineObjectMaterials()
 	metalMaterial.specularColor = glm::vec3(0.6f, 0.5f, 0.4f);
 	metalMaterial.shininess = 22.0;
 	metalMaterial.tag = "metal";
-	m_objectMaterials.push_back(metalMaterial);
+	DefineMaterial(metalMaterial);
 
 	OBJECT_MATERIAL cementMaterial;
 	cementMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
@@ -439,7 +899,7 @@ void SceneManager::DefineObjectMaterials()
 	cementMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
 	cementMaterial.shininess = 0.5;
 	cementMaterial.tag = "cement";
-	m_objectMaterials.push_back(cementMaterial);
+	DefineMaterial(cementMaterial);
 
 	OBJECT_MATERIAL woodMaterial;
 	woodMaterial.ambientColor = glm::vec3(0.4f, 0.3f, 0.1f);
@@ -448,7 +908,7 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
 	woodMaterial.shininess = 0.3;
 	woodMaterial.tag = "wood";
-	m_objectMaterials.push_back(woodMaterial);
+	DefineMaterial(woodMaterial);
 
 	OBJECT_MATERIAL tileMaterial;
 	tileMaterial.ambientColor = glm::vec3(0.2f, 0.3f, 0.4f);
@@ -457,7 +917,7 @@ void SceneManager::DefineObjectMaterials()
 	tileMaterial.specularColor = glm::vec3(0.4f, 0.5f, 0.6f);
 	tileMaterial.shininess = 25.0;
 	tileMaterial.tag = "tile";
-	m_objectMaterials.push_back(tileMaterial);
+	DefineMaterial(tileMaterial);
 
 	OBJECT_MATERIAL glassMaterial;
 	glassMaterial.ambientColor = glm::vec3(0.4f, 0.4f, 0.4f);
@@ -466,7 +926,7 @@ void SceneManager::DefineObjectMaterials()
 	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
 	glassMaterial.shininess = 85.0;
 	glassMaterial.tag = "glass";
-	m_objectMaterials.push_back(glassMaterial);
+	DefineMaterial(glassMaterial);
 
 	OBJECT_MATERIAL clayMaterial;
 	clayMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.3f);
@@ -475,7 +935,7 @@ void SceneManager::DefineObjectMaterials()
 	clayMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.4f);
 	clayMaterial.shininess = 0.5;
 	clayMaterial.tag = "clay";
-	m_objectMaterials.push_back(clayMaterial);
+	DefineMaterial(clayMaterial);
 
 	OBJECT_MATERIAL plasticMaterial;
 	plasticMaterial.ambientColor = glm::vec3(0.3f, 0.3f, 0.3f);
@@ -484,7 +944,7 @@ void SceneManager::DefineObjectMaterials()
 	plasticMaterial.specularColor = glm::vec3(0.8f, 0.8f, 0.8f); 
 	plasticMaterial.shininess = 32.0f;                          
 	plasticMaterial.tag = "plastic";
-	m_objectMaterials.push_back(plasticMaterial);
+	DefineMaterial(plasticMaterial);
 
 	OBJECT_MATERIAL lightplasticMaterial;
 	lightplasticMaterial.ambientColor = glm::vec3(0.3f, 0.3f, 0.3f);
@@ -493,7 +953,7 @@ void SceneManager::DefineObjectMaterials()
 	lightplasticMaterial.specularColor = glm::vec3(0.8f, 0.8f, 0.8f);
 	lightplasticMaterial.shininess = 22.0f;
 	lightplasticMaterial.tag = "lightplastic";
-	m_objectMaterials.push_back(lightplasticMaterial);
+	DefineMaterial(lightplasticMaterial);
 }
 
 /***********************************************************
@@ -506,170 +966,305 @@ void SceneManager::DefineObjectMaterials()
 
 void SceneManager::SetupSceneLights()
 {
-	m_pShaderManager->setVec3Value("lightSources[0].position", 0.0f, 15.0f, -5.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.05f, 0.05f, 0.05f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.7f, 0.7f, 0.7f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 10.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.1f);
+	LIGHT_SOURCE light = LIGHT_SOURCE();
+
+	light.position = glm::vec3(0.0f, 15.0f, -5.0f);
+	light.ambientColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	light.diffuseColor = glm::vec3(0.7f, 0.7f, 0.7f);
+	light.specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	light.focalStrength = 10.0f;
+	light.specularIntensity = 0.1f;
+	SetLightSource(0, light);
+
+	light.position = glm::vec3(-10.0f, 15.0f, -5.0f);
+	light.ambientColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	light.diffuseColor = glm::vec3(0.6f, 0.6f, 0.6f);
+	light.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	light.focalStrength = 30.0f;
+	light.specularIntensity = 0.1f;
+	SetLightSource(1, light);
+
+	light.position = glm::vec3(10.0f, 15.0f, -5.0f);
+	light.ambientColor = glm::vec3(0.02f, 0.02f, 0.02f);
+	light.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	light.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
+	light.focalStrength = 30.0f;
+	light.specularIntensity = 0.6f;
+	SetLightSource(2, light);
+
+	SetupScenePointLights();
+
+	m_bUseLighting = true;
+}
+
+/***********************************************************
+ *  SetupScenePointLights()
+ *
+ *  This method is called to place the point lights of the
+ *  3D scene - a desk lamp, the glow of the monitor and a
+ *  grid of ceiling lights.  Each light only reaches the
+ *  light clusters within its radius.
+ ***********************************************************/
+void SceneManager::SetupScenePointLights()
+{
+	m_pointLights.clear();
 
-	m_pShaderManager->setVec3Value("lightSources[1].position", -10.0f, 15.0f, -5.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.05f, 0.05f, 0.05f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.6f, 0.6f, 0.6f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 30.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.1f);
+	// warm desk lamp next to the monitor
+	AddPointLight(glm::vec3(-6.0f, 4.0f, 0.0f), 8.0f, glm::vec3(1.0f, 0.8f, 0.55f), 8.0f);
 
-	m_pShaderManager->setVec3Value("lightSources[2].position", 10.0f, 15.0f, -5.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.02f, 0.02f, 0.02f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.8f, 0.8f, 0.8f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.6f, 0.6f, 0.6f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 30.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.6f);
+	// bluish glow in front of the monitor screen
+	for (int row = 0; row < 2; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			glm::vec3 position = glm::vec3(-3.0f + (column * 2.0f), 4.0f + (row * 2.0f), -3.1f);
+			AddPointLight(position, 3.0f, glm::vec3(0.55f, 0.7f, 1.0f), 1.5f);
+		}
+	}
 
-	m_pShaderManager->setBoolValue("bUseLighting", true);
+	// grid of ceiling lights over the room
+	const int ceilingColumns = 16;
+	const int ceilingRows = 12;
+	for (int row = 0; row < ceilingRows; row++)
+	{
+		for (int column = 0; column < ceilingColumns; column++)
+		{
+			glm::vec3 position = glm::vec3(
+				-18.0f + (column * (36.0f / (ceilingColumns - 1))),
+				10.0f,
+				-5.0f + (row * (24.0f / (ceilingRows - 1))));
+			AddPointLight(position, 12.0f, glm::vec3(1.0f, 0.95f, 0.85f), 2.5f);
+		}
+	}
 }
 
+/***********************************************************
+ *  AddPointLight()
+ *
+ *  This method is used for adding a point light to the
+ *  scene.  The point lights are uploaded to the shaders
+ *  before the next frame is rendered.
+ ***********************************************************/
+void SceneManager::AddPointLight(glm::vec3 position, float radius, glm::vec3 color, float intensity)
+{
+	POINT_LIGHT light;
+	light.position = position;
+	light.radius = radius;
+	light.color = color;
+	light.intensity = intensity;
+
+	m_pointLights.push_back(light);
+	m_bPointLightsDirty = true;
+}
 
 /***********************************************************
- *  PrepareScene()
+ *  UpdateLightGrid()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
+ *  This method is used for assigning the point lights to
+ *  the clusters of the current view and uploading the
+ *  light lists of the clusters to the shaders.
  ***********************************************************/
-void SceneManager::PrepareScene()
+void SceneManager::UpdateLightGrid(const FRAME_CONSTANTS& frame)
 {
-	// load the textures for the 3D scene
-	LoadSceneTextures();
-	DefineObjectMaterials();
-	SetupSceneLights();
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
 
-	// Load the meshes needed for the scene
-
-	// Load the plane mesh for the ground or keyboard base
-	m_basicMeshes->LoadPlaneMesh();
+	if (m_bPointLightsDirty == true)
+	{
+		m_pShaderManager->UpdatePointLights(
+			m_pointLights.empty() ? NULL : &m_pointLights[0], (int)m_pointLights.size());
+		m_bPointLightsDirty = false;
+	}
 
-	// Load the cylinder mesh for the mug's body
-	m_basicMeshes->LoadCylinderMesh();
+	// the tiles of the clusters follow the size of the window
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
 
-	// Load the half torus mesh for the mug's handle
-	m_basicMeshes->LoadTorusMesh(0.2f); // Adjust thickness as needed
+	m_lightGrid.Update(frame.view, frame.projection, viewport[2], viewport[3], m_pointLights);
 
-	// Load the box mesh for the keyboard base
-	m_basicMeshes->LoadBoxMesh();
+	const std::vector<LIGHT_CLUSTER>& clusters = m_lightGrid.GetClusters();
+	const std::vector<unsigned int>& lightIndices = m_lightGrid.GetLightIndices();
+	m_pShaderManager->UpdateLightGrid(
+		m_lightGrid.GetConstants(),
+		clusters.empty() ? NULL : &clusters[0], (int)clusters.size(),
+		lightIndices.empty() ? NULL : &lightIndices[0], (int)lightIndices.size());
+}
 
-	// Load the sphere mesh for the mouse body
-	m_basicMeshes->LoadSphereMesh();
+/***********************************************************
+ *  SetLightSource()
+ *
+ *  This method is used for changing one of the light
+ *  sources.  The light block is uploaded to the shaders
+ *  before the next frame is rendered.
+ ***********************************************************/
+void SceneManager::SetLightSource(int index, const LIGHT_SOURCE& light)
+{
+	if ((index < 0) || (index >= TOTAL_LIGHTS))
+	{
+		return;
+	}
 
-	// Load the tapered cylinder for the mouse tail or other parts if needed
-	m_basicMeshes->LoadTaperedCylinderMesh();
+	m_lightBlock.lightSources[index] = light;
+	m_bLightsDirty = true;
 
-	// Load any additional meshes as needed
+	// the lit shader variants only loop over the lights that are set
+	if (index >= m_lightCount)
+	{
+		m_lightCount = index + 1;
+	}
 }
 
-
 /***********************************************************
- *  RenderScene()
+ *  GetShaderVariant()
  *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for getting the shader variant that
+ *  draws an object with the passed in texture and material.
+ *  Objects without a material are not lit, and objects
+ *  without a texture are drawn with the color.  With
+ *  deferred shading the objects are drawn with the
+ *  variants of the geometry pass.
  ***********************************************************/
-void SceneManager::RenderScene()
+ShaderManager::VariantKey SceneManager::GetShaderVariant(int textureSlot, MaterialId materialID) const
 {
-	// Ground Plane
-	{
-		glm::vec3 scaleXYZ = glm::vec3(10.0f, 10.0f, 5.0f);
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+	bool bLighting = (m_bUseLighting == true) && (m_materials.IsValid(materialID) == true);
+	ShaderManager::VariantPass pass = (m_bDeferredShading == true) ?
+		ShaderManager::VARIANT_PASS_GEOMETRY : ShaderManager::VARIANT_PASS_FORWARD;
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	return(ShaderManager::MakeVariantKey(bLighting, textureSlot >= 0, m_lightCount, pass));
+}
 
-		//SetShaderColor(0.5f, 0.5f, 0.5f, 1.0f); // Grey color
-		SetShaderTexture("oak");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("wood");
+/***********************************************************
+ *  GetLightingPassVariant()
+ *
+ *  This method is used for getting the shader variant that
+ *  lights the G-buffer with the light sources that are set.
+ ***********************************************************/
+ShaderManager::VariantKey SceneManager::GetLightingPassVariant() const
+{
+	return(ShaderManager::MakeVariantKey(m_bUseLighting, false, m_lightCount,
+		ShaderManager::VARIANT_PASS_LIGHTING));
+}
 
-		m_basicMeshes->DrawPlaneMesh();
+/***********************************************************
+ *  RequestShaderVariants()
+ *
+ *  This method is used for starting to compile the shader
+ *  variants that the scene objects are drawn with, so the
+ *  driver compiles them together and no variant is first
+ *  compiled when it is drawn.
+ ***********************************************************/
+void SceneManager::RequestShaderVariants()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
 	}
 
-	// Draw the Coffee Mug Outer Body (without top)
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(0.8f, 1.2f, 0.8f);
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(-4.0f, -0.03f, -0.5f);
-
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		m_pShaderManager->RequestVariant(GetShaderVariant(object.textureSlot, object.materialID));
+	}
 
-		//SetShaderColor(0.8f, 0.7f, 0.5f, 1.0f);
-		SetShaderTexture("mug");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("clay");
+	if (m_bDeferredShading == true)
+	{
+		m_pShaderManager->RequestVariant(GetLightingPassVariant());
+	}
+}
 
-		// Draw cylinder without top cap
-		m_basicMeshes->DrawCylinderMesh(false, true, true);
+/***********************************************************
+ *  BeginGpuTimer()
+ *
+ *  This method is used for starting the GPU time query of
+ *  the scene passes.  The queries are used in turn, and
+ *  the result of a query is read when it comes around
+ *  again, by which time the GPU has finished that frame.
+ ***********************************************************/
+void SceneManager::BeginGpuTimer()
+{
+	if (0 == m_gpuTimeQueries[0])
+	{
+		glGenQueries(GPU_TIME_QUERY_COUNT, m_gpuTimeQueries);
 	}
 
-	// Draw the Coffee Mug Inner Surface
+	GLuint query = m_gpuTimeQueries[m_gpuTimeQueryFrame % GPU_TIME_QUERY_COUNT];
+	if (m_gpuTimeQueryFrame >= GPU_TIME_QUERY_COUNT)
 	{
-		glm::vec3 innerScaleXYZ = glm::vec3(0.75f, 1.15f, 0.75f); // Slightly smaller and shorter
-		float innerXrotationDegrees = 0.0f;
-		float innerYrotationDegrees = 0.0f;
-		float innerZrotationDegrees = 0.0f;
-		glm::vec3 innerPositionXYZ = glm::vec3(-4.0f, -0.04f, -0.5f); // Slightly higher
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (GL_TRUE == bAvailable)
+		{
+			GLuint64 elapsedNanoseconds = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNanoseconds);
+			m_sceneGpuTime = (double)elapsedNanoseconds / 1000000.0;
+		}
+	}
+	m_gpuTimeQueryFrame++;
 
-		SetTransformations(innerScaleXYZ, innerXrotationDegrees, innerYrotationDegrees, innerZrotationDegrees, innerPositionXYZ);
+	glBeginQuery(GL_TIME_ELAPSED, query);
+}
 
-		//SetShaderColor(0.9f, 0.8f, 0.7f, 1.0f);
-		SetShaderTexture("coffee");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("glass");
 
-		// Draw inner cylinder without bottom cap
-		m_basicMeshes->DrawCylinderMesh(true, false, true);
-	}
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// load the textures for the 3D scene
+	LoadSceneTextures();
+	DefineObjectMaterials();
+	UploadMaterials();
+	SetupSceneLights();
 
-	// Draw the Coffee Mug Handle using TorusMesh
+	// Load the meshes needed for the scene, the generated shapes are
+	// mapped from the cache files written by an earlier run
+	if (m_bUseMeshCache == true)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(0.4f, 0.4f, 0.4f);
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(-3.2f, 0.6f, -0.5f); // Adjusted position
+		m_basicMeshes->SetMeshCacheDirectory(
+			"../../7-1_FinalProjectMilestones/Utilities/cache");
+	}
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	// Load the plane mesh for the ground or keyboard base
+	m_basicMeshes->LoadPlaneMesh();
 
-		//SetShaderColor(0.8f, 0.7f, 0.5f, 1.0f);
-		SetShaderTexture("mug");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("clay");
+	// Load the cylinder mesh for the mug's body
+	m_basicMeshes->LoadCylinderMesh();
 
-		m_basicMeshes->DrawTorusMesh();
-	}
+	// Load the half torus mesh for the mug's handle
+	m_basicMeshes->LoadTorusMesh(0.2f); // Adjust thickness as needed
 
-	// Keyboard Base
-	{
-		glm::vec3 scaleXYZ = glm::vec3(4.0f, 0.2f, 2.0f);
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 0.0f, 2.0f);
+	// Load the box mesh for the keyboard base
+	m_basicMeshes->LoadBoxMesh();
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	// Load the sphere mesh for the mouse body
+	m_basicMeshes->LoadSphereMesh();
 
-		//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-		SetShaderTexture("stainless");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("metal");
+	// Load the tapered cylinder for the mouse tail or other parts if needed
+	m_basicMeshes->LoadTaperedCylinderMesh();
 
-		m_basicMeshes->DrawBoxMesh();
+	// the curved shapes are drawn from the packed vertex format, a
+	// mesh whose data does not fit into it stays in the float format
+	const ShapeMeshes::MeshID packedMeshes[] = {
+		ShapeMeshes::MESH_CYLINDER, ShapeMeshes::MESH_TORUS,
+		ShapeMeshes::MESH_SPHERE, ShapeMeshes::MESH_TAPERED_CYLINDER };
+	for (size_t i = 0; i < sizeof(packedMeshes) / sizeof(packedMeshes[0]); i++)
+	{
+		m_basicMeshes->SetMeshVertexFormat(packedMeshes[i], ShapeMeshes::VERTEX_FORMAT_PACKED);
 	}
 
-	// Keyboard Keys
+	// Load any additional meshes as needed
+
+	// the keyboard keys never move, so their per-instance
+	// data is calculated once and drawn with one call
+	MaterialId keyMaterialID = m_materials.FindMaterial("lightplastic");
+	m_keyInstances.clear();
+	m_keyInstances.reserve(5 * 12);
 	for (int i = 0; i < 5; i++) // Number of rows of keys
 	{
 		for (int j = 0; j < 12; j++) // Number of keys per row
@@ -683,160 +1278,672 @@ void SceneManager::RenderScene()
 			// Proper spacing between keys
 			glm::vec3 positionXYZ = glm::vec3(-1.65f + j * 0.3f, 0.05f, 1.5f + i * 0.3f); // Added spacing between keys
 
-			SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+			ShapeMeshes::InstanceData keyInstance;
+			keyInstance.model = CalculateTransformation(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+			keyInstance.uvScale = glm::vec2(1.0f, 1.0f);
+			keyInstance.materialIndex = (float)keyMaterialID;
+			keyInstance.textureLayer = -1.0f;
+			m_keyInstances.push_back(keyInstance);
+		}
+	}
 
-			SetShaderTexture("blktx");
-			SetTextureUVScale(1.0, 1.0);
-			SetShaderMaterial("lightplastic");
+	// build the retained list of scene objects
+	BuildSceneObjects();
 
-			m_basicMeshes->DrawBoxMesh();
-		}
+	// the variants compile while the textures are still loading
+	RequestShaderVariants();
+}
+
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for creating a scene node for an
+ *  object and adding the object to the scene.  The texture
+ *  and material tags are resolved here, once, instead of
+ *  for every rendered frame.
+ ***********************************************************/
+NodeID SceneManager::AddSceneObject(
+	NodeID parent,
+	ShapeMeshes::MeshID meshID,
+	unsigned int meshParts,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	const std::string& textureTag,
+	glm::vec2 uvScale,
+	const std::string& materialTag)
+{
+	SCENE_OBJECT object;
+
+	object.node = m_sceneGraph.CreateNode(parent, scaleXYZ,
+		XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	object.meshID = meshID;
+	object.meshParts = meshParts;
+	object.meshLod = 0;
+	object.textureSlot = FindTextureSlot(textureTag);
+	object.materialID = m_materials.FindMaterial(materialTag);
+	object.uvScale = uvScale;
+	object.pInstances = NULL;
+	object.boundsCenter = glm::vec3(0.0f);
+	object.boundsExtents = glm::vec3(0.0f);
+	object.bOccluder = false;
+	m_sceneObjects.push_back(object);
+
+	return(object.node);
+}
+
+/***********************************************************
+ *  BuildSceneObjects()
+ *
+ *  This method is used for building the scene nodes and
+ *  the list of objects that are queued for every frame.
+ ***********************************************************/
+void SceneManager::BuildSceneObjects()
+{
+	const glm::vec2 uvScale = glm::vec2(1.0f, 1.0f);
+
+	m_sceneGraph.Clear();
+	m_sceneObjects.clear();
+
+	// Ground Plane
+	AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_PLANE, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(10.0f, 10.0f, 5.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.0f, 0.0f),
+		"oak", uvScale, "wood");
+
+	// the coffee mug parts are placed relative to the mug,
+	// so moving the mug node moves the whole mug
+	m_mugNode = m_sceneGraph.CreateNode(INVALID_NODE,
+		glm::vec3(1.0f, 1.0f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(-4.0f, -0.03f, -0.5f));
+
+	// Coffee Mug Outer Body (without top cap)
+	AddSceneObject(m_mugNode, ShapeMeshes::MESH_CYLINDER, ShapeMeshes::MESH_PART_BOTTOM | ShapeMeshes::MESH_PART_SIDES,
+		glm::vec3(0.8f, 1.2f, 0.8f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.0f, 0.0f),
+		"mug", uvScale, "clay");
+
+	// Coffee Mug Inner Surface (without bottom cap), slightly smaller and shorter
+	AddSceneObject(m_mugNode, ShapeMeshes::MESH_CYLINDER, ShapeMeshes::MESH_PART_TOP | ShapeMeshes::MESH_PART_SIDES,
+		glm::vec3(0.75f, 1.15f, 0.75f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, -0.01f, 0.0f),
+		"coffee", uvScale, "glass");
+
+	// Coffee Mug Handle
+	AddSceneObject(m_mugNode, ShapeMeshes::MESH_TORUS, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(0.4f, 0.4f, 0.4f), 0.0f, 0.0f, 0.0f, glm::vec3(0.8f, 0.63f, 0.0f),
+		"mug", uvScale, "clay");
+
+	// Keyboard Base
+	NodeID keyboardNode = AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_BOX, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(4.0f, 0.2f, 2.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.0f, 2.0f),
+		"stainless", uvScale, "metal");
+	SetOccluder(keyboardNode);
+
+	// Keyboard Keys - all keys are drawn in one instanced call, the
+	// transforms and UV scale come from the per-instance data
+	{
+		SCENE_OBJECT keys;
+
+		keys.node = INVALID_NODE;
+		keys.meshID = ShapeMeshes::MESH_BOX;
+		keys.meshParts = ShapeMeshes::MESH_PART_ALL;
+		keys.meshLod = 0;
+		keys.textureSlot = FindTextureSlot("blktx");
+		keys.materialID = m_materials.FindMaterial("lightplastic");
+		keys.uvScale = uvScale;
+		keys.pInstances = &m_keyInstances;
+		keys.boundsCenter = glm::vec3(0.0f);
+		keys.boundsExtents = glm::vec3(0.0f);
+		keys.bOccluder = false;
+		m_sceneObjects.push_back(keys);
 	}
 
 	// Mouse Body
+	AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_SPHERE, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(0.5f, 0.2f, 0.8f), 0.0f, 15.0f, 0.0f, glm::vec3(4.0f, 0.2f, 2.5f),
+		"blktx", uvScale, "lightplastic");
+
+	// Mouse Wheel, matching the mouse body rotation
+	AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_CYLINDER, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(0.1f, 0.1f, 0.15f), 0.0f, 15.0f, 90.0f, glm::vec3(3.9f, 0.31f, 2.0f),
+		"rubber", uvScale, "lightplastic");
+
+	// Wall, wide and tall and positioned behind the desk
+	NodeID wallNode = AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_BOX, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(40.0f, 30.0f, 0.2f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 2.5f, -6.0f),
+		"drywall", uvScale, "cement");
+
+	SetOccluder(wallNode);
+
+	// Side Wall
+	NodeID sideWallNode = AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_BOX, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(40.0f, 30.0f, 0.2f), 0.0f, 90.0f, 0.0f, glm::vec3(20.0f, 2.5f, 10.0f),
+		"drywall", uvScale, "cement");
+
+	SetOccluder(sideWallNode);
+
+	// Monitor Body, wide and thin and raised on the desk
+	NodeID monitorNode = AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_BOX, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(9.0f, 4.5f, 0.3f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 5.0f, -3.5f),
+		"blktx", uvScale, "plastic");
+
+	SetOccluder(monitorNode);
+
+	// Monitor Screen
+	AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_BOX, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(8.8f, 4.3f, 0.3f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 5.0f, -3.48f),
+		"Kali", uvScale, "glass");
+
+	// Monitor Stand (Pole), positioned under the monitor
+	AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_CYLINDER, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(0.3f, 4.0f, 0.3f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.2f, -3.7f),
+		"stainless", uvScale, "metal");
+
+	// Monitor Stand (Base), flat and wide
+	AddSceneObject(INVALID_NODE, ShapeMeshes::MESH_BOX, ShapeMeshes::MESH_PART_ALL,
+		glm::vec3(4.0f, 0.3f, 2.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.2f, -3.5f),
+		"stainless", uvScale, "metal");
+
+	// every object has a bounding box for culling, which is
+	// calculated once the world matrices are available
+	m_culler.Resize((int)m_sceneObjects.size());
+	m_bBoundsDirty = true;
+}
+
+/***********************************************************
+ *  SetOccluder()
+ *
+ *  This method is used for marking the object of a node as
+ *  an occluder.  Only box meshes should be occluders, as
+ *  the whole of their bounds is rasterized as solid.
+ ***********************************************************/
+void SceneManager::SetOccluder(NodeID node)
+{
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(0.5f, 0.2f, 0.8f);
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 15.0f; // Rotate 30 degrees around Y-axis
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(4.0f, 0.2f, 2.5f);
+		if (m_sceneObjects[i].node == node)
+		{
+			m_sceneObjects[i].bOccluder = true;
+		}
+	}
+}
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+/***********************************************************
+ *  BeginOcclusionCulling()
+ *
+ *  This method is used for collecting the occluder boxes
+ *  of the current frame and handing them to the occlusion
+ *  culler, which rasterizes them on its worker thread.
+ ***********************************************************/
+void SceneManager::BeginOcclusionCulling(const glm::mat4& viewProjection)
+{
+	m_occluders.clear();
 
-		//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f);
-		SetShaderTexture("blktx");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("lightplastic");
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		ShapeMeshes::MeshBounds meshBounds;
 
-		m_basicMeshes->DrawSphereMesh();
+		if ((object.bOccluder == true) && (object.node != INVALID_NODE) &&
+			(m_basicMeshes->GetMeshBounds(object.meshID, meshBounds) == true))
+		{
+			OcclusionCuller::OCCLUDER occluder;
+			occluder.model = m_sceneGraph.GetWorldMatrix(object.node);
+			occluder.minimum = meshBounds.minimum;
+			occluder.maximum = meshBounds.maximum;
+			m_occluders.push_back(occluder);
+		}
 	}
 
-	// Mouse Buttons
-	// Mouse Wheel
+	m_occlusionCuller.BeginRasterize(viewProjection, m_occluders);
+}
+
+/***********************************************************
+ *  UpdateObjectBounds()
+ *
+ *  This method is used for calculating the world space
+ *  bounding boxes of the scene objects from the local
+ *  bounds of their meshes.  Instanced objects get the box
+ *  around all of their instances.
+ ***********************************************************/
+void SceneManager::UpdateObjectBounds(bool bAllObjects)
+{
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(0.1f, 0.1f, 0.15f);
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 15.0f; // Match mouse body rotation
-		float ZrotationDegrees = 90.0f;
-		glm::vec3 positionXYZ = glm::vec3(3.9f, 0.31f, 2.0f);
+		SCENE_OBJECT& object = m_sceneObjects[i];
+		ShapeMeshes::MeshBounds meshBounds;
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+		if ((bAllObjects == false) &&
+			((object.node == INVALID_NODE) || (m_sceneGraph.WasUpdated(object.node) == false)))
+		{
+			continue;
+		}
 
-		//SetShaderColor(0.3f, 0.3f, 0.3f, 1.0f);
-		SetShaderTexture("rubber");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("lightplastic");
+		if (m_basicMeshes->GetMeshBounds(object.meshID, meshBounds) == false)
+		{
+			// the mesh is not loaded, so nothing of it is drawn
+			object.boundsCenter = glm::vec3(0.0f);
+			object.boundsExtents = glm::vec3(0.0f);
+		}
+		else if (NULL != object.pInstances)
+		{
+			glm::vec3 minimum(0.0f);
+			glm::vec3 maximum(0.0f);
+
+			for (size_t n = 0; n < object.pInstances->size(); n++)
+			{
+				glm::vec3 center;
+				glm::vec3 extents;
+				FrustumCuller::TransformBounds((*object.pInstances)[n].model,
+					meshBounds.minimum, meshBounds.maximum, center, extents);
+
+				minimum = (n == 0) ? (center - extents) : glm::min(minimum, center - extents);
+				maximum = (n == 0) ? (center + extents) : glm::max(maximum, center + extents);
+			}
+
+			object.boundsCenter = (minimum + maximum) * 0.5f;
+			object.boundsExtents = (maximum - minimum) * 0.5f;
+		}
+		else
+		{
+			FrustumCuller::TransformBounds(m_sceneGraph.GetWorldMatrix(object.node),
+				meshBounds.minimum, meshBounds.maximum,
+				object.boundsCenter, object.boundsExtents);
+		}
 
-		m_basicMeshes->DrawCylinderMesh();
+		m_culler.SetBounds((int)i, object.boundsCenter, object.boundsExtents);
 	}
+}
 
-	// Wall
+/***********************************************************
+ *  SelectMeshLods()
+ *
+ *  This method is used for choosing the level of detail
+ *  of the visible objects.  The bounding radius of an
+ *  object is projected to a fraction of the half height
+ *  of the view, and every threshold it falls below uses
+ *  a coarser mesh.  The level only changes once the size
+ *  is past the threshold by the hysteresis, so an object
+ *  that stays near a threshold keeps its level.
+ ***********************************************************/
+void SceneManager::SelectMeshLods(const glm::mat4& projection)
+{
+	for (int lod = 0; lod < ShapeMeshes::MESH_LOD_COUNT; lod++)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(40.0f, 30.0f, 0.2f); // Wide and tall wall
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 2.5f, -6.0f); // Positioned behind the desk
+		m_lodCounts[lod] = 0;
+	}
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[i];
 
-		SetShaderColor(0.8f, 0.8f, 0.8f, 1.0f); // Light grey for the wall
-		SetShaderTexture("drywall");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("cement");
+		if (m_culler.IsVisible((int)i) == false)
+		{
+			continue;
+		}
+
+		int nLods = m_basicMeshes->GetMeshLodCount(object.meshID);
+		float radius = glm::length(object.boundsExtents);
+		float depth = CalculateViewDepth(object.boundsCenter);
+
+		if ((nLods <= 1) || (depth <= radius))
+		{
+			// single level meshes, and objects around the camera
+			object.meshLod = 0;
+		}
+		else
+		{
+			float screenSize = (radius * projection[1][1]) / depth;
+			int lod = (object.meshLod < nLods) ? object.meshLod : (nLods - 1);
+
+			while ((lod > 0) && (screenSize > g_LodScreenSizes[lod - 1] * (1.0f + g_LodHysteresis)))
+			{
+				lod--;
+			}
+			while ((lod < nLods - 1) && (screenSize < g_LodScreenSizes[lod] * (1.0f - g_LodHysteresis)))
+			{
+				lod++;
+			}
+			object.meshLod = lod;
+		}
 
-		m_basicMeshes->DrawBoxMesh();
+		m_lodCounts[object.meshLod]++;
 	}
+}
 
-	// Side Wall
-	{
-		glm::vec3 scaleXYZ = glm::vec3(40.0f, 30.0f, 0.2f); // Wide and tall wall
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 90.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(20.0f, 2.5f, 10.0f);
+/***********************************************************
+ *  MoveMug()
+ *
+ *  This method is used for moving the coffee mug.  Only
+ *  the mug node is changed, and its three parts follow on
+ *  the next update of the world matrices.
+ ***********************************************************/
+void SceneManager::MoveMug(glm::vec3 positionXYZ)
+{
+	m_sceneGraph.SetLocalPosition(m_mugNode, positionXYZ);
+}
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 
-		SetShaderColor(0.8f, 0.8f, 0.8f, 1.0f); // Light grey for the wall
-		SetShaderTexture("drywall");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("cement");
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// every pass below reads the frame constants of the shaders
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
 
-		m_basicMeshes->DrawBoxMesh();
+	// the shader program finished linking before the first frame
+	if (m_bShadersConnected == false)
+	{
+		ConnectShaders();
 	}
 
+	// replace the placeholders of the textures that finished loading
+	UpdateTextures();
 
-	// Monitor Body
+	// the world matrices are only recomputed for the nodes that
+	// moved, which for this static scene is none after the first frame
+	int updatedTransforms = m_sceneGraph.UpdateWorldTransforms();
+
+	// the world bounds follow the world matrices
+	if ((m_bBoundsDirty == true) || (updatedTransforms > 0))
 	{
-		glm::vec3 scaleXYZ = glm::vec3(9.0f, 4.5f, 0.3f); // Wide and thin monitor
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 5.0f, -3.5f); // Raised position on the desk
+		UpdateObjectBounds(m_bBoundsDirty);
+		m_bBoundsDirty = false;
+	}
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	// the objects are queued with the variants of the geometry pass,
+	// so the G-buffer has to be ready before they are queued - the
+	// scene is drawn forward when the driver cannot render into it,
+	// and nothing is drawn into it while the window is minimized
+	bool bDeferredFrame = false;
+	if (m_bDeferredShading == true)
+	{
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		bDeferredFrame = m_gBuffer.Resize(viewport[2], viewport[3]);
+		if ((bDeferredFrame == false) && (viewport[2] > 0) && (viewport[3] > 0))
+		{
+			std::cout << "Deferred shading is not available, the scene is drawn forward" << std::endl;
+			m_bDeferredShading = false;
+		}
+	}
 
-		//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark grey/black color
-		SetShaderTexture("blktx");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("plastic");
+	// the occluders are rasterized on the worker thread while the
+	// lights are assigned, the objects are culled against the view
+	// and their draw packets are built
+	const FRAME_CONSTANTS& frame = m_pShaderManager->GetFrameConstants();
+	glm::mat4 viewProjection = frame.projection * frame.view;
+	BeginOcclusionCulling(viewProjection);
 
-		m_basicMeshes->DrawBoxMesh();
+	// upload the light sources only when one of them has changed
+	if (m_bLightsDirty == true)
+	{
+		m_pShaderManager->UpdateLightBlock(m_lightBlock);
+		m_pShaderManager->setIntValue(m_uniforms.activeLights, m_lightCount);
+		m_bLightsDirty = false;
 	}
 
-	// Monitor Screen
+	// the point lights are assigned to the clusters of the view
+	UpdateLightGrid(frame);
+
+	// find the objects that are outside of the view, and the
+	// level of detail of the ones that are in it
+	m_culler.Cull(viewProjection);
+	SelectMeshLods(frame.projection);
+
+	// the objects are queued here and drawn after they are sorted
+	// by render state, so the order of the scene objects no longer
+	// decides how often the texture and material are switched
+	m_renderQueue.Begin(g_MaxSceneDepth);
+	m_occlusionCandidates.clear();
+	m_candidateObjects.clear();
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(8.8f, 4.3f, 0.3f); // Wide and thin monitor
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 5.0f, -3.48f); // Raised position on the desk
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		RenderQueue::DRAW_PACKET packet;
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+		if (m_culler.IsVisible((int)i) == false)
+		{
+			continue;
+		}
 
-		//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark grey/black color
-		SetShaderTexture("Kali");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("glass");
+		if (NULL != object.pInstances)
+		{
+			if (BuildInstancesPacket(object.meshID, object.meshParts, object.meshLod, *object.pInstances,
+				object.textureSlot, object.materialID, packet) == false)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			BuildObjectPacket(object.meshID, object.meshParts, object.meshLod,
+				m_sceneGraph.GetWorldMatrix(object.node),
+				object.textureSlot, object.uvScale, object.materialID, packet);
+		}
 
-		m_basicMeshes->DrawBoxMesh();
+		// the occluders are always drawn, they would hide themselves
+		if (object.bOccluder == true)
+		{
+			m_renderQueue.Submit(packet);
+		}
+		else
+		{
+			m_occlusionCandidates.push_back(packet);
+			m_candidateObjects.push_back(i);
+		}
 	}
 
-	// Monitor Stand (Pole)
+	// the depth pyramid is first needed here, the other objects in
+	// the view are only queued when the occluders do not hide them
+	m_occlusionCuller.WaitForRasterize();
+
+	for (size_t c = 0; c < m_occlusionCandidates.size(); c++)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(0.3f, 4.0f, 0.3f); // Thin pole for the stand
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 0.2f, -3.7f); // Positioned under the monitor
+		const SCENE_OBJECT& object = m_sceneObjects[m_candidateObjects[c]];
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+		if (m_occlusionCuller.TestBounds(object.boundsCenter, object.boundsExtents) == true)
+		{
+			m_renderQueue.Submit(m_occlusionCandidates[c]);
+		}
+	}
 
-		//SetShaderColor(0.3f, 0.3f, 0.3f, 1.0f); // Slightly lighter than the monitor
-		SetShaderTexture("stainless");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("metal");
+	// sort the queued objects and draw them, applying only the
+	// texture and material changes between neighbouring batches -
+	// every object is drawn through the instance data
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
+	{
+		m_drawCommands[format].clear();
+	}
+	m_drawInstances.clear();
+	m_drawBatches.clear();
 
-		m_basicMeshes->DrawCylinderMesh();
+	m_renderQueue.Sort();
+
+	BeginGpuTimer();
+	if (bDeferredFrame == true)
+	{
+		m_gBuffer.BeginGeometryPass();
 	}
 
-	// Monitor Stand (Base)
+	m_renderQueue.Flush(*this);
+
+	// every pixel of the G-buffer is lit once, however many
+	// surfaces were drawn over it
+	if (bDeferredFrame == true)
 	{
-		glm::vec3 scaleXYZ = glm::vec3(4.0f, 0.3f, 2.0f); // Flat, wide base
-		float XrotationDegrees = 0.0f;
-		float YrotationDegrees = 0.0f;
-		float ZrotationDegrees = 0.0f;
-		glm::vec3 positionXYZ = glm::vec3(0.0f, 0.2f, -3.5f); // Positioned on the desk
+		m_pShaderManager->UseVariant(GetLightingPassVariant());
+		m_gBuffer.DrawLightingPass();
+	}
+	glEndQuery(GL_TIME_ELAPSED);
 
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	// the draws outside of the render queue set their state
+	// through the uniforms of the generic variant
+	m_pShaderManager->UseVariant(ShaderManager::GENERIC_VARIANT);
+	m_pShaderManager->setBoolValue(m_uniforms.useInstancing, false);
+	m_pShaderManager->setBoolValue(m_uniforms.packedVertices, false);
+}
 
-		//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f); // Dark grey/black color
-		SetShaderTexture("stainless");
-		SetTextureUVScale(1.0, 1.0);
-		SetShaderMaterial("metal");
+/***********************************************************
+ *  GetRenderQueueStats()
+ *
+ *  This method is used for getting the render queue
+ *  counters for the last rendered frame.
+ ***********************************************************/
+const RenderQueue::STATS& SceneManager::GetRenderQueueStats() const
+{
+	return(m_renderQueue.GetStats());
+}
+
+/***********************************************************
+ *  GetTransformUpdateCount()
+ *
+ *  This method is used for getting the number of world
+ *  matrices that were recomputed for the last frame.
+ ***********************************************************/
+int SceneManager::GetTransformUpdateCount() const
+{
+	return(m_sceneGraph.GetLastUpdateCount());
+}
+
+/***********************************************************
+ *  GetCullingStats()
+ *
+ *  This method is used for getting the number of objects
+ *  that were tested and culled for the last frame.
+ ***********************************************************/
+const FrustumCuller::STATS& SceneManager::GetCullingStats() const
+{
+	return(m_culler.GetStats());
+}
+
+/***********************************************************
+ *  GetOcclusionStats()
+ *
+ *  This method is used for getting the number of objects
+ *  that were hidden by the occluders for the last frame.
+ ***********************************************************/
+const OcclusionCuller::STATS& SceneManager::GetOcclusionStats() const
+{
+	return(m_occlusionCuller.GetStats());
+}
+
+/***********************************************************
+ *  GetLightGridStats()
+ *
+ *  This method is used for getting the number of point
+ *  lights that were assigned to the light clusters for
+ *  the last frame.
+ ***********************************************************/
+const LightGrid::STATS& SceneManager::GetLightGridStats() const
+{
+	return(m_lightGrid.GetStats());
+}
 
-		m_basicMeshes->DrawBoxMesh();
+/***********************************************************
+ *  GetLodObjectCount()
+ *
+ *  This method is used for getting the number of visible
+ *  objects that were drawn at a level of detail for the
+ *  last frame.
+ ***********************************************************/
+int SceneManager::GetLodObjectCount(int lod) const
+{
+	if ((lod < 0) || (lod >= ShapeMeshes::MESH_LOD_COUNT))
+	{
+		return(0);
 	}
 
+	return(m_lodCounts[lod]);
+}
+
+/***********************************************************
+ *  GetMeshOptimizationStats()
+ *
+ *  This method is used for getting the simulated vertex
+ *  cache counters of the loaded meshes, before and after
+ *  they were reordered.
+ ***********************************************************/
+const ShapeMeshes::OptimizationStats& SceneManager::GetMeshOptimizationStats() const
+{
+	return(m_basicMeshes->GetOptimizationStats());
+}
+
+/***********************************************************
+ *  SetMeshCacheEnabled()
+ *
+ *  This method is used for enabling or disabling the mesh
+ *  cache files, which only has an effect before the scene
+ *  is prepared.
+ ***********************************************************/
+void SceneManager::SetMeshCacheEnabled(bool bEnabled)
+{
+	m_bUseMeshCache = bEnabled;
+}
+
+/***********************************************************
+ *  SetTextureCacheEnabled()
+ *
+ *  This method is used for enabling or disabling the cooked
+ *  texture cache.  Without it the image files are decoded
+ *  into uncompressed layers on every run.
+ ***********************************************************/
+void SceneManager::SetTextureCacheEnabled(bool bEnabled)
+{
+	m_bUseTextureCache = bEnabled;
+}
+
+/***********************************************************
+ *  SetDeferredShading()
+ *
+ *  This method is used for choosing between forward and
+ *  deferred shading, which only has an effect before the
+ *  scene is prepared.  Forward shading lights every drawn
+ *  fragment, deferred shading draws the surfaces into the
+ *  G-buffer and lights each visible pixel once.
+ ***********************************************************/
+void SceneManager::SetDeferredShading(bool bEnabled)
+{
+	m_bDeferredShading = bEnabled;
+}
+
+/***********************************************************
+ *  IsDeferredShading()
+ *
+ *  This method is used for checking whether the scene is
+ *  drawn with deferred shading.
+ ***********************************************************/
+bool SceneManager::IsDeferredShading() const
+{
+	return(m_bDeferredShading);
+}
+
+/***********************************************************
+ *  GetSceneGpuTime()
+ *
+ *  This method is used for getting the milliseconds the
+ *  GPU spent on drawing and lighting the scene objects,
+ *  for a frame that finished a few frames ago.
+ ***********************************************************/
+double SceneManager::GetSceneGpuTime() const
+{
+	return(m_sceneGpuTime);
+}
+
+/***********************************************************
+ *  GetMeshCacheStats()
+ *
+ *  This method is used for getting the number of meshes
+ *  that were mapped from and written to the cache files.
+ ***********************************************************/
+const ShapeMeshes::MeshCacheStats& SceneManager::GetMeshCacheStats() const
+{
+	return(m_basicMeshes->GetMeshCacheStats());
 }
@@ -11,8 +11,20 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "RenderQueue.h"
+#include "SceneGraph.h"
+#include "MaterialTable.h"
+#include "TextureArray.h"
+#include "TextureLoader.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "LightGrid.h"
+#include "GBuffer.h"
 
+#include <chrono>
+#include <future>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /***********************************************************
@@ -21,7 +33,7 @@
  *  This class contains the code for preparing and rendering
  *  3D scenes, including the shader settings.
  ***********************************************************/
-class SceneManager
+class SceneManager : private RenderQueue::Executor
 {
 public:
 	// constructor
@@ -29,12 +41,6 @@ public:
 	// destructor
 	~SceneManager();
 
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
 	struct OBJECT_MATERIAL
 	{
 		float ambientStrength;
@@ -46,28 +52,200 @@ public:
 	};
 
 private:
+	// handles for the shader uniforms that are set while rendering
+	struct SHADER_UNIFORMS
+	{
+		ShaderManager::UniformHandle model;
+		ShaderManager::UniformHandle modelViewProjection;
+		ShaderManager::UniformHandle normalMatrix;
+		ShaderManager::UniformHandle objectColor;
+		ShaderManager::UniformHandle objectTextures;
+		ShaderManager::UniformHandle textureLayer;
+		ShaderManager::UniformHandle useLighting;
+		ShaderManager::UniformHandle useInstancing;
+		ShaderManager::UniformHandle packedVertices;
+		ShaderManager::UniformHandle UVscale;
+		ShaderManager::UniformHandle materialIndex;
+		ShaderManager::UniformHandle activeLights;
+	};
+
+	// object that is drawn for every frame, with its texture
+	// and material already resolved from their tags
+	struct SCENE_OBJECT
+	{
+		NodeID node;
+		ShapeMeshes::MeshID meshID;
+		unsigned int meshParts;
+		int meshLod;				// level of detail chosen for the last frame
+		int textureSlot;			// layer of the texture array
+		MaterialId materialID;
+		glm::vec2 uvScale;
+		// instanced objects take their transforms from here
+		// instead of from the scene node
+		const std::vector<ShapeMeshes::InstanceData>* pInstances;
+		// world space bounding box, as its center and half extents
+		glm::vec3 boundsCenter;
+		glm::vec3 boundsExtents;
+		// the object is a solid box that hides what is behind it
+		bool bOccluder;
+	};
+
+	// range of the indirect draw commands of one render queue batch
+	struct DRAW_BATCH
+	{
+		// commands of the meshes of each vertex format, which
+		// are drawn from different vertex arrays
+		GLsizei firstCommand[ShapeMeshes::VERTEX_FORMAT_COUNT];
+		GLsizei nCommands[ShapeMeshes::VERTEX_FORMAT_COUNT];
+		glm::vec4 color;		// used by the draws without a texture
+		ShaderManager::VariantKey shaderVariant;
+	};
+
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// resolved shader uniform handles
+	SHADER_UNIFORMS m_uniforms;
+	// the handles were resolved from the linked shader program
+	bool m_bShadersConnected;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// the generated meshes are read from and written to the cache files
+	bool m_bUseMeshCache;
+	// the textures are cooked into compressed cache files
+	bool m_bUseTextureCache;
+	// the objects are drawn into the G-buffer and lit in a separate pass
+	bool m_bDeferredShading;
+	// render targets of the deferred geometry pass
+	GBuffer m_gBuffer;
+	// GPU time queries of the scene passes, each is read back when
+	// it is reused, so the CPU never waits for the GPU to finish
+	static const int GPU_TIME_QUERY_COUNT = 3;
+	GLuint m_gpuTimeQueries[GPU_TIME_QUERY_COUNT];
+	int m_gpuTimeQueryFrame;
+	// milliseconds the GPU spent on the scene passes of a recent frame
+	double m_sceneGpuTime;
+	// loaded textures, one layer of the array texture each
+	TextureArray m_textures;
+	// texture array layers by texture tag
+	std::unordered_map<std::string, int> m_textureLayers;
+	// a texture whose file is being decoded, its layer holds a
+	// placeholder until the decoded pixels are uploaded
+	struct PENDING_TEXTURE
+	{
+		std::string filename;
+		int layer;
+		std::future<TextureLoader::DECODED_IMAGE> image;
+		std::promise<bool> uploaded;
+	};
+	std::vector<PENDING_TEXTURE> m_pendingTextures;
+	// decodes the texture files on worker threads
+	TextureLoader m_textureLoader;
+	// time the first pending texture was requested
+	std::chrono::steady_clock::time_point m_textureLoadStart;
+	// defined object materials, referenced by their ids
+	MaterialTable m_materials;
+	// per-instance data for the keyboard keys
+	std::vector<ShapeMeshes::InstanceData> m_keyInstances;
+	// light sources for the 3D scene
+	LIGHT_BLOCK m_lightBlock;
+	// the light sources changed since they were last uploaded
+	bool m_bLightsDirty;
+	// number of the light sources that were set
+	int m_lightCount;
+	// the objects with a material are drawn with the lit variants
+	bool m_bUseLighting;
+	// point lights of the scene, shaded per light cluster
+	std::vector<POINT_LIGHT> m_pointLights;
+	// the point lights changed since they were last uploaded
+	bool m_bPointLightsDirty;
+	// light lists of the clusters of the view frustum
+	LightGrid m_lightGrid;
+	// sorted queue of the draw packets for the current frame
+	RenderQueue m_renderQueue;
+	// scene node hierarchy with the cached world matrices
+	SceneGraph m_sceneGraph;
+	// objects that are queued for every frame
+	std::vector<SCENE_OBJECT> m_sceneObjects;
+	// parent node of the coffee mug parts
+	NodeID m_mugNode;
+	// bounding boxes of the scene objects, by object index
+	FrustumCuller m_culler;
+	// the bounds of all objects need to be calculated
+	bool m_bBoundsDirty;
+	// depth pyramid of the occluders, built on a worker thread
+	OcclusionCuller m_occlusionCuller;
+	// occluders of the current frame
+	std::vector<OcclusionCuller::OCCLUDER> m_occluders;
+	// packets of the objects in the view that wait for the occlusion
+	// test, and the objects they were built for
+	std::vector<RenderQueue::DRAW_PACKET> m_occlusionCandidates;
+	std::vector<size_t> m_candidateObjects;
+	// number of visible objects drawn at each level of detail
+	int m_lodCounts[ShapeMeshes::MESH_LOD_COUNT];
+	// indirect draw commands of each vertex format, per-draw
+	// instance data and batches that were collected for the
+	// current frame
+	std::vector<ShapeMeshes::DrawElementsIndirectCommand> m_drawCommands[ShapeMeshes::VERTEX_FORMAT_COUNT];
+	// the commands of all formats one after another, as uploaded
+	std::vector<ShapeMeshes::DrawElementsIndirectCommand> m_indirectCommands;
+	GLsizei m_indirectCommandOffsets[ShapeMeshes::VERTEX_FORMAT_COUNT];
+	std::vector<ShapeMeshes::InstanceData> m_drawInstances;
+	std::vector<DRAW_BATCH> m_drawBatches;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
+	// start decoding a texture image on a worker thread, the texture
+	// is usable right away and shows a placeholder until it is loaded.
+	// The future tells whether the image was loaded, once it is uploaded.
+	std::shared_future<bool> LoadTextureAsync(const char* filename, std::string tag);
+	// bind the loaded OpenGL textures for the shaders
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
+	// find the texture array layer of a loaded texture by tag
 	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	// resolve the handles for the shader uniforms
+	void ResolveShaderUniforms();
+	// resolve the uniforms of the linked shader program and set
+	// the ones that keep their value for every frame
+	void ConnectShaders();
+
+	// set a light source and flag the light block for upload
+	void SetLightSource(int index, const LIGHT_SOURCE& light);
+	// add a point light and flag the point lights for upload
+	void AddPointLight(glm::vec3 position, float radius, glm::vec3 color, float intensity);
+	// place the point lights of the scene
+	void SetupScenePointLights();
+	// build and upload the light lists of the clusters for the frame
+	void UpdateLightGrid(const FRAME_CONSTANTS& frame);
+	// get the shader variant for the texture and material of a draw
+	ShaderManager::VariantKey GetShaderVariant(int textureSlot, MaterialId materialID) const;
+	// get the shader variant of the deferred lighting pass
+	ShaderManager::VariantKey GetLightingPassVariant() const;
+	// start timing the scene passes on the GPU, and read back the
+	// time of the frame that last used the query
+	void BeginGpuTimer();
+	// start compiling the shader variants of the scene objects
+	void RequestShaderVariants();
+
+	// add a material to the material table and return its id
+	MaterialId DefineMaterial(const OBJECT_MATERIAL& material);
+	// upload the defined materials into the material buffer
+	void UploadMaterials();
+
+	// calculate the model matrix from the
+	// passed in transformation values
+	glm::mat4 CalculateTransformation(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the passed in model matrix and the matrices derived
+	// from it with the camera of the current frame
+	void SetTransformations(
+		const glm::mat4& model);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -95,7 +273,62 @@ private:
 
 	// set the object material into the shader
 	void SetShaderMaterial(
-		std::string materialTag);
+		const std::string& materialTag);
+	void SetShaderMaterial(
+		MaterialId materialID);
+
+	// build the draw packet of an object for this frame
+	void BuildObjectPacket(
+		ShapeMeshes::MeshID meshID,
+		unsigned int meshParts,
+		int meshLod,
+		const glm::mat4& model,
+		int textureSlot,
+		glm::vec2 uvScale,
+		MaterialId materialID,
+		RenderQueue::DRAW_PACKET& packet);
+	// build the draw packet of an instanced batch of objects,
+	// returns false when there are no instances to draw
+	bool BuildInstancesPacket(
+		ShapeMeshes::MeshID meshID,
+		unsigned int meshParts,
+		int meshLod,
+		const std::vector<ShapeMeshes::InstanceData>& instances,
+		int textureSlot,
+		MaterialId materialID,
+		RenderQueue::DRAW_PACKET& packet);
+	// create a scene node for an object and add it to the scene
+	NodeID AddSceneObject(
+		NodeID parent,
+		ShapeMeshes::MeshID meshID,
+		unsigned int meshParts,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		const std::string& textureTag,
+		glm::vec2 uvScale,
+		const std::string& materialTag);
+	// build the scene nodes and objects for the 3D scene
+	void BuildSceneObjects();
+	// use the object of the passed in node as an occluder
+	void SetOccluder(NodeID node);
+	// start rasterizing the occluders for the current frame
+	void BeginOcclusionCulling(const glm::mat4& viewProjection);
+	// recalculate the world bounds of the objects that moved,
+	// or of all objects when the passed in flag is set
+	void UpdateObjectBounds(bool bAllObjects);
+	// choose the level of detail of the visible objects from
+	// their size on the screen
+	void SelectMeshLods(const glm::mat4& projection);
+	// view space distance from the camera to the passed in point
+	float CalculateViewDepth(const glm::vec3& position) const;
+
+	// render queue callbacks for collecting and drawing batches
+	void PrepareBatch(const RenderQueue::DRAW_PACKET* const* ppPackets, size_t nPackets);
+	void SubmitBatches();
+	void DrawBatch(size_t batchIndex);
 
 public:
 
@@ -105,6 +338,37 @@ public:
 	// customize for their own 3D scene
 	void PrepareScene();
 	void RenderScene();
+	// upload the texture images that finished decoding
+	void UpdateTextures();
+	// get the render queue counters for the last frame
+	const RenderQueue::STATS& GetRenderQueueStats() const;
+	// get the number of world matrices recomputed for the last frame
+	int GetTransformUpdateCount() const;
+	// get the frustum culling counters for the last frame
+	const FrustumCuller::STATS& GetCullingStats() const;
+	// get the occlusion culling counters for the last frame
+	const OcclusionCuller::STATS& GetOcclusionStats() const;
+	// get the light cluster counters for the last frame
+	const LightGrid::STATS& GetLightGridStats() const;
+	// get the number of objects drawn at a level of detail for the last frame
+	int GetLodObjectCount(int lod) const;
+	// get the post-transform cache counters of the loaded meshes
+	const ShapeMeshes::OptimizationStats& GetMeshOptimizationStats() const;
+	// enable or disable the mesh cache files, before the scene is prepared
+	void SetMeshCacheEnabled(bool bEnabled);
+	// get the mesh cache counters of the loaded meshes
+	const ShapeMeshes::MeshCacheStats& GetMeshCacheStats() const;
+	// enable or disable the compressed texture cache, before the scene is prepared
+	void SetTextureCacheEnabled(bool bEnabled);
+	// draw the objects into a G-buffer and light each pixel once,
+	// instead of lighting every drawn fragment, before the scene is prepared
+	void SetDeferredShading(bool bEnabled);
+	// check whether the scene is drawn with deferred shading
+	bool IsDeferredShading() const;
+	// get the milliseconds the GPU spent on the scene passes of a recent frame
+	double GetSceneGpuTime() const;
+	// move the coffee mug, together with all of its parts
+	void MoveMug(glm::vec3 positionXYZ);
 	// pre-set light sources for 3D scene
 	void SetupSceneLights();
 	// pre-define the object materials for lighting
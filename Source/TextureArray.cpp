@@ -0,0 +1,530 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearray.cpp
+// ============
+// store all of the scene textures as the layers of one 2D array texture
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureArray.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of layers allocated when the first image is added
+	const GLsizei g_InitialLayerCapacity = 8;
+
+	// source pixels and weights that make up each destination
+	// pixel along one axis of a resampled image
+	struct FILTER_TAPS
+	{
+		std::vector<int> first;		// first source pixel
+		std::vector<int> count;		// number of source pixels
+		std::vector<int> offset;	// start of the weights
+		std::vector<float> weights;
+	};
+
+	/***********************************************************
+	 *  BuildFilterTaps()
+	 *
+	 *  This function is used to build the filter taps for
+	 *  resampling one axis.  When shrinking, each destination
+	 *  pixel is the average of the source pixels it covers,
+	 *  and when growing it is interpolated between the two
+	 *  nearest source pixels.
+	 ***********************************************************/
+	void BuildFilterTaps(int sourceLength, int destinationLength, FILTER_TAPS& taps)
+	{
+		float scale = (float)sourceLength / (float)destinationLength;
+
+		taps.first.resize(destinationLength);
+		taps.count.resize(destinationLength);
+		taps.offset.resize(destinationLength);
+		taps.weights.clear();
+
+		for (int i = 0; i < destinationLength; i++)
+		{
+			taps.offset[i] = (int)taps.weights.size();
+
+			if (scale > 1.0f)
+			{
+				int first = (int)(i * scale);
+				int last = (int)((i + 1) * scale);
+				if (last > sourceLength) last = sourceLength;
+				if (last <= first) last = first + 1;
+
+				taps.first[i] = first;
+				taps.count[i] = last - first;
+				for (int s = first; s < last; s++)
+				{
+					taps.weights.push_back(1.0f / (float)(last - first));
+				}
+			}
+			else
+			{
+				float position = ((i + 0.5f) * scale) - 0.5f;
+				if (position < 0.0f) position = 0.0f;
+				if (position > (float)(sourceLength - 1)) position = (float)(sourceLength - 1);
+
+				int first = (int)position;
+				float t = position - (float)first;
+
+				taps.first[i] = first;
+				if (first + 1 < sourceLength)
+				{
+					taps.count[i] = 2;
+					taps.weights.push_back(1.0f - t);
+					taps.weights.push_back(t);
+				}
+				else
+				{
+					taps.count[i] = 1;
+					taps.weights.push_back(1.0f);
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  ResampleImage()
+	 *
+	 *  This function is used to resample an image with 1 to 4
+	 *  color channels into a square RGBA image.  Grey images
+	 *  are expanded to all three colors, and images without
+	 *  an alpha channel are made opaque.
+	 ***********************************************************/
+	void ResampleImage(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		int colorChannels,
+		int size,
+		unsigned char* pDestination)
+	{
+		FILTER_TAPS columnTaps;
+		FILTER_TAPS rowTaps;
+		BuildFilterTaps(width, size, columnTaps);
+		BuildFilterTaps(height, size, rowTaps);
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+				for (int ty = 0; ty < rowTaps.count[y]; ty++)
+				{
+					const unsigned char* pRow = pPixels +
+						((size_t)(rowTaps.first[y] + ty) * width * colorChannels);
+					float rowWeight = rowTaps.weights[rowTaps.offset[y] + ty];
+
+					for (int tx = 0; tx < columnTaps.count[x]; tx++)
+					{
+						const unsigned char* pSource = pRow + ((size_t)(columnTaps.first[x] + tx) * colorChannels);
+						float weight = rowWeight * columnTaps.weights[columnTaps.offset[x] + tx];
+
+						if (colorChannels >= 3)
+						{
+							color[0] += weight * pSource[0];
+							color[1] += weight * pSource[1];
+							color[2] += weight * pSource[2];
+						}
+						else
+						{
+							color[0] += weight * pSource[0];
+							color[1] += weight * pSource[0];
+							color[2] += weight * pSource[0];
+						}
+
+						if ((colorChannels == 2) || (colorChannels == 4))
+						{
+							color[3] += weight * pSource[colorChannels - 1];
+						}
+						else
+						{
+							color[3] += weight * 255.0f;
+						}
+					}
+				}
+
+				unsigned char* pTarget = pDestination + (((size_t)y * size + x) * 4);
+				for (int c = 0; c < 4; c++)
+				{
+					float value = color[c] + 0.5f;
+					if (value > 255.0f) value = 255.0f;
+					pTarget[c] = (unsigned char)value;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  TextureArray()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureArray::TextureArray(GLsizei layerSize)
+{
+	m_textureID = 0;
+	m_layerSize = (layerSize > 0) ? layerSize : DEFAULT_LAYER_SIZE;
+	m_layerCapacity = 0;
+	m_layerCount = 0;
+	m_bCompressed = false;
+
+	// a full mipmap chain down to 1x1
+	m_mipLevels = 1;
+	for (GLsizei size = m_layerSize; size > 1; size /= 2)
+	{
+		m_mipLevels++;
+	}
+}
+
+/***********************************************************
+ *  ~TextureArray()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureArray::~TextureArray()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  AddImage()
+ *
+ *  This method is used to resample an image to the layer
+ *  size and upload it into the next free layer.  Images
+ *  of any size and aspect ratio are stretched over the
+ *  whole layer, so texture coordinates keep mapping to
+ *  the same part of the image.
+ ***********************************************************/
+int TextureArray::AddImage(
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	int colorChannels)
+{
+	if (false == ResampleToLayer(pPixels, width, height, colorChannels, m_layerSize, m_layerPixels))
+	{
+		std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+		return(-1);
+	}
+
+	if (m_bCompressed == true)
+	{
+		std::cout << "Images have to be cooked to be added to a compressed texture array" << std::endl;
+		return(-1);
+	}
+
+	int layer = AllocateLayer();
+	if (layer < 0)
+	{
+		return(-1);
+	}
+
+	UploadLayer(layer, &m_layerPixels[0]);
+
+	return(layer);
+}
+
+/***********************************************************
+ *  AddSolidLayer()
+ *
+ *  This method is used to add a layer that is filled with
+ *  a single color, which stands in for an image until the
+ *  image is set with SetLayerPixels().
+ ***********************************************************/
+int TextureArray::AddSolidLayer(const unsigned char color[4])
+{
+	int layer = AllocateLayer();
+	if (layer < 0)
+	{
+		return(-1);
+	}
+
+	m_layerPixels.resize((size_t)m_layerSize * m_layerSize * 4);
+	for (size_t i = 0; i < m_layerPixels.size(); i += 4)
+	{
+		m_layerPixels[i + 0] = color[0];
+		m_layerPixels[i + 1] = color[1];
+		m_layerPixels[i + 2] = color[2];
+		m_layerPixels[i + 3] = color[3];
+	}
+
+	if (m_bCompressed == true)
+	{
+		// every block of every level is the same, so only one
+		// block is compressed and repeated
+		std::vector<unsigned char> block;
+		TextureCooker::CompressBC1(&m_layerPixels[0], 4, 4, block);
+
+		TextureCooker::MIP_LEVELS compressedLevels(m_mipLevels);
+		GLsizei levelSize = m_layerSize;
+		for (GLsizei level = 0; level < m_mipLevels; level++)
+		{
+			size_t levelBytes = TextureCooker::GetCompressedLevelSize(levelSize, levelSize);
+			for (size_t offset = 0; offset < levelBytes; offset += block.size())
+			{
+				compressedLevels[level].insert(compressedLevels[level].end(), block.begin(), block.end());
+			}
+			levelSize = (levelSize > 1) ? (levelSize / 2) : 1;
+		}
+		SetCompressedLayer(layer, compressedLevels);
+	}
+	else
+	{
+		UploadLayer(layer, &m_layerPixels[0]);
+	}
+
+	return(layer);
+}
+
+/***********************************************************
+ *  SetLayerPixels()
+ *
+ *  This method is used to replace the pixels of a layer
+ *  that was already added.  The mipmaps of the layer are
+ *  stale until GenerateMipmaps() is called.
+ ***********************************************************/
+bool TextureArray::SetLayerPixels(int layer, const unsigned char* pLayerPixels)
+{
+	if ((NULL == pLayerPixels) || (layer < 0) || (layer >= m_layerCount) || (m_bCompressed == true))
+	{
+		return(false);
+	}
+
+	UploadLayer(layer, pLayerPixels);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetCompressedLayer()
+ *
+ *  This method is used to upload the cooked mipmap chain
+ *  of a layer, one compressed level at a time, so no
+ *  mipmaps are generated for it.
+ ***********************************************************/
+bool TextureArray::SetCompressedLayer(int layer, const TextureCooker::MIP_LEVELS& compressedLevels)
+{
+	if ((layer < 0) || (layer >= m_layerCount) || (m_bCompressed == false) ||
+		(compressedLevels.size() != (size_t)m_mipLevels))
+	{
+		return(false);
+	}
+
+	GLsizei levelSize = m_layerSize;
+	for (GLsizei level = 0; level < m_mipLevels; level++)
+	{
+		if (compressedLevels[level].size() != TextureCooker::GetCompressedLevelSize(levelSize, levelSize))
+		{
+			return(false);
+		}
+		levelSize = (levelSize > 1) ? (levelSize / 2) : 1;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+	levelSize = m_layerSize;
+	for (GLsizei level = 0; level < m_mipLevels; level++)
+	{
+		glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+			levelSize, levelSize, 1, TextureCooker::COOKED_FORMAT,
+			(GLsizei)compressedLevels[level].size(), &compressedLevels[level][0]);
+		levelSize = (levelSize > 1) ? (levelSize / 2) : 1;
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetCompressed()
+ *
+ *  This method is used to choose between the RGBA8 and the
+ *  cooked compressed storage, which cannot change once a
+ *  layer was added.
+ ***********************************************************/
+bool TextureArray::SetCompressed(bool bCompressed)
+{
+	if (m_layerCount > 0)
+	{
+		return(bCompressed == m_bCompressed);
+	}
+
+	m_bCompressed = bCompressed;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ResampleToLayer()
+ *
+ *  This method is used to resample an image into the RGBA
+ *  pixels of a layer with the passed in size.  Images of
+ *  any size and aspect ratio are stretched over the whole
+ *  layer.
+ ***********************************************************/
+bool TextureArray::ResampleToLayer(
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	int colorChannels,
+	GLsizei layerSize,
+	std::vector<unsigned char>& layerPixels)
+{
+	if ((NULL == pPixels) || (width <= 0) || (height <= 0) ||
+		(colorChannels < 1) || (colorChannels > 4) || (layerSize <= 0))
+	{
+		return(false);
+	}
+
+	layerPixels.resize((size_t)layerSize * layerSize * 4);
+	ResampleImage(pPixels, width, height, colorChannels, layerSize, &layerPixels[0]);
+
+	return(true);
+}
+
+/***********************************************************
+ *  GenerateMipmaps()
+ *
+ *  This method is used to generate the mipmaps of all the
+ *  layers for mapping the textures to lower resolutions.
+ ***********************************************************/
+void TextureArray::GenerateMipmaps()
+{
+	// the compressed layers come with their mipmaps
+	if ((0 == m_textureID) || (m_bCompressed == true))
+	{
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used to bind the array texture to the
+ *  passed in texture unit.
+ ***********************************************************/
+void TextureArray::Bind(GLuint textureUnit) const
+{
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to free the array texture.
+ ***********************************************************/
+void TextureArray::Destroy()
+{
+	if (0 != m_textureID)
+	{
+		glDeleteTextures(1, &m_textureID);
+		m_textureID = 0;
+	}
+	m_layerCapacity = 0;
+	m_layerCount = 0;
+	m_layerPixels.clear();
+}
+
+/***********************************************************
+ *  AllocateLayer()
+ *
+ *  This method is used to take the next free layer, and
+ *  to double the storage first when all layers are used.
+ ***********************************************************/
+int TextureArray::AllocateLayer()
+{
+	if (m_layerCount >= m_layerCapacity)
+	{
+		GLsizei layerCapacity = (m_layerCapacity > 0) ? (m_layerCapacity * 2) : g_InitialLayerCapacity;
+		if (false == Grow(layerCapacity))
+		{
+			return(-1);
+		}
+	}
+
+	return(m_layerCount++);
+}
+
+/***********************************************************
+ *  UploadLayer()
+ *
+ *  This method is used to upload the full resolution
+ *  pixels of a layer.
+ ***********************************************************/
+void TextureArray::UploadLayer(int layer, const unsigned char* pLayerPixels)
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureID);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+		m_layerSize, m_layerSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, pLayerPixels);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  Grow()
+ *
+ *  This method is used to allocate new storage for the
+ *  passed in number of layers.  The layers that were
+ *  already added are copied into the new storage on the
+ *  GPU, with all of their mipmap levels.
+ ***********************************************************/
+bool TextureArray::Grow(GLsizei layerCapacity)
+{
+	GLuint textureID = 0;
+	GLint maxLayers = 0;
+
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	if ((maxLayers > 0) && (layerCapacity > maxLayers))
+	{
+		layerCapacity = maxLayers;
+	}
+	if (layerCapacity <= m_layerCapacity)
+	{
+		std::cout << "Texture array is full with " << m_layerCount << " layers" << std::endl;
+		return(false);
+	}
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_mipLevels,
+		(m_bCompressed == true) ? TextureCooker::COOKED_FORMAT : GL_RGBA8,
+		m_layerSize, m_layerSize, layerCapacity);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	if ((0 != m_textureID) && (m_layerCount > 0))
+	{
+		GLsizei levelSize = m_layerSize;
+		for (GLint level = 0; level < m_mipLevels; level++)
+		{
+			glCopyImageSubData(
+				m_textureID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				textureID, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				levelSize, levelSize, m_layerCount);
+			levelSize = (levelSize > 1) ? (levelSize / 2) : 1;
+		}
+	}
+
+	if (0 != m_textureID)
+	{
+		glDeleteTextures(1, &m_textureID);
+	}
+
+	m_textureID = textureID;
+	m_layerCapacity = layerCapacity;
+
+	return(true);
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearray.h
+// ============
+// store all of the scene textures as the layers of one 2D array texture
+//
+// Every image is resampled to the same square layer size when it is added,
+// so any number of textures can be used through a single texture unit.  Draws
+// select their texture with a layer index instead of a texture binding, which
+// means that switching textures between draws needs no state change at all.
+// The layers are either RGBA8 with mipmaps generated on the GPU, or BC1 with
+// the cooked mipmap chains uploaded as they are.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureCooker.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  TextureArray
+ *
+ *  This class contains the code for packing texture images
+ *  into the layers of a GL_TEXTURE_2D_ARRAY texture.
+ ***********************************************************/
+class TextureArray
+{
+public:
+	// default width and height of every layer
+	static const GLsizei DEFAULT_LAYER_SIZE = 1024;
+
+	// constructor
+	TextureArray(GLsizei layerSize = DEFAULT_LAYER_SIZE);
+	// destructor
+	~TextureArray();
+
+	// add an image as a new layer and return the layer index, or -1
+	// when the image could not be added.  The storage grows as needed.
+	int AddImage(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		int colorChannels);
+	// add a layer filled with one RGBA color and return its index, or -1.
+	// It holds the place of an image that is still being loaded.
+	int AddSolidLayer(const unsigned char color[4]);
+	// replace the pixels of an added layer with an image that was
+	// already resampled to the layer size, by ResampleToLayer()
+	bool SetLayerPixels(int layer, const unsigned char* pLayerPixels);
+	// replace all mipmap levels of an added layer of a compressed
+	// array with the levels cooked by TextureCooker::CookLayer()
+	bool SetCompressedLayer(int layer, const TextureCooker::MIP_LEVELS& compressedLevels);
+	// store the layers compressed, only before the first layer is added
+	bool SetCompressed(bool bCompressed);
+	// generate the mipmaps of all layers, once the images are added
+	void GenerateMipmaps();
+	// bind the array texture to the passed in texture unit
+	void Bind(GLuint textureUnit) const;
+	// free the array texture and all of its layers
+	void Destroy();
+
+	// get the OpenGL name of the array texture
+	GLuint GetTextureID() const { return m_textureID; }
+	// get the number of layers that hold an image
+	int GetLayerCount() const { return m_layerCount; }
+	// get the width and height of the layers
+	GLsizei GetLayerSize() const { return m_layerSize; }
+	// check whether the layers are stored compressed
+	bool IsCompressed() const { return m_bCompressed; }
+
+	// resample an image with 1 to 4 color channels into the square RGBA
+	// pixels of a layer.  It uses no OpenGL, so it can run on any thread.
+	static bool ResampleToLayer(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		int colorChannels,
+		GLsizei layerSize,
+		std::vector<unsigned char>& layerPixels);
+
+private:
+	// OpenGL name of the array texture
+	GLuint m_textureID;
+	// width and height of every layer
+	GLsizei m_layerSize;
+	// number of mipmap levels of every layer
+	GLsizei m_mipLevels;
+	// number of layers the storage was allocated for
+	GLsizei m_layerCapacity;
+	// number of layers that hold an image
+	int m_layerCount;
+	// the layers are stored in the cooked compressed format
+	bool m_bCompressed;
+	// resampled RGBA pixels of the layer being added
+	std::vector<unsigned char> m_layerPixels;
+
+	// reallocate the storage for more layers, keeping the added ones
+	bool Grow(GLsizei layerCapacity);
+	// take the next free layer, growing the storage when it is full
+	int AllocateLayer();
+	// upload the layer sized RGBA pixels into a layer
+	void UploadLayer(int layer, const unsigned char* pLayerPixels);
+};
@@ -0,0 +1,451 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecooker.cpp
+// ============
+// convert the texture images into block compressed, pre-mipmapped cache files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCooker.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// declaration of global variables
+namespace
+{
+	// identifier at the start of every KTX 1.1 file
+	const unsigned char g_KtxIdentifier[12] =
+	{
+		0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+	};
+	// written as a number, to detect files of the other byte order
+	const uint32_t g_KtxEndianness = 0x04030201;
+	// key of the hash of the image file the texture was cooked from
+	const char g_SourceHashKey[] = "SourceHash";
+
+	// the fixed size header of a KTX 1.1 file, after the identifier
+	struct KTX_HEADER
+	{
+		uint32_t endianness;
+		uint32_t glType;
+		uint32_t glTypeSize;
+		uint32_t glFormat;
+		uint32_t glInternalFormat;
+		uint32_t glBaseInternalFormat;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t numberOfArrayElements;
+		uint32_t numberOfFaces;
+		uint32_t numberOfMipmapLevels;
+		uint32_t bytesOfKeyValueData;
+	};
+
+	/***********************************************************
+	 *  GetMipLevelCount()
+	 *
+	 *  This function is used to get the number of levels of a
+	 *  full mipmap chain, down to 1x1.
+	 ***********************************************************/
+	int GetMipLevelCount(int size)
+	{
+		int levels = 1;
+		while (size > 1)
+		{
+			size /= 2;
+			levels++;
+		}
+		return(levels);
+	}
+
+	/***********************************************************
+	 *  PackColor565()
+	 *
+	 *  This function is used to round an 8 bit color to the
+	 *  5:6:5 bits of a BC1 endpoint.
+	 ***********************************************************/
+	uint16_t PackColor565(const int color[3])
+	{
+		int r = (color[0] * 31 + 127) / 255;
+		int g = (color[1] * 63 + 127) / 255;
+		int b = (color[2] * 31 + 127) / 255;
+		return((uint16_t)((r << 11) | (g << 5) | b));
+	}
+
+	/***********************************************************
+	 *  UnpackColor565()
+	 *
+	 *  This function is used to expand a BC1 endpoint back to
+	 *  8 bits per channel, the way the GPU decodes it.
+	 ***********************************************************/
+	void UnpackColor565(uint16_t packed, int color[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	/***********************************************************
+	 *  CompressBlock()
+	 *
+	 *  This function is used to compress a 4x4 block of RGBA
+	 *  pixels into 8 bytes.  The endpoints are the corners of
+	 *  the bounding box of the block colors, inset by a
+	 *  sixteenth so the rarely used extremes do not stretch
+	 *  the palette, and each pixel takes the closest of the
+	 *  four palette colors.
+	 ***********************************************************/
+	void CompressBlock(const unsigned char block[64], unsigned char output[8])
+	{
+		int minimum[3] = { 255, 255, 255 };
+		int maximum[3] = { 0, 0, 0 };
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				int value = block[(i * 4) + c];
+				if (value < minimum[c]) minimum[c] = value;
+				if (value > maximum[c]) maximum[c] = value;
+			}
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			int inset = (maximum[c] - minimum[c]) >> 4;
+			minimum[c] += inset;
+			maximum[c] -= inset;
+		}
+
+		uint16_t color0 = PackColor565(maximum);
+		uint16_t color1 = PackColor565(minimum);
+		if (color0 < color1)
+		{
+			uint16_t swapped = color0;
+			color0 = color1;
+			color1 = swapped;
+		}
+
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			// the four color mode needs the first endpoint to be larger
+			int palette[4][3];
+			UnpackColor565(color0, palette[0]);
+			UnpackColor565(color1, palette[1]);
+			for (int c = 0; c < 3; c++)
+			{
+				palette[2][c] = ((2 * palette[0][c]) + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + (2 * palette[1][c])) / 3;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				int bestDistance = 0x7FFFFFFF;
+				for (int p = 0; p < 4; p++)
+				{
+					int distance = 0;
+					for (int c = 0; c < 3; c++)
+					{
+						int delta = block[(i * 4) + c] - palette[p][c];
+						distance += delta * delta;
+					}
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+				indices |= (uint32_t)bestIndex << (i * 2);
+			}
+		}
+
+		output[0] = (unsigned char)(color0 & 0xFF);
+		output[1] = (unsigned char)(color0 >> 8);
+		output[2] = (unsigned char)(color1 & 0xFF);
+		output[3] = (unsigned char)(color1 >> 8);
+		output[4] = (unsigned char)(indices & 0xFF);
+		output[5] = (unsigned char)((indices >> 8) & 0xFF);
+		output[6] = (unsigned char)((indices >> 16) & 0xFF);
+		output[7] = (unsigned char)(indices >> 24);
+	}
+}
+
+/***********************************************************
+ *  GetCompressedLevelSize()
+ *
+ *  This function is used to get the number of bytes of a
+ *  level, which is 8 bytes for each started 4x4 block.
+ ***********************************************************/
+size_t TextureCooker::GetCompressedLevelSize(int width, int height)
+{
+	size_t blocksX = (size_t)((width + 3) / 4);
+	size_t blocksY = (size_t)((height + 3) / 4);
+	return(blocksX * blocksY * 8);
+}
+
+/***********************************************************
+ *  HashBytes()
+ *
+ *  This function is used to get the 64 bit FNV-1a hash of
+ *  the contents of an image file.
+ ***********************************************************/
+uint64_t TextureCooker::HashBytes(const unsigned char* pBytes, size_t size)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= pBytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return(hash);
+}
+
+/***********************************************************
+ *  BuildMipChain()
+ *
+ *  This function is used to build the mipmap levels of a
+ *  square RGBA image, each one the 2x2 box filtered half
+ *  of the level before it.
+ ***********************************************************/
+void TextureCooker::BuildMipChain(const unsigned char* pPixels, int size, MIP_LEVELS& levels)
+{
+	levels.assign(1, std::vector<unsigned char>(pPixels, pPixels + ((size_t)size * size * 4)));
+
+	for (int levelSize = size; levelSize > 1; levelSize /= 2)
+	{
+		const std::vector<unsigned char>& source = levels.back();
+		const int nextSize = levelSize / 2;
+		std::vector<unsigned char> next((size_t)nextSize * nextSize * 4);
+
+		for (int y = 0; y < nextSize; y++)
+		{
+			for (int x = 0; x < nextSize; x++)
+			{
+				const unsigned char* pTop = &source[(((size_t)(y * 2) * levelSize) + (x * 2)) * 4];
+				const unsigned char* pBottom = pTop + ((size_t)levelSize * 4);
+				for (int c = 0; c < 4; c++)
+				{
+					next[(((size_t)y * nextSize) + x) * 4 + c] = (unsigned char)
+						((pTop[c] + pTop[4 + c] + pBottom[c] + pBottom[4 + c] + 2) / 4);
+				}
+			}
+		}
+
+		levels.push_back(next);
+	}
+}
+
+/***********************************************************
+ *  CompressBC1()
+ *
+ *  This function is used to compress an RGBA image block
+ *  by block.  Images smaller than a block repeat their
+ *  edge pixels to fill it.
+ ***********************************************************/
+void TextureCooker::CompressBC1(
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	std::vector<unsigned char>& blocks)
+{
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+	unsigned char block[64];
+
+	blocks.resize(GetCompressedLevelSize(width, height));
+
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int x = (bx * 4) + (i % 4);
+				int y = (by * 4) + (i / 4);
+				if (x >= width) x = width - 1;
+				if (y >= height) y = height - 1;
+				memcpy(&block[i * 4], &pPixels[(((size_t)y * width) + x) * 4], 4);
+			}
+			CompressBlock(block, &blocks[(((size_t)by * blocksX) + bx) * 8]);
+		}
+	}
+}
+
+/***********************************************************
+ *  CookLayer()
+ *
+ *  This function is used to build the mipmap chain of a
+ *  layer and compress every level of it.
+ ***********************************************************/
+void TextureCooker::CookLayer(const unsigned char* pPixels, int size, MIP_LEVELS& compressedLevels)
+{
+	MIP_LEVELS levels;
+	BuildMipChain(pPixels, size, levels);
+
+	compressedLevels.resize(levels.size());
+	int levelSize = size;
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		CompressBC1(&levels[level][0], levelSize, levelSize, compressedLevels[level]);
+		levelSize = (levelSize > 1) ? (levelSize / 2) : 1;
+	}
+}
+
+/***********************************************************
+ *  WriteCookedTexture()
+ *
+ *  This function is used to write a cooked texture into a
+ *  KTX file.  The file is written under a temporary name
+ *  and renamed when it is complete, so an interrupted run
+ *  does not leave a broken file behind.
+ ***********************************************************/
+bool TextureCooker::WriteCookedTexture(
+	const std::string& path,
+	int size,
+	uint64_t sourceHash,
+	const MIP_LEVELS& compressedLevels)
+{
+	const uint32_t keyAndValueSize = (uint32_t)(sizeof(g_SourceHashKey) + sizeof(sourceHash));
+	const uint32_t keyValuePadding = (4 - (keyAndValueSize % 4)) % 4;
+	const char padding[4] = { 0, 0, 0, 0 };
+
+	KTX_HEADER header = {};
+	header.endianness = g_KtxEndianness;
+	header.glTypeSize = 1;
+	header.glInternalFormat = COOKED_FORMAT;
+	header.glBaseInternalFormat = GL_RGB;
+	header.pixelWidth = (uint32_t)size;
+	header.pixelHeight = (uint32_t)size;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = (uint32_t)compressedLevels.size();
+	header.bytesOfKeyValueData = (uint32_t)sizeof(keyAndValueSize) + keyAndValueSize + keyValuePadding;
+
+	const std::string temporaryPath = path + ".tmp";
+	std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return(false);
+	}
+
+	file.write((const char*)g_KtxIdentifier, sizeof(g_KtxIdentifier));
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)&keyAndValueSize, sizeof(keyAndValueSize));
+	file.write(g_SourceHashKey, sizeof(g_SourceHashKey));
+	file.write((const char*)&sourceHash, sizeof(sourceHash));
+	file.write(padding, keyValuePadding);
+
+	// BC1 levels are multiples of 8 bytes, so they need no padding
+	for (size_t level = 0; level < compressedLevels.size(); level++)
+	{
+		uint32_t imageSize = (uint32_t)compressedLevels[level].size();
+		file.write((const char*)&imageSize, sizeof(imageSize));
+		file.write((const char*)&compressedLevels[level][0], imageSize);
+	}
+
+	file.close();
+	if (!file)
+	{
+		remove(temporaryPath.c_str());
+		return(false);
+	}
+
+	remove(path.c_str());
+	if (rename(temporaryPath.c_str(), path.c_str()) != 0)
+	{
+		remove(temporaryPath.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadCookedTexture()
+ *
+ *  This function is used to read a cooked texture from a
+ *  KTX file, when it matches the layer size, the format
+ *  and the hash of the image file.
+ ***********************************************************/
+bool TextureCooker::ReadCookedTexture(
+	const std::string& path,
+	int size,
+	uint64_t sourceHash,
+	MIP_LEVELS& compressedLevels)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if (!file)
+	{
+		return(false);
+	}
+
+	unsigned char identifier[sizeof(g_KtxIdentifier)];
+	KTX_HEADER header;
+	file.read((char*)identifier, sizeof(identifier));
+	file.read((char*)&header, sizeof(header));
+	if ((!file) ||
+		(memcmp(identifier, g_KtxIdentifier, sizeof(identifier)) != 0) ||
+		(header.endianness != g_KtxEndianness) ||
+		(header.glInternalFormat != COOKED_FORMAT) ||
+		(header.pixelWidth != (uint32_t)size) ||
+		(header.pixelHeight != (uint32_t)size) ||
+		(header.numberOfArrayElements != 0) ||
+		(header.numberOfFaces != 1) ||
+		(header.numberOfMipmapLevels != (uint32_t)GetMipLevelCount(size)) ||
+		(header.bytesOfKeyValueData > 4096))
+	{
+		return(false);
+	}
+
+	// the texture is stale unless it was cooked from the same image file
+	std::vector<char> keyValueData(header.bytesOfKeyValueData);
+	if (header.bytesOfKeyValueData > 0)
+	{
+		file.read(&keyValueData[0], keyValueData.size());
+	}
+	bool bHashMatches = false;
+	size_t offset = 0;
+	while ((!!file) && (offset + sizeof(uint32_t) <= keyValueData.size()))
+	{
+		uint32_t keyAndValueSize = 0;
+		memcpy(&keyAndValueSize, &keyValueData[offset], sizeof(keyAndValueSize));
+		offset += sizeof(keyAndValueSize);
+		if (keyAndValueSize > keyValueData.size() - offset)
+		{
+			break;
+		}
+
+		if ((keyAndValueSize == sizeof(g_SourceHashKey) + sizeof(sourceHash)) &&
+			(memcmp(&keyValueData[offset], g_SourceHashKey, sizeof(g_SourceHashKey)) == 0))
+		{
+			uint64_t storedHash = 0;
+			memcpy(&storedHash, &keyValueData[offset + sizeof(g_SourceHashKey)], sizeof(storedHash));
+			bHashMatches = (storedHash == sourceHash);
+		}
+		offset += (keyAndValueSize + 3) & ~3u;
+	}
+	if (bHashMatches == false)
+	{
+		return(false);
+	}
+
+	compressedLevels.resize(header.numberOfMipmapLevels);
+	int levelSize = size;
+	for (size_t level = 0; level < compressedLevels.size(); level++)
+	{
+		uint32_t imageSize = 0;
+		file.read((char*)&imageSize, sizeof(imageSize));
+		if ((!file) || (imageSize != GetCompressedLevelSize(levelSize, levelSize)))
+		{
+			return(false);
+		}
+
+		compressedLevels[level].resize(imageSize);
+		file.read((char*)&compressedLevels[level][0], imageSize);
+		levelSize = (levelSize > 1) ? (levelSize / 2) : 1;
+	}
+
+	return(!!file);
+}
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecooker.h
+// ============
+// convert the texture images into block compressed, pre-mipmapped cache files
+//
+// A texture layer is cooked once into a full chain of BC1 (DXT1) mipmap levels
+// and stored in a KTX 1.1 file, together with a hash of the image file it was
+// made from.  Later runs upload the compressed levels directly, which skips
+// the JPEG decode, the resampling and the mipmap generation, and takes an
+// eighth of the memory of the RGBA layers.  A cache file whose hash does not
+// match its image file any more is stale, and the image is cooked again.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TextureCooker
+{
+	// the pixels or compressed blocks of each mipmap level, largest first
+	typedef std::vector<std::vector<unsigned char> > MIP_LEVELS;
+
+	// the compressed format of the cooked textures
+	const GLenum COOKED_FORMAT = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+	// get the number of bytes of a BC1 compressed level
+	size_t GetCompressedLevelSize(int width, int height);
+	// get the hash of the contents of an image file
+	uint64_t HashBytes(const unsigned char* pBytes, size_t size);
+
+	// build the RGBA mipmap chain of a square RGBA image, down to 1x1,
+	// the first level is a copy of the image
+	void BuildMipChain(const unsigned char* pPixels, int size, MIP_LEVELS& levels);
+	// compress an RGBA image into BC1 blocks, the alpha is ignored
+	void CompressBC1(const unsigned char* pPixels, int width, int height, std::vector<unsigned char>& blocks);
+	// cook a square RGBA layer into its compressed mipmap chain
+	void CookLayer(const unsigned char* pPixels, int size, MIP_LEVELS& compressedLevels);
+
+	// write the compressed levels of a square texture into a KTX file
+	bool WriteCookedTexture(
+		const std::string& path,
+		int size,
+		uint64_t sourceHash,
+		const MIP_LEVELS& compressedLevels);
+	// read the compressed levels of a square texture from a KTX file,
+	// fails when the file is missing, has a different size or format,
+	// or was cooked from a different image file
+	bool ReadCookedTexture(
+		const std::string& path,
+		int size,
+		uint64_t sourceHash,
+		MIP_LEVELS& compressedLevels);
+}
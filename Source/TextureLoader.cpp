@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode the texture image files on a pool of worker threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+#include "TextureArray.h"
+
+#include "stb_image.h"
+
+#include <fstream>
+#include <iterator>
+
+// declaration of global variables
+namespace
+{
+	// the scene loads a handful of textures, more workers than
+	// this would only wait for the disk
+	const int g_MaxWorkerCount = 8;
+}
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLoader::TextureLoader(int workerCount)
+{
+	m_bStopping = false;
+	m_bCook = false;
+
+	if (workerCount <= 0)
+	{
+		// leave one processor for the thread that renders
+		workerCount = (int)std::thread::hardware_concurrency() - 1;
+	}
+	if (workerCount < 1) workerCount = 1;
+	if (workerCount > g_MaxWorkerCount) workerCount = g_MaxWorkerCount;
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureLoader::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_jobCondition.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		if (m_workers[i].joinable())
+		{
+			m_workers[i].join();
+		}
+	}
+}
+
+/***********************************************************
+ *  SetCooking()
+ *
+ *  This method is used to switch the following requests
+ *  between the RGBA layer pixels and the compressed
+ *  mipmap chains.
+ ***********************************************************/
+void TextureLoader::SetCooking(bool bCook, const std::string& cacheDirectory)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_bCook = bCook;
+	m_cacheDirectory = cacheDirectory;
+}
+
+/***********************************************************
+ *  Decode()
+ *
+ *  This method is used to queue an image file for the next
+ *  free worker thread.  The file is read when the worker
+ *  takes the job, not when it is queued.
+ ***********************************************************/
+std::future<TextureLoader::DECODED_IMAGE> TextureLoader::Decode(
+	const std::string& filename,
+	GLsizei layerSize)
+{
+	DECODE_JOB job;
+	job.filename = filename;
+	job.layerSize = layerSize;
+	std::future<DECODED_IMAGE> result = job.result.get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		job.bCook = m_bCook;
+		if ((m_bCook == true) && (m_cacheDirectory.empty() == false))
+		{
+			// the cooked file is named after the image file
+			size_t nameStart = filename.find_last_of("/\\");
+			nameStart = (nameStart == std::string::npos) ? 0 : (nameStart + 1);
+			size_t nameEnd = filename.find_last_of('.');
+			if ((nameEnd == std::string::npos) || (nameEnd < nameStart))
+			{
+				nameEnd = filename.size();
+			}
+			job.cacheFilename = m_cacheDirectory + "/" + filename.substr(nameStart, nameEnd - nameStart) + ".ktx";
+		}
+		m_jobs.push_back(std::move(job));
+	}
+	m_jobCondition.notify_one();
+
+	return(result);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by each worker thread.  It takes the
+ *  queued image files one at a time, until the loader is
+ *  destroyed.
+ ***********************************************************/
+void TextureLoader::WorkerLoop()
+{
+	// the images are flipped to match the texture coordinates,
+	// the setting of the loading thread is used by stb_image
+	stbi_set_flip_vertically_on_load_thread(1);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	for (;;)
+	{
+		while ((m_jobs.empty() == true) && (m_bStopping == false))
+		{
+			m_jobCondition.wait(lock);
+		}
+		if (m_bStopping == true)
+		{
+			return;
+		}
+
+		DECODE_JOB job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+
+		lock.unlock();
+		DECODED_IMAGE image;
+		DecodeImage(job, image);
+		job.result.set_value(std::move(image));
+		lock.lock();
+	}
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used to read an image file and resample
+ *  it to the texture array layer size.  A cooked image is
+ *  read from its cache file instead, unless the image file
+ *  changed since it was cooked, in which case it is
+ *  decoded and cooked again and the cache file replaced.
+ ***********************************************************/
+void TextureLoader::DecodeImage(
+	const DECODE_JOB& job,
+	DECODED_IMAGE& image)
+{
+	image.bLoaded = false;
+	image.bCompressed = false;
+	image.bFromCache = false;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+
+	// the file is read once, for the hash and for decoding
+	std::ifstream file(job.filename.c_str(), std::ios::binary);
+	if (!file)
+	{
+		return;
+	}
+	std::vector<unsigned char> fileBytes(
+		(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (fileBytes.empty() == true)
+	{
+		return;
+	}
+
+	uint64_t sourceHash = 0;
+	if (job.bCook == true)
+	{
+		sourceHash = TextureCooker::HashBytes(&fileBytes[0], fileBytes.size());
+		if ((job.cacheFilename.empty() == false) &&
+			(TextureCooker::ReadCookedTexture(job.cacheFilename, job.layerSize, sourceHash, image.compressedLevels) == true))
+		{
+			image.width = job.layerSize;
+			image.height = job.layerSize;
+			image.colorChannels = 3;
+			image.bCompressed = true;
+			image.bFromCache = true;
+			image.bLoaded = true;
+			return;
+		}
+	}
+
+	unsigned char* pPixels = stbi_load_from_memory(
+		&fileBytes[0],
+		(int)fileBytes.size(),
+		&image.width,
+		&image.height,
+		&image.colorChannels,
+		0);
+	if (NULL == pPixels)
+	{
+		return;
+	}
+
+	image.bLoaded = TextureArray::ResampleToLayer(
+		pPixels, image.width, image.height, image.colorChannels, job.layerSize, image.layerPixels);
+
+	stbi_image_free(pPixels);
+
+	if ((image.bLoaded == true) && (job.bCook == true))
+	{
+		TextureCooker::CookLayer(&image.layerPixels[0], job.layerSize, image.compressedLevels);
+		image.layerPixels.clear();
+		image.bCompressed = true;
+
+		if (job.cacheFilename.empty() == false)
+		{
+			TextureCooker::WriteCookedTexture(job.cacheFilename, job.layerSize, sourceHash, image.compressedLevels);
+		}
+	}
+}
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode the texture image files on a pool of worker threads
+//
+// Decoding a large JPEG and resampling it to the texture array layer size
+// takes far longer than uploading the result, so the files are decoded in
+// parallel and only the upload is left for the thread that owns the OpenGL
+// context.  Each request returns a future for the resampled layer pixels,
+// or for the compressed mipmap levels when the textures are cooked.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureCooker.h"
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  This class contains the code for decoding image files
+ *  into texture array layers on worker threads.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+	// the result of decoding one image file
+	struct DECODED_IMAGE
+	{
+		bool bLoaded;		// the file was decoded and resampled
+		bool bCompressed;	// the compressed levels hold the image
+		bool bFromCache;	// the compressed levels were read from the cache
+		int width;			// size of the image in the file, or of the
+		int height;			// layer when it was read from the cache
+		int colorChannels;
+		std::vector<unsigned char> layerPixels;	// RGBA pixels at the layer size
+		TextureCooker::MIP_LEVELS compressedLevels;	// BC1 mipmap chain at the layer size
+	};
+
+	// constructor, starts the worker threads, a count of zero
+	// uses one thread less than the number of processors
+	TextureLoader(int workerCount = 0);
+	// destructor, stops the worker threads, requests that were
+	// not started yet are abandoned
+	~TextureLoader();
+
+	// queue an image file for decoding and resampling to the
+	// passed in layer size, the future is ready once it is done
+	std::future<DECODED_IMAGE> Decode(const std::string& filename, GLsizei layerSize);
+
+	// cook the images of the following requests into compressed
+	// mipmap chains, which are read from and written to the cache
+	// directory unless it is empty
+	void SetCooking(bool bCook, const std::string& cacheDirectory);
+
+	// get the number of worker threads
+	int GetWorkerCount() const { return (int)m_workers.size(); }
+
+private:
+	// an image file waiting for a worker
+	struct DECODE_JOB
+	{
+		std::string filename;
+		GLsizei layerSize;
+		bool bCook;
+		std::string cacheFilename;
+		std::promise<DECODED_IMAGE> result;
+	};
+
+	// worker threads and their synchronization
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_jobCondition;
+	std::deque<DECODE_JOB> m_jobs;
+	bool m_bStopping;
+	// the images are cooked, and the directory of the cooked files
+	bool m_bCook;
+	std::string m_cacheDirectory;
+
+	// wait for jobs and run them on a worker thread
+	void WorkerLoop();
+	// decode and resample one image file, and cook it when requested
+	static void DecodeImage(const DECODE_JOB& job, DECODED_IMAGE& image);
+};
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexformatbenchmark.cpp
+// ============
+// compare the vertex fetch bandwidth of the float and packed vertex layouts
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VertexFormatBenchmark.h"
+
+#include <glm/glm.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_PackedVerticesName = "bPackedVertices";
+
+	// tessellation of the benchmark meshes
+	const int g_SphereRings = 512;
+	const int g_SphereSectors = 512;
+	const int g_TorusMainSegments = 256;
+	const int g_TorusTubeSegments = 256;
+
+	// number of timed draws of each mesh in each layout
+	const int g_DrawCount = 200;
+
+	// display names of the vertex layouts
+	const char* g_VertexFormatNames[ShapeMeshes::VERTEX_FORMAT_COUNT] =
+	{
+		"float",
+		"packed"
+	};
+}
+
+/***********************************************************
+ *  VertexFormatBenchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VertexFormatBenchmark::VertexFormatBenchmark(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for loading the benchmark meshes,
+ *  timing them in each vertex layout and outputting the
+ *  results.
+ ***********************************************************/
+void VertexFormatBenchmark::Run()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	meshes.LoadSphereMesh(g_SphereRings, g_SphereSectors);
+	meshes.LoadTorusMesh(0.2f, g_TorusMainSegments, g_TorusTubeSegments);
+	meshes.UploadMeshBuffers();
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value(g_ModelName, glm::mat4(1.0f));
+	m_pShaderManager->setBoolValue(g_UseInstancingName, false);
+
+	// only the vertex stage is of interest, so nothing is rasterized
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	std::cout << "INFO: Vertex format benchmark - " << g_DrawCount << " draws per layout" << std::endl;
+	MeasureMesh(meshes, ShapeMeshes::MESH_SPHERE, "sphere");
+	MeasureMesh(meshes, ShapeMeshes::MESH_TORUS, "torus");
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	m_pShaderManager->setBoolValue(g_PackedVerticesName, false);
+}
+
+/***********************************************************
+ *  MeasureMesh()
+ *
+ *  This method is used for timing the draws of a loaded
+ *  mesh in each vertex layout.  The bandwidth counts each
+ *  unique vertex once per draw, which is what the vertex
+ *  fetch reads when the post transform cache hits.
+ ***********************************************************/
+void VertexFormatBenchmark::MeasureMesh(
+	ShapeMeshes& meshes,
+	ShapeMeshes::MeshID mesh,
+	const char* name)
+{
+	GLuint nVertices = 0;
+	GLuint nIndices = 0;
+
+	if (false == meshes.GetMeshSize(mesh, nVertices, nIndices))
+	{
+		return;
+	}
+
+	std::cout << "INFO:   " << name << ": " << nVertices << " vertices, "
+		<< nIndices << " indices" << std::endl;
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+
+	for (int format = 0; format < ShapeMeshes::VERTEX_FORMAT_COUNT; format++)
+	{
+		ShapeMeshes::VertexFormat vertexFormat = (ShapeMeshes::VertexFormat)format;
+		if (false == meshes.SetMeshVertexFormat(mesh, vertexFormat))
+		{
+			std::cout << "INFO:     " << g_VertexFormatNames[format]
+				<< " - the mesh data does not fit this layout" << std::endl;
+			continue;
+		}
+
+		m_pShaderManager->setBoolValue(g_PackedVerticesName,
+			ShapeMeshes::VERTEX_FORMAT_PACKED == vertexFormat);
+
+		// the first draw is not timed, so the buffers are resident
+		meshes.DrawMesh(mesh);
+		glFinish();
+
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		for (int i = 0; i < g_DrawCount; i++)
+		{
+			meshes.DrawMesh(mesh);
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 elapsedNanoseconds = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNanoseconds);
+		if (0 == elapsedNanoseconds)
+		{
+			continue;
+		}
+
+		GLsizei stride = ShapeMeshes::GetVertexStride(vertexFormat);
+		double vertexBytes = (double)nVertices * stride;
+		double milliseconds = (double)elapsedNanoseconds / 1000000.0 / g_DrawCount;
+		// bytes per nanosecond is the same as gigabytes per second
+		double gigabytesPerSecond = vertexBytes * g_DrawCount / (double)elapsedNanoseconds;
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< "INFO:     " << g_VertexFormatNames[format] << " - "
+			<< stride << " bytes per vertex, "
+			<< vertexBytes / (1024.0 * 1024.0) << " MB, "
+			<< milliseconds << " ms per draw, "
+			<< gigabytesPerSecond << " GB/s" << std::endl;
+		std::cout.unsetf(std::ios_base::floatfield);
+	}
+
+	glDeleteQueries(1, &query);
+
+	meshes.SetMeshVertexFormat(mesh, ShapeMeshes::VERTEX_FORMAT_FLOAT);
+}
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexformatbenchmark.h
+// ============
+// compare the vertex fetch bandwidth of the float and packed vertex layouts
+//
+// High tessellation spheres and tori are drawn many times from each vertex
+// layout with the rasterizer disabled, so that the GPU time is spent in the
+// vertex stage, and the time of the draws is measured with timer queries.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+
+/***********************************************************
+ *  VertexFormatBenchmark
+ *
+ *  This class contains the code for timing the draws of
+ *  the same meshes from each of the vertex layouts.
+ ***********************************************************/
+class VertexFormatBenchmark
+{
+public:
+	// constructor
+	VertexFormatBenchmark(ShaderManager* pShaderManager);
+
+	// load the benchmark meshes, time them in each vertex
+	// layout and output the results
+	void Run();
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+
+	// time the draws of a loaded mesh in each vertex layout
+	void MeasureMesh(
+		ShapeMeshes& meshes,
+		ShapeMeshes::MeshID mesh,
+		const char* name);
+};
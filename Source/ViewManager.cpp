@@ -21,8 +21,6 @@ namespace
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
 
 	// Camera object used for viewing and interacting with the 3D scene
 	Camera* g_pCamera = nullptr;
@@ -257,12 +255,15 @@ void ViewManager::PrepareSceneView()
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		FRAME_CONSTANTS frameConstants;
+
+		// the view matrix, projection matrix and the view position of
+		// the camera are written into the shared frame constants block
+		// with one upload, so every shader program can read them
+		frameConstants.view = view;
+		frameConstants.projection = projection;
+		frameConstants.viewPosition = glm::vec4(g_pCamera->Position, 1.0f);
+		m_pShaderManager->UpdateFrameConstants(frameConstants);
 	}
 }
 
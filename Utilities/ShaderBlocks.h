@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderblocks.h
+// ============
+// CPU side copies of the std140 uniform blocks and std430 storage blocks
+// declared in the GLSL shaders
+//
+// The member order and padding of every structure here must match the block
+// declarations in vertexShader.glsl and fragmentShader.glsl exactly.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// fixed binding points shared by every shader program
+enum UNIFORM_BLOCK_BINDING
+{
+	FRAME_CONSTANTS_BINDING = 0,
+	LIGHT_BLOCK_BINDING = 1,
+	LIGHT_GRID_BINDING = 2
+};
+
+// fixed shader storage buffer binding points
+enum STORAGE_BLOCK_BINDING
+{
+	MATERIAL_BUFFER_BINDING = 0,
+	POINT_LIGHT_BUFFER_BINDING = 1,
+	LIGHT_CLUSTER_BUFFER_BINDING = 2,
+	LIGHT_INDEX_BUFFER_BINDING = 3
+};
+
+// number of light sources in the light block
+const int TOTAL_LIGHTS = 4;
+
+/***********************************************************
+ *  FRAME_CONSTANTS
+ *
+ *  Camera data that is written once per frame.
+ ***********************************************************/
+struct FRAME_CONSTANTS
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec4 viewPosition;		// xyz = camera position
+};
+
+/***********************************************************
+ *  LIGHT_SOURCE
+ *
+ *  One light source, each vec3 is followed by a float so
+ *  that the structure is 64 bytes, as std140 requires.
+ ***********************************************************/
+struct LIGHT_SOURCE
+{
+	glm::vec3 position;
+	float focalStrength;
+	glm::vec3 ambientColor;
+	float specularIntensity;
+	glm::vec3 diffuseColor;
+	float padding0;
+	glm::vec3 specularColor;
+	float padding1;
+};
+
+/***********************************************************
+ *  LIGHT_BLOCK
+ *
+ *  All of the light sources for the 3D scene.
+ ***********************************************************/
+struct LIGHT_BLOCK
+{
+	LIGHT_SOURCE lightSources[TOTAL_LIGHTS];
+};
+
+/***********************************************************
+ *  GPU_MATERIAL
+ *
+ *  One entry of the material storage buffer, indexed by
+ *  MaterialId.  Each vec3 is followed by a float so that
+ *  the structure is 48 bytes, as std430 requires.
+ ***********************************************************/
+struct GPU_MATERIAL
+{
+	glm::vec3 ambientColor;
+	float ambientStrength;
+	glm::vec3 diffuseColor;
+	float shininess;
+	glm::vec3 specularColor;
+	float padding;
+};
+
+/***********************************************************
+ *  POINT_LIGHT
+ *
+ *  One entry of the point light storage buffer.  The light
+ *  fades out towards its radius, so it only reaches the
+ *  clusters that its sphere overlaps.
+ ***********************************************************/
+struct POINT_LIGHT
+{
+	glm::vec3 position;			// world space
+	float radius;
+	glm::vec3 color;
+	float intensity;
+};
+
+/***********************************************************
+ *  LIGHT_CLUSTER
+ *
+ *  One entry of the light cluster storage buffer, the
+ *  range of the light index buffer that lists the point
+ *  lights reaching the cluster.
+ ***********************************************************/
+struct LIGHT_CLUSTER
+{
+	unsigned int firstLight;
+	unsigned int lightCount;
+};
+
+/***********************************************************
+ *  LIGHT_GRID_CONSTANTS
+ *
+ *  The layout of the light clusters, for finding the
+ *  cluster of a fragment from its window position and
+ *  view depth.
+ ***********************************************************/
+struct LIGHT_GRID_CONSTANTS
+{
+	glm::uvec4 clusterCounts;	// xyz = clusters along x, y and depth
+	glm::vec4 tileSize;			// xy = pixels covered by a cluster
+	glm::vec4 depthSlicing;		// x = scale, y = bias of the log of the view depth
+};
+
+static_assert(sizeof(FRAME_CONSTANTS) == 144, "FRAME_CONSTANTS must match the std140 layout");
+static_assert(sizeof(LIGHT_SOURCE) == 64, "LIGHT_SOURCE must match the std140 layout");
+static_assert(sizeof(GPU_MATERIAL) == 48, "GPU_MATERIAL must match the std430 layout");
+static_assert(sizeof(POINT_LIGHT) == 32, "POINT_LIGHT must match the std430 layout");
+static_assert(sizeof(LIGHT_CLUSTER) == 8, "LIGHT_CLUSTER must match the std430 layout");
+static_assert(sizeof(LIGHT_GRID_CONSTANTS) == 48, "LIGHT_GRID_CONSTANTS must match the std140 layout");
@@ -14,106 +14,1079 @@ using namespace std;
 
 #include "ShaderManager.h"
 
+#include <chrono>
+#include <cstdint>
+
+// declaration of global variables
+namespace
+{
+	// first bytes of a program cache file
+	const uint32_t g_ProgramFileMagic = 0x4E494250;		// "PBIN"
+	// version of the program cache file layout
+	const uint32_t g_ProgramFileVersion = 1;
+	// starting value and multiplier of the 64 bit FNV-1a hash
+	const uint64_t g_HashBasis = 14695981039346656037ull;
+	const uint64_t g_HashPrime = 1099511628211ull;
+
+	// feature bits of a variant key, the light count of a lit
+	// variant is stored above them and the deferred passes above
+	// that - the variants drawn through the render queue stay
+	// within the 7 variant bits of its sort key
+	const unsigned int g_VariantSpecialized = 0x01;
+	const unsigned int g_VariantLighting = 0x02;
+	const unsigned int g_VariantTexture = 0x04;
+	const int g_VariantLightCountShift = 3;
+	const unsigned int g_VariantLightCountMask = 0x38;
+	const unsigned int g_VariantGeometryPass = 0x40;
+	const unsigned int g_VariantLightingPass = 0x80;
+
+	// header at the start of a program cache file, it is
+	// followed by the program binary
+	struct PROGRAM_FILE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t binaryFormat;
+		uint32_t binarySize;
+		uint64_t key;
+	};
+
+	/***********************************************************
+	 *  HashString()
+	 *
+	 *  Continue the FNV-1a hash with the characters of a
+	 *  string and its terminator, so that the boundaries
+	 *  between the hashed strings are part of the key.
+	 ***********************************************************/
+	uint64_t HashString(uint64_t hash, const std::string &text)
+	{
+		for (size_t i = 0; i <= text.size(); i++)
+		{
+			hash ^= (unsigned char)text.c_str()[i];
+			hash *= g_HashPrime;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  GetGLString()
+	 *
+	 *  Get a string of the driver, or an empty string when the
+	 *  driver does not report it.
+	 ***********************************************************/
+	std::string GetGLString(GLenum name)
+	{
+		const GLubyte *pString = glGetString(name);
+
+		return((NULL != pString) ? std::string((const char*)pString) : std::string());
+	}
+
+	/***********************************************************
+	 *  GetVariantDefines()
+	 *
+	 *  Get the defines that select the features of a variant,
+	 *  the generic variant has none.
+	 ***********************************************************/
+	std::string GetVariantDefines(unsigned int key)
+	{
+		if (0 == (key & g_VariantSpecialized))
+		{
+			return(std::string());
+		}
+
+		std::string defines = "#define VARIANT_SPECIALIZED\n";
+		if (0 != (key & g_VariantLighting))
+		{
+			defines += "#define VARIANT_LIGHTING\n";
+			defines += "#define LIGHT_COUNT " +
+				std::to_string((key & g_VariantLightCountMask) >> g_VariantLightCountShift) + "\n";
+		}
+		if (0 != (key & g_VariantTexture))
+		{
+			defines += "#define VARIANT_TEXTURE\n";
+		}
+		if (0 != (key & g_VariantGeometryPass))
+		{
+			defines += "#define VARIANT_GEOMETRY_PASS\n";
+		}
+		if (0 != (key & g_VariantLightingPass))
+		{
+			defines += "#define VARIANT_LIGHTING_PASS\n";
+		}
+
+		return(defines);
+	}
+
+	/***********************************************************
+	 *  InsertDefines()
+	 *
+	 *  Insert the defines of a variant after the version line,
+	 *  which has to stay the first line of the source.  The
+	 *  line numbers of the compile errors stay those of the
+	 *  file.
+	 ***********************************************************/
+	std::string InsertDefines(const std::string &code, const std::string &defines)
+	{
+		std::string::size_type lineEnd = code.find('\n');
+		if ((defines.empty() == true) || (lineEnd == std::string::npos))
+		{
+			return(code);
+		}
+
+		return(code.substr(0, lineEnd + 1) + defines + "#line 2\n" + code.substr(lineEnd + 1));
+	}
+
+	/***********************************************************
+	 *  ReadShaderFile()
+	 *
+	 *  Read the whole text of a shader file, returns false
+	 *  when the file could not be opened.
+	 ***********************************************************/
+	bool ReadShaderFile(const char *path, std::string &code)
+	{
+		std::ifstream stream(path, std::ios::in);
+		if (stream.is_open() == false)
+		{
+			return(false);
+		}
+
+		std::stringstream sstr;
+		sstr << stream.rdbuf();
+		code = sstr.str();
+
+		return(true);
+	}
+}
+
+const ShaderManager::VariantKey ShaderManager::GENERIC_VARIANT;
+
+/***********************************************************
+ *  ShaderManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderManager::ShaderManager()
+{
+	m_programID = 0;
+	m_currentVariant = GENERIC_VARIANT;
+	m_shaderWaitTime = 0.0;
+	m_frameConstantsUBO = 0;
+	m_lightBlockUBO = 0;
+	m_materialSSBO = 0;
+	m_lightGridUBO = 0;
+	m_pointLightSSBO = 0;
+	m_lightClusterSSBO = 0;
+	m_lightIndexSSBO = 0;
+	m_frameConstants.view = glm::mat4(1.0f);
+	m_frameConstants.projection = glm::mat4(1.0f);
+	m_frameConstants.viewPosition = glm::vec4(0.0f);
+}
+
 /***********************************************************
  *  LoadShaders()
  *
  *  This method is called to load the shader data from 
- *  external GLSL compatible files.
+ *  external GLSL compatible files, and waits until the
+ *  program is linked.  It returns 0 when the shaders could
+ *  not be read, compiled or linked.
  ***********************************************************/
 GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
 
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+	if (BeginLoadShaders(vertex_file_path, fragment_file_path) == false)
+	{
+		return 0;
+	}
+	if (WaitForShaders() == false)
+	{
+		return 0;
+	}
 
-	// Read the Vertex Shader code from the file
+	return m_programID;
+}
+
+/***********************************************************
+ *  SetProgramCacheDirectory()
+ *
+ *  This method is used to set the directory where the
+ *  linked programs are saved, so later launches load the
+ *  binary instead of compiling the GLSL files.  An empty
+ *  directory disables the program cache.
+ ***********************************************************/
+void ShaderManager::SetProgramCacheDirectory(const std::string &directory)
+{
+	m_programCacheDirectory = directory;
+}
+
+/***********************************************************
+ *  BeginLoadShaders()
+ *
+ *  This method is called to start loading the shader data
+ *  from external GLSL compatible files, as the generic
+ *  variant that decides its features at run time.  The
+ *  sources are kept for compiling the specialized variants.
+ *  It returns false when a shader file could not be read.
+ ***********************************************************/
+bool ShaderManager::BeginLoadShaders(const char *vertex_file_path, const char *fragment_file_path)
+{
 	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if(VertexShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << VertexShaderStream.rdbuf();
-		VertexShaderCode = sstr.str();
-		VertexShaderStream.close();
-	}else{
+	if (ReadShaderFile(vertex_file_path, VertexShaderCode) == false)
+	{
 		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
 		getchar();
-		return 0;
+		return false;
 	}
-
-	// Read the Fragment Shader code from the file
 	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if(FragmentShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << FragmentShaderStream.rdbuf();
-		FragmentShaderCode = sstr.str();
-		FragmentShaderStream.close();
+	if (ReadShaderFile(fragment_file_path, FragmentShaderCode) == false)
+	{
+		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", fragment_file_path);
+		getchar();
+		return false;
 	}
 
-	GLint Result = GL_FALSE;
-	int InfoLogLength;
+	// the variants of the previous sources are no longer valid
+	DestroyVariants();
 
+	m_vertexShaderCode = VertexShaderCode;
+	m_fragmentShaderCode = FragmentShaderCode;
+	m_vertexShaderPath = vertex_file_path;
+	m_fragmentShaderPath = fragment_file_path;
+	m_shaderWaitTime = 0.0;
 
-	// Compile Vertex Shader
-	printf("Compiling shader : %s...", vertex_file_path);
-	char const * VertexSourcePointer = VertexShaderCode.c_str();
-	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
-	glCompileShader(VertexShaderID);
+	RequestVariant(GENERIC_VARIANT);
+	m_currentVariant = GENERIC_VARIANT;
+	m_programID = m_variants[GENERIC_VARIANT].programID;
+
+	// a program from the cache is ready, so its uniform locations
+	// are resolved at once
+	if (m_variants[GENERIC_VARIANT].bPending == false)
+	{
+		ReflectUniforms();
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  MakeVariantKey()
+ *
+ *  This method is used to get the key of the specialized
+ *  variant for the passed in features and render pass.
+ *  The light count is clamped to the size of the light
+ *  block.  The geometry pass only stores whether a pixel
+ *  is lit, so its variants share one key for any light
+ *  count, and the lighting pass reads the color from the
+ *  G-buffer, so it has no texture feature.
+ ***********************************************************/
+ShaderManager::VariantKey ShaderManager::MakeVariantKey(bool bLighting, bool bTexture, int lightCount, VariantPass pass)
+{
+	VariantKey key = g_VariantSpecialized;
+
+	if (VARIANT_PASS_GEOMETRY == pass)
+	{
+		key |= g_VariantGeometryPass;
+		lightCount = 0;
+	}
+	else if (VARIANT_PASS_LIGHTING == pass)
+	{
+		key |= g_VariantLightingPass;
+		bTexture = false;
+	}
+
+	if (bLighting == true)
+	{
+		if (lightCount < 0) lightCount = 0;
+		if (lightCount > TOTAL_LIGHTS) lightCount = TOTAL_LIGHTS;
+		key |= g_VariantLighting | ((VariantKey)lightCount << g_VariantLightCountShift);
+	}
+	if (bTexture == true)
+	{
+		key |= g_VariantTexture;
+	}
 
-	// Check Vertex Shader
-	glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
-		printf("\n%s\n", &VertexShaderErrorMessage[0]);
+	return(key);
+}
+
+/***********************************************************
+ *  RequestVariant()
+ *
+ *  This method is used to start loading a variant of the
+ *  shaders, from the program cache or by compiling the
+ *  sources with the defines of its features.  The program
+ *  is loaded when the sources, the defines, the driver and
+ *  the renderer are unchanged.  With the parallel compile
+ *  extension this returns before the driver has finished,
+ *  so all variants of a scene can be compiled at once.
+ ***********************************************************/
+void ShaderManager::RequestVariant(VariantKey key)
+{
+	if ((m_variants.find(key) != m_variants.end()) || (m_vertexShaderCode.empty() == true))
+	{
+		return;
 	}
 
-	printf("success\n");
+	PROGRAM_VARIANT variant;
+	variant.programID = 0;
+	variant.vertexShaderID = 0;
+	variant.fragmentShaderID = 0;
+	variant.bPending = false;
+	variant.bFromCache = false;
+	variant.cacheKey = 0;
 
-	// Compile Fragment Shader
-	printf("Compiling shader : %s...", fragment_file_path);
+	const std::string defines = GetVariantDefines(key);
+	const std::string VertexShaderCode = InsertDefines(m_vertexShaderCode, defines);
+	const std::string FragmentShaderCode = InsertDefines(m_fragmentShaderCode, defines);
+
+	// the key changes with the sources and with the driver, since
+	// a program binary only loads on the driver that saved it
+	if ((m_programCacheDirectory.empty() == false) && (IsProgramBinarySupported() == true))
+	{
+		uint64_t cacheKey = g_HashBasis;
+		cacheKey = HashString(cacheKey, VertexShaderCode);
+		cacheKey = HashString(cacheKey, FragmentShaderCode);
+		cacheKey = HashString(cacheKey, GetGLString(GL_VENDOR));
+		cacheKey = HashString(cacheKey, GetGLString(GL_RENDERER));
+		cacheKey = HashString(cacheKey, GetGLString(GL_VERSION));
+		variant.cacheKey = cacheKey;
+
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "program_%016llx.bin", (unsigned long long)cacheKey);
+		variant.cachePath = m_programCacheDirectory + "/" + fileName;
+
+		if (LoadProgramBinary(variant) == true)
+		{
+			printf("Loaded shader program from cache : %s\n", variant.cachePath.c_str());
+			variant.bFromCache = true;
+			m_variants[key] = variant;
+			return;
+		}
+	}
+
+	// let the driver compile on its own threads, the compile and
+	// link calls then return at once and the status is polled
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+
+	printf("Compiling shader variant %u : %s, %s\n", key,
+		m_vertexShaderPath.c_str(), m_fragmentShaderPath.c_str());
+	variant.vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	char const * VertexSourcePointer = VertexShaderCode.c_str();
+	glShaderSource(variant.vertexShaderID, 1, &VertexSourcePointer , NULL);
+	glCompileShader(variant.vertexShaderID);
+
+	variant.fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
 	char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
-	glCompileShader(FragmentShaderID);
+	glShaderSource(variant.fragmentShaderID, 1, &FragmentSourcePointer , NULL);
+	glCompileShader(variant.fragmentShaderID);
 
-	// Check Fragment Shader
-	glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
-		printf("\n%s\n", &FragmentShaderErrorMessage[0]);
+	variant.programID = glCreateProgram();
+	glAttachShader(variant.programID, variant.vertexShaderID);
+	glAttachShader(variant.programID, variant.fragmentShaderID);
+	if (variant.cachePath.empty() == false)
+	{
+		glProgramParameteri(variant.programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	}
+	glLinkProgram(variant.programID);
 
-	printf("success\n");
+	variant.bPending = true;
+	m_variants[key] = variant;
+}
 
-	// Link the program
-	printf("Linking shader program...");
-	GLuint ProgramID = glCreateProgram();
-	m_programID = ProgramID;
-	glAttachShader(ProgramID, VertexShaderID);
-	glAttachShader(ProgramID, FragmentShaderID);
-	glLinkProgram(ProgramID);
+/***********************************************************
+ *  UseVariant()
+ *
+ *  This method is used to make a variant the current
+ *  program.  A variant that was not requested is compiled
+ *  first, and one that failed to compile is replaced by
+ *  the generic variant.  The uniform locations of the
+ *  programs differ, so the location table is swapped with
+ *  the program, and the handles stay valid.  It returns
+ *  true when the current program was switched.
+ ***********************************************************/
+bool ShaderManager::UseVariant(VariantKey key)
+{
+	if (key == m_currentVariant)
+	{
+		return false;
+	}
+
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::iterator it = m_variants.find(key);
+	if (it == m_variants.end())
+	{
+		RequestVariant(key);
+		it = m_variants.find(key);
+		if (it == m_variants.end())
+		{
+			return false;
+		}
+	}
+	if (it->second.bPending == true)
+	{
+		FinishVariant(it->second);
+	}
+	if (0 == it->second.programID)
+	{
+		key = GENERIC_VARIANT;
+		it = m_variants.find(key);
+		if ((key == m_currentVariant) || (it == m_variants.end()))
+		{
+			return false;
+		}
+	}
+
+	// keep the locations of the current program for switching back,
+	// including the ones that were resolved while it was current
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::iterator current = m_variants.find(m_currentVariant);
+	if (current != m_variants.end())
+	{
+		current->second.locations.resize(m_uniforms.size());
+		for (size_t i = 0; i < m_uniforms.size(); i++)
+		{
+			current->second.locations[i] = m_uniforms[i].location;
+		}
+	}
+
+	PROGRAM_VARIANT& variant = it->second;
+	for (size_t i = variant.locations.size(); i < m_uniforms.size(); i++)
+	{
+		variant.locations.push_back(glGetUniformLocation(variant.programID, m_uniforms[i].name.c_str()));
+	}
+	for (size_t i = 0; i < m_uniforms.size(); i++)
+	{
+		m_uniforms[i].location = variant.locations[i];
+	}
+
+	m_currentVariant = key;
+	m_programID = variant.programID;
+	glUseProgram(m_programID);
+
+	return true;
+}
+
+/***********************************************************
+ *  IsProgramReady()
+ *
+ *  This method is used to check without blocking whether
+ *  the requested variants have finished compiling and
+ *  linking, so WaitForShaders() would return at once.
+ *  Without the parallel compile extension the status
+ *  queries wait for the driver anyway, so the programs
+ *  are reported as ready.
+ ***********************************************************/
+bool ShaderManager::IsProgramReady() const
+{
+	if ((!GLEW_KHR_parallel_shader_compile) && (!GLEW_ARB_parallel_shader_compile))
+	{
+		return true;
+	}
+
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::const_iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); ++it)
+	{
+		if (it->second.bPending == true)
+		{
+			GLint bCompleted = GL_FALSE;
+			glGetProgramiv(it->second.programID, GL_COMPLETION_STATUS_KHR, &bCompleted);
+			if (GL_TRUE != bCompleted)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  WaitForShaders()
+ *
+ *  This method is called to finish loading the variants
+ *  that were requested, and to make the generic variant
+ *  the current program.  It returns false when the generic
+ *  variant failed to compile or link, a specialized variant
+ *  that failed is replaced by the generic one when it is
+ *  used.
+ ***********************************************************/
+bool ShaderManager::WaitForShaders()
+{
+	bool bGenericFinished = false;
+
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); ++it)
+	{
+		if (it->second.bPending == true)
+		{
+			FinishVariant(it->second);
+			bGenericFinished |= (GENERIC_VARIANT == it->first);
+		}
+	}
+
+	it = m_variants.find(GENERIC_VARIANT);
+	if ((it == m_variants.end()) || (0 == it->second.programID))
+	{
+		m_programID = 0;
+		return false;
+	}
+
+	if (bGenericFinished == true)
+	{
+		m_currentVariant = GENERIC_VARIANT;
+		m_programID = it->second.programID;
+
+		// resolve all the uniform locations once, up front - the
+		// locations of the other variants are resolved by name
+		ReflectUniforms();
+	}
+	else
+	{
+		UseVariant(GENERIC_VARIANT);
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  FinishVariant()
+ *
+ *  This method is called to finish a variant that was
+ *  compiled.  It waits for the driver, checks the compile
+ *  and link status, and saves the linked program into the
+ *  program cache.  The program of a variant that failed is
+ *  deleted and its id is 0.
+ ***********************************************************/
+void ShaderManager::FinishVariant(PROGRAM_VARIANT &variant)
+{
+	variant.bPending = false;
+
+	// the first status query blocks until the driver is done
+	std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+	bool bVertexCompiled = CheckShader(variant.vertexShaderID, m_vertexShaderPath.c_str());
+	std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+	m_shaderWaitTime += waited.count();
+
+	bool bFragmentCompiled = CheckShader(variant.fragmentShaderID, m_fragmentShaderPath.c_str());
 
 	// Check the program
-	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	GLint Result = GL_FALSE;
+	int InfoLogLength = 0;
+	printf("Linking shader program...");
+	glGetProgramiv(variant.programID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(variant.programID, GL_INFO_LOG_LENGTH, &InfoLogLength);
 	if ( InfoLogLength > 1 ){
 		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
-		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		glGetProgramInfoLog(variant.programID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
 		printf("\n%s\n", &ProgramErrorMessage[0]);
 	}
+	bool bLinked = (GL_TRUE == Result) && (bVertexCompiled == true) && (bFragmentCompiled == true);
+	printf("%s\n", (bLinked == true) ? "success" : "failed");
+
+	glDetachShader(variant.programID, variant.vertexShaderID);
+	glDetachShader(variant.programID, variant.fragmentShaderID);
+
+	glDeleteShader(variant.vertexShaderID);
+	glDeleteShader(variant.fragmentShaderID);
+	variant.vertexShaderID = 0;
+	variant.fragmentShaderID = 0;
+
+	if (bLinked == false)
+	{
+		glDeleteProgram(variant.programID);
+		variant.programID = 0;
+		return;
+	}
+
+	if (variant.cachePath.empty() == false)
+	{
+		SaveProgramBinary(variant);
+	}
+}
+
+/***********************************************************
+ *  DestroyVariants()
+ *
+ *  This method is called to delete the programs of all
+ *  of the variants.
+ ***********************************************************/
+void ShaderManager::DestroyVariants()
+{
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); ++it)
+	{
+		if (0 != it->second.vertexShaderID) glDeleteShader(it->second.vertexShaderID);
+		if (0 != it->second.fragmentShaderID) glDeleteShader(it->second.fragmentShaderID);
+		if (0 != it->second.programID) glDeleteProgram(it->second.programID);
+	}
 
-	printf("success\n");
-	
-	glDetachShader(ProgramID, VertexShaderID);
-	glDetachShader(ProgramID, FragmentShaderID);
-	
-	glDeleteShader(VertexShaderID);
-	glDeleteShader(FragmentShaderID);
+	m_variants.clear();
+	m_currentVariant = GENERIC_VARIANT;
+	m_programID = 0;
+}
 
-	return ProgramID;
+/***********************************************************
+ *  IsProgramFromCache()
+ *
+ *  This method is used to check whether every variant was
+ *  loaded from the program cache, with no compiling.
+ ***********************************************************/
+bool ShaderManager::IsProgramFromCache() const
+{
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::const_iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); ++it)
+	{
+		if (it->second.bFromCache == false)
+		{
+			return false;
+		}
+	}
+
+	return (m_variants.empty() == false);
+}
+
+/***********************************************************
+ *  CheckShader()
+ *
+ *  This method is called to check the compile status of a
+ *  shader and output its info log.  It returns false when
+ *  the shader failed to compile.
+ ***********************************************************/
+bool ShaderManager::CheckShader(GLuint shaderID, const char *file_path)
+{
+	GLint Result = GL_FALSE;
+	int InfoLogLength = 0;
+
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(shaderID, InfoLogLength, NULL, &ShaderErrorMessage[0]);
+		printf("%s\n%s\n", file_path, &ShaderErrorMessage[0]);
+	}
+
+	if (GL_TRUE != Result)
+	{
+		printf("Compiling shader : %s...failed\n", file_path);
+		return false;
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  IsProgramBinarySupported()
+ *
+ *  This method is used to check whether the driver can
+ *  save and load linked programs.  Drivers may support the
+ *  calls with no binary formats, which disables the cache.
+ ***********************************************************/
+bool ShaderManager::IsProgramBinarySupported()
+{
+	if ((!GLEW_VERSION_4_1) && (!GLEW_ARB_get_program_binary))
+	{
+		return false;
+	}
+
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+	return (formatCount > 0);
+}
+
+/***********************************************************
+ *  LoadProgramBinary()
+ *
+ *  This method is called to create the program of a
+ *  variant from its cache file.  It returns false when
+ *  there is no cache file for the key of the variant, or
+ *  when the driver rejects the binary, in which case the
+ *  shaders are compiled.
+ ***********************************************************/
+bool ShaderManager::LoadProgramBinary(PROGRAM_VARIANT &variant)
+{
+	std::ifstream file(variant.cachePath.c_str(), std::ios::in | std::ios::binary);
+	if (file.is_open() == false)
+	{
+		return false;
+	}
+
+	PROGRAM_FILE_HEADER header;
+	file.read((char*)&header, sizeof(header));
+	if ((file.gcount() != (std::streamsize)sizeof(header)) ||
+		(header.magic != g_ProgramFileMagic) ||
+		(header.version != g_ProgramFileVersion) ||
+		(header.key != variant.cacheKey) ||
+		(0 == header.binarySize))
+	{
+		return false;
+	}
+
+	// a binary of a format the driver no longer lists would
+	// only raise an error
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	std::vector<GLint> formats(formatCount);
+	glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, &formats[0]);
+	if (std::find(formats.begin(), formats.end(), (GLint)header.binaryFormat) == formats.end())
+	{
+		return false;
+	}
+
+	std::vector<char> binary(header.binarySize);
+	file.read(&binary[0], header.binarySize);
+	if (file.gcount() != (std::streamsize)header.binarySize)
+	{
+		return false;
+	}
+
+	GLuint ProgramID = glCreateProgram();
+	glProgramBinary(ProgramID, (GLenum)header.binaryFormat, &binary[0], (GLsizei)header.binarySize);
+
+	GLint Result = GL_FALSE;
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	if (GL_TRUE != Result)
+	{
+		glDeleteProgram(ProgramID);
+		return false;
+	}
+
+	variant.programID = ProgramID;
+	return true;
+}
+
+/***********************************************************
+ *  SaveProgramBinary()
+ *
+ *  This method is called to save the linked program of a
+ *  variant into its cache file.  A failure only costs the
+ *  compile on the next launch, so it is reported and
+ *  ignored.
+ ***********************************************************/
+void ShaderManager::SaveProgramBinary(const PROGRAM_VARIANT &variant)
+{
+	GLint binaryLength = 0;
+	glGetProgramiv(variant.programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(binaryLength);
+	GLsizei writtenLength = 0;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(variant.programID, binaryLength, &writtenLength, &binaryFormat, &binary[0]);
+	if (writtenLength <= 0)
+	{
+		return;
+	}
+
+	PROGRAM_FILE_HEADER header;
+	header.magic = g_ProgramFileMagic;
+	header.version = g_ProgramFileVersion;
+	header.binaryFormat = (uint32_t)binaryFormat;
+	header.binarySize = (uint32_t)writtenLength;
+	header.key = variant.cacheKey;
+
+	std::ofstream file(variant.cachePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (file.is_open() == true)
+	{
+		file.write((const char*)&header, sizeof(header));
+		file.write(&binary[0], writtenLength);
+	}
+	if ((file.is_open() == false) || (file.good() == false))
+	{
+		printf("Unable to save shader program : %s\n", variant.cachePath.c_str());
+		file.close();
+		remove(variant.cachePath.c_str());
+	}
+}
+
+/***********************************************************
+ *  CreateUniformBuffer()
+ *
+ *  This method is used to create a uniform buffer object
+ *  and attach it to the passed in binding point, where it
+ *  is visible to every shader program that declares a
+ *  block with the same binding.
+ ***********************************************************/
+GLuint ShaderManager::CreateUniformBuffer(GLuint bindingPoint, GLsizeiptr size)
+{
+	GLuint bufferID = 0;
+
+	glGenBuffers(1, &bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+	glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	return(bufferID);
+}
+
+/***********************************************************
+ *  UpdateFrameConstants()
+ *
+ *  This method is used to write the per-frame camera data
+ *  into the frame constants block with a single upload.
+ ***********************************************************/
+void ShaderManager::UpdateFrameConstants(const FRAME_CONSTANTS &frameConstants)
+{
+	if (0 == m_frameConstantsUBO)
+	{
+		m_frameConstantsUBO = CreateUniformBuffer(FRAME_CONSTANTS_BINDING, sizeof(FRAME_CONSTANTS));
+	}
+
+	m_frameConstants = frameConstants;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_frameConstantsUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FRAME_CONSTANTS), &m_frameConstants);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateLightBlock()
+ *
+ *  This method is used to write all of the light sources
+ *  into the light block with a single upload.  It only
+ *  needs to be called when a light has changed.
+ ***********************************************************/
+void ShaderManager::UpdateLightBlock(const LIGHT_BLOCK &lightBlock)
+{
+	if (0 == m_lightBlockUBO)
+	{
+		m_lightBlockUBO = CreateUniformBuffer(LIGHT_BLOCK_BINDING, sizeof(LIGHT_BLOCK));
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightBlockUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LIGHT_BLOCK), &lightBlock);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateMaterialBuffer()
+ *
+ *  This method is used to write the object materials into
+ *  the shared storage buffer.  The materials are uploaded
+ *  once, and the shaders index them by material id.
+ ***********************************************************/
+void ShaderManager::UpdateMaterialBuffer(const GPU_MATERIAL *pMaterials, int materialCount)
+{
+	if ((NULL == pMaterials) || (materialCount <= 0))
+	{
+		return;
+	}
+
+	if (0 == m_materialSSBO)
+	{
+		glGenBuffers(1, &m_materialSSBO);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_materialSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPU_MATERIAL) * materialCount, pMaterials, GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BUFFER_BINDING, m_materialSSBO);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  WriteStorageBuffer()
+ *
+ *  This method is used to replace the contents of a shader
+ *  storage buffer and attach it to its binding point.  The
+ *  buffer is created on the first write, and an empty one
+ *  gets a single zero word so the binding stays valid.
+ ***********************************************************/
+void ShaderManager::WriteStorageBuffer(GLuint &bufferID, GLuint bindingPoint, const void *pData, GLsizeiptr size)
+{
+	const unsigned int emptyData = 0;
+
+	if (0 == bufferID)
+	{
+		glGenBuffers(1, &bufferID);
+	}
+	if ((NULL == pData) || (size <= 0))
+	{
+		pData = &emptyData;
+		size = sizeof(emptyData);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, size, pData, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, bufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdatePointLights()
+ *
+ *  This method is used to write the point lights into the
+ *  shared storage buffer.  It only needs to be called when
+ *  a light has changed, the light lists of the clusters
+ *  refer to the lights by index.
+ ***********************************************************/
+void ShaderManager::UpdatePointLights(const POINT_LIGHT *pLights, int lightCount)
+{
+	WriteStorageBuffer(m_pointLightSSBO, POINT_LIGHT_BUFFER_BINDING,
+		pLights, (GLsizeiptr)sizeof(POINT_LIGHT) * lightCount);
+}
+
+/***********************************************************
+ *  UpdateLightGrid()
+ *
+ *  This method is used to write the layout of the light
+ *  clusters and the light lists of all clusters, once per
+ *  frame.  The buffers are orphaned by the new data, so
+ *  the draws of the previous frame are not waited for.
+ ***********************************************************/
+void ShaderManager::UpdateLightGrid(
+	const LIGHT_GRID_CONSTANTS &constants,
+	const LIGHT_CLUSTER *pClusters,
+	int clusterCount,
+	const unsigned int *pLightIndices,
+	int lightIndexCount)
+{
+	if (0 == m_lightGridUBO)
+	{
+		m_lightGridUBO = CreateUniformBuffer(LIGHT_GRID_BINDING, sizeof(LIGHT_GRID_CONSTANTS));
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightGridUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LIGHT_GRID_CONSTANTS), &constants);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	WriteStorageBuffer(m_lightClusterSSBO, LIGHT_CLUSTER_BUFFER_BINDING,
+		pClusters, (GLsizeiptr)sizeof(LIGHT_CLUSTER) * clusterCount);
+	WriteStorageBuffer(m_lightIndexSSBO, LIGHT_INDEX_BUFFER_BINDING,
+		pLightIndices, (GLsizeiptr)sizeof(unsigned int) * lightIndexCount);
+}
+
+/***********************************************************
+ *  ReflectUniforms()
+ *
+ *  This method is called to read every active uniform of
+ *  the linked shader program into the uniform table, so
+ *  that no uniform locations are queried while rendering.
+ ***********************************************************/
+void ShaderManager::ReflectUniforms()
+{
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+
+	m_uniforms.clear();
+	m_uniformIndex.clear();
+
+	// the saved locations of the variants follow the table
+	// indices, so they are resolved again when switching
+	std::unordered_map<VariantKey, PROGRAM_VARIANT>::iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); ++it)
+	{
+		it->second.locations.clear();
+	}
+
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	if ((uniformCount <= 0) || (maxNameLength <= 0))
+	{
+		return;
+	}
+
+	std::vector<char> nameBuffer(maxNameLength + 1);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(m_programID, (GLuint)i, maxNameLength, &nameLength, &size, &type, &nameBuffer[0]);
+
+		std::string name(&nameBuffer[0], nameLength);
+		GLint location = glGetUniformLocation(m_programID, name.c_str());
+
+		// uniforms inside of uniform blocks have no location
+		if (location < 0)
+		{
+			continue;
+		}
+
+		// arrays of basic types are reported once as "name[0]" - register
+		// the plain name and every element so all of them can be resolved
+		std::string::size_type bracket = name.rfind("[0]");
+		if ((size > 1) && (bracket != std::string::npos) && (bracket + 3 == name.size()))
+		{
+			std::string baseName = name.substr(0, bracket);
+			AddUniform(baseName, location, type, size);
+			for (GLint element = 0; element < size; element++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(element) + "]";
+				AddUniform(elementName, glGetUniformLocation(m_programID, elementName.c_str()), type, 1);
+			}
+		}
+		else
+		{
+			AddUniform(name, location, type, size);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddUniform()
+ *
+ *  This method is called to add a uniform to the uniform
+ *  table and returns its index in the table.
+ ***********************************************************/
+int ShaderManager::AddUniform(const std::string &name, GLint location, GLenum type, GLint size) const
+{
+	std::unordered_map<std::string, int>::const_iterator it = m_uniformIndex.find(name);
+	if (it != m_uniformIndex.end())
+	{
+		return(it->second);
+	}
+
+	UNIFORM_INFO info;
+	info.name = name;
+	info.location = location;
+	info.type = type;
+	info.size = size;
+
+	int index = (int)m_uniforms.size();
+	m_uniforms.push_back(info);
+	m_uniformIndex[name] = index;
+
+	return(index);
+}
+
+/***********************************************************
+ *  GetUniformHandle()
+ *
+ *  This method is used to get the handle for the named
+ *  uniform.  Names that were not reflected are queried
+ *  once and cached, so inactive uniforms get a handle
+ *  with no location and are silently ignored by GL.
+ ***********************************************************/
+ShaderManager::UniformHandle ShaderManager::GetUniformHandle(const std::string &name) const
+{
+	UniformHandle handle;
+
+	std::unordered_map<std::string, int>::const_iterator it = m_uniformIndex.find(name);
+	if (it != m_uniformIndex.end())
+	{
+		handle.index = it->second;
+	}
+	else
+	{
+		handle.index = AddUniform(name, glGetUniformLocation(m_programID, name.c_str()), 0, 0);
+	}
+
+	return(handle);
+}
+
+/***********************************************************
+ *  GetUniformLocation()
+ *
+ *  This method is used to get the cached location of the
+ *  named uniform.  It is the fallback for the string based
+ *  setters - hot paths should resolve a handle instead.
+ ***********************************************************/
+GLint ShaderManager::GetUniformLocation(const std::string &name) const
+{
+	return(GetUniformLocation(GetUniformHandle(name)));
 }
 
 
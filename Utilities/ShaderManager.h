@@ -10,16 +10,124 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "ShaderBlocks.h"
 
 class ShaderManager
 {
 public:
+	// handle to a shader uniform that was resolved when the
+	// shaders were loaded - setting a value through a handle
+	// is an array lookup with no string compare or GL query
+	struct UniformHandle
+	{
+		int index = -1;
+	};
+
+	// key of a shader variant, the sources of a specialized
+	// variant are compiled with the defines of its features
+	typedef unsigned int VariantKey;
+	// the variant without defines decides its features at run time
+	static const VariantKey GENERIC_VARIANT = 0;
+
+	// the render pass a specialized variant is compiled for - the
+	// geometry pass writes the G-buffer of the deferred renderer, and
+	// the lighting pass shades it with a full-screen triangle
+	enum VariantPass
+	{
+		VARIANT_PASS_FORWARD,
+		VARIANT_PASS_GEOMETRY,
+		VARIANT_PASS_LIGHTING
+	};
+
 	unsigned int m_programID;
+
+	// constructor
+	ShaderManager();
 	
+	// load the shaders and wait until the program is linked,
+	// returns 0 when they could not be compiled or linked
 	GLuint LoadShaders(
 		const char* vertex_file_path, 
 		const char* fragment_file_path);
 
+	// set the directory where the linked programs are cached,
+	// an empty directory disables the program cache
+	void SetProgramCacheDirectory(const std::string &directory);
+	// start loading the shaders as the generic variant, from the
+	// program cache or by compiling them while the caller continues
+	// - returns false when the files could not be read
+	bool BeginLoadShaders(
+		const char* vertex_file_path,
+		const char* fragment_file_path);
+	// check without blocking whether the requested variants are linked
+	bool IsProgramReady() const;
+	// wait until the requested variants are linked and make the generic
+	// one current, returns false when it failed to compile or link
+	bool WaitForShaders();
+
+	// get the key of the specialized variant for the passed in features
+	static VariantKey MakeVariantKey(bool bLighting, bool bTexture, int lightCount,
+		VariantPass pass = VARIANT_PASS_FORWARD);
+	// start loading a variant, unless it is loaded already
+	void RequestVariant(VariantKey key);
+	// make a variant the current program, returns true when the
+	// program was switched
+	bool UseVariant(VariantKey key);
+	// get the key of the current variant
+	VariantKey GetCurrentVariant() const { return m_currentVariant; }
+	// get the number of loaded variants
+	int GetVariantCount() const { return (int)m_variants.size(); }
+
+	// check whether every variant was loaded from the program cache
+	bool IsProgramFromCache() const;
+	// get the milliseconds that the variants blocked on the driver
+	double GetShaderWaitTime() const { return m_shaderWaitTime; }
+
+	// get the handle for the named uniform, the handle stays
+	// valid until the shaders are loaded again
+	UniformHandle GetUniformHandle(const std::string &name) const;
+
+	// get the location of the named uniform from the cache
+	GLint GetUniformLocation(const std::string &name) const;
+
+	// get the location of the uniform for the passed in handle
+	inline GLint GetUniformLocation(UniformHandle handle) const
+	{
+		return (handle.index >= 0) ? m_uniforms[handle.index].location : -1;
+	}
+
+	// write the per-frame camera data into the shared uniform block
+	void UpdateFrameConstants(const FRAME_CONSTANTS &frameConstants);
+	// get the camera data that was last written for this frame
+	inline const FRAME_CONSTANTS& GetFrameConstants() const
+	{
+		return m_frameConstants;
+	}
+	// write the light sources into the shared uniform block
+	void UpdateLightBlock(const LIGHT_BLOCK &lightBlock);
+	// write the object materials into the shared storage buffer
+	void UpdateMaterialBuffer(const GPU_MATERIAL *pMaterials, int materialCount);
+	// write the point lights into the shared storage buffer
+	void UpdatePointLights(const POINT_LIGHT *pLights, int lightCount);
+	// write the light lists of the clusters and their layout
+	void UpdateLightGrid(
+		const LIGHT_GRID_CONSTANTS &constants,
+		const LIGHT_CLUSTER *pClusters,
+		int clusterCount,
+		const unsigned int *pLightIndices,
+		int lightIndexCount);
+
+	// create a uniform buffer of the passed in size and attach
+	// it to the passed in binding point
+	static GLuint CreateUniformBuffer(GLuint bindingPoint, GLsizeiptr size);
+	// replace the contents of a storage buffer, creating it first,
+	// and attach it to the passed in binding point
+	static void WriteStorageBuffer(GLuint &bufferID, GLuint bindingPoint, const void *pData, GLsizeiptr size);
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
@@ -31,73 +139,203 @@ public:
 	// ------------------------------------------------------------------------
 	inline void setBoolValue(const std::string &name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		glUniform1i(GetUniformLocation(name), (int)value);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setIntValue(const std::string &name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1i(GetUniformLocation(name), value);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setFloatValue(const std::string &name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1f(GetUniformLocation(name), value);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform2fv(GetUniformLocation(name), 1, &value[0]);
 	}
 
 	inline void setVec2Value(const std::string &name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		glUniform2f(GetUniformLocation(name), x, y);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform3fv(GetUniformLocation(name), 1, &value[0]);
 	}
 	inline void setVec3Value(const std::string &name, float x, float y, float z) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		glUniform3f(GetUniformLocation(name), x, y, z);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform4fv(GetUniformLocation(name), 1, &value[0]);
 	}
 	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		glUniform4f(GetUniformLocation(name), x, y, z, w);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setSampler2DValue(const std::string& name, const int &value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		glUniform1i(GetUniformLocation(name), value);
+	}
+
+	// handle based uniform functions
+	// ------------------------------------------------------------------------
+	inline void setBoolValue(UniformHandle handle, bool value) const
+	{
+		glUniform1i(GetUniformLocation(handle), (int)value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setIntValue(UniformHandle handle, int value) const
+	{
+		glUniform1i(GetUniformLocation(handle), value);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setFloatValue(UniformHandle handle, float value) const
+	{
+		glUniform1f(GetUniformLocation(handle), value);
 	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec2Value(UniformHandle handle, const glm::vec2 &value) const
+	{
+		glUniform2fv(GetUniformLocation(handle), 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec3Value(UniformHandle handle, const glm::vec3 &value) const
+	{
+		glUniform3fv(GetUniformLocation(handle), 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setVec4Value(UniformHandle handle, const glm::vec4 &value) const
+	{
+		glUniform4fv(GetUniformLocation(handle), 1, &value[0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat3Value(UniformHandle handle, const glm::mat3 &mat) const
+	{
+		glUniformMatrix3fv(GetUniformLocation(handle), 1, GL_FALSE, &mat[0][0]);
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setMat4Value(UniformHandle handle, const glm::mat4 &mat) const
+	{
+		glUniformMatrix4fv(GetUniformLocation(handle), 1, GL_FALSE, glm::value_ptr(mat));
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setSampler2DValue(UniformHandle handle, const int &value) const
+	{
+		glUniform1i(GetUniformLocation(handle), value);
+	}
+
+private:
+	// reflected information for one active uniform
+	struct UNIFORM_INFO
+	{
+		std::string name;
+		GLint location;
+		GLenum type;
+		GLint size;
+	};
+
+	// uniform buffers for the shared per-frame and light blocks
+	GLuint m_frameConstantsUBO;
+	GLuint m_lightBlockUBO;
+	// storage buffer for the object materials
+	GLuint m_materialSSBO;
+	// uniform buffer for the cluster layout, and storage buffers for
+	// the point lights and the light lists of the clusters
+	GLuint m_lightGridUBO;
+	GLuint m_pointLightSSBO;
+	GLuint m_lightClusterSSBO;
+	GLuint m_lightIndexSSBO;
+	// copy of the camera data last written to the GPU
+	FRAME_CONSTANTS m_frameConstants;
+
+	// one compiled variant of the shaders
+	struct PROGRAM_VARIANT
+	{
+		GLuint programID;			// 0 when the variant failed
+		GLuint vertexShaderID;		// shaders while the program is compiling
+		GLuint fragmentShaderID;
+		bool bPending;				// linked but the status is not checked yet
+		bool bFromCache;			// loaded from the program cache
+		uint64_t cacheKey;
+		std::string cachePath;
+		// uniform locations of the program, indexed like the uniform
+		// table, for when the variant is not the current program
+		std::vector<GLint> locations;
+	};
+
+	// sources and files of the loaded shaders
+	std::string m_vertexShaderCode;
+	std::string m_fragmentShaderCode;
+	std::string m_vertexShaderPath;
+	std::string m_fragmentShaderPath;
+	// loaded variants by key, and the current one
+	std::unordered_map<VariantKey, PROGRAM_VARIANT> m_variants;
+	VariantKey m_currentVariant;
+	// directory of the program cache, empty when it is disabled
+	std::string m_programCacheDirectory;
+	// milliseconds the variants blocked on the driver
+	double m_shaderWaitTime;
+
+	// flat table of the uniforms, indexed by UniformHandle
+	mutable std::vector<UNIFORM_INFO> m_uniforms;
+	// uniform name to table index, used to resolve handles
+	mutable std::unordered_map<std::string, int> m_uniformIndex;
+
+	// check the compile status of a shader and output its log
+	bool CheckShader(GLuint shaderID, const char* file_path);
+	// check whether linked programs can be saved and loaded
+	static bool IsProgramBinarySupported();
+	// check the status of a compiled variant and save its program
+	void FinishVariant(PROGRAM_VARIANT &variant);
+	// delete the programs of all variants
+	void DestroyVariants();
+	// create the program of a variant from its cache file
+	bool LoadProgramBinary(PROGRAM_VARIANT &variant);
+	// save the linked program of a variant into its cache file
+	void SaveProgramBinary(const PROGRAM_VARIANT &variant);
+
+	// read every active uniform of the linked program into the table
+	void ReflectUniforms();
+	// add a uniform to the table and return its index
+	int AddUniform(const std::string &name, GLint location, GLenum type, GLint size) const;
 };
\ No newline at end of file
@@ -1,61 +1,213 @@
 #version 440 core
 
+// member order follows the std430 packing of GPU_MATERIAL in ShaderBlocks.h
 struct Material 
 {
     vec3 ambientColor;
     float ambientStrength;
     vec3 diffuseColor;
-    vec3 specularColor;
     float shininess;
+    vec3 specularColor;
 }; 
 
+// member order follows the std140 packing of LIGHT_SOURCE in ShaderBlocks.h
 struct LightSource 
 {
-    vec3 position;	
+    vec3 position;
+    float focalStrength;
     vec3 ambientColor;
+    float specularIntensity;
     vec3 diffuseColor;
     vec3 specularColor;
-    float focalStrength;
-    float specularIntensity;
+};
+
+// member order follows the std430 packing of POINT_LIGHT in ShaderBlocks.h
+struct PointLight
+{
+    vec3 position;
+    float radius;
+    vec3 color;
+    float intensity;
 };
 
 #define TOTAL_LIGHTS 4
+// focal strength and intensity of the point light highlights
+#define POINT_LIGHT_FOCAL_STRENGTH 32.0
+#define POINT_LIGHT_SPECULAR_INTENSITY 0.1
+
+// ShaderManager compiles specialized variants by inserting defines after the
+// version line - VARIANT_LIGHTING with LIGHT_COUNT and VARIANT_TEXTURE select
+// the features of a variant, so it has no branches on them.  The generic
+// variant has no defines and decides from the uniforms at run time.  The
+// deferred renderer draws the objects with VARIANT_GEOMETRY_PASS into the
+// G-buffer, and shades it with VARIANT_LIGHTING_PASS.
+
+// per-frame camera data, shared by all shader programs
+layout (std140, binding = 0) uniform FrameConstants
+{
+   mat4 view;
+   mat4 projection;
+   vec4 viewPosition;
+};
+
+// light sources, only uploaded when a light changes
+layout (std140, binding = 1) uniform LightBlock
+{
+   LightSource lightSources[TOTAL_LIGHTS];
+};
+
+// object materials, uploaded once and indexed by material id
+layout (std430, binding = 0) readonly buffer MaterialBuffer
+{
+   Material materials[];
+};
+
+// layout of the light clusters, the view is split into tiles of the
+// window and slices of the view depth that grow with the distance
+layout (std140, binding = 2) uniform LightGridConstants
+{
+   uvec4 clusterCounts;
+   vec4 tileSize;
+   vec4 depthSlicing;   // x = scale, y = bias of the log of the view depth
+};
+
+// point lights of the scene
+layout (std430, binding = 1) readonly buffer PointLightBuffer
+{
+   PointLight pointLights[];
+};
+
+// first entry and length of the light index list of each cluster
+layout (std430, binding = 2) readonly buffer LightClusterBuffer
+{
+   uvec2 lightClusters[];
+};
+
+// light index lists of all clusters, one after another
+layout (std430, binding = 3) readonly buffer LightIndexBuffer
+{
+   uint lightIndices[];
+};
 
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+in vec2 fragmentUVscale;
+flat in int fragmentMaterialIndex;
+// layer of the texture array, draws without a texture use -1
+flat in int fragmentTextureLayer;
+#if defined(VARIANT_LIGHTING_PASS)
+flat in mat4 fragmentInverseViewProjection;
+#endif
 
+#if defined(VARIANT_GEOMETRY_PASS)
+// the render targets of the G-buffer, in the order of its attachments
+layout (location = 0) out vec4 outAlbedo;
+layout (location = 1) out vec4 outNormal;     // xyz = normal scaled to 0..1, w = lit
+layout (location = 2) out uint outMaterial;
+#else
 out vec4 outFragmentColor;
+#endif
 
-uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
+// number of the light sources that are set, for the generic variant
+uniform int activeLights = TOTAL_LIGHTS;
 uniform vec4 objectColor = vec4(1.0f);
-uniform sampler2D objectTexture;
-uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
+// the array stays bound to unit 0, so no variant needs the sampler set
+layout (binding = 0) uniform sampler2DArray objectTextures;
+
+#if defined(VARIANT_LIGHTING_PASS)
+// the G-buffer of the geometry pass, on the units of GBuffer::TEXTURE_UNIT
+layout (binding = 1) uniform sampler2D gbufferAlbedo;
+layout (binding = 2) uniform sampler2D gbufferNormal;
+layout (binding = 3) uniform usampler2D gbufferMaterial;
+layout (binding = 4) uniform sampler2D gbufferDepth;
+#endif
 
 // function prototypes
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec3 CalcPhongLighting();
+vec3 CalcSurfaceLighting(Material material, vec3 lightNormal, vec3 vertexPosition);
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec3 CalcClusterLights(Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec3 CalcPointLight(PointLight light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
 
+#if defined(VARIANT_GEOMETRY_PASS)
+// stores the surface of the pixel, the lighting pass shades it once
+// no matter how many surfaces were drawn over it
 void main()
 {
-   if(bUseLighting == true)
+#if defined(VARIANT_TEXTURE)
+   vec4 baseColor = texture(objectTextures, vec3(fragmentTextureCoordinate * fragmentUVscale, fragmentTextureLayer));
+#else
+   vec4 baseColor = objectColor;
+#endif
+#if defined(VARIANT_LIGHTING)
+#if defined(VARIANT_TEXTURE)
+   baseColor.w = 1.0;
+#endif
+   outNormal = vec4((normalize(fragmentVertexNormal) * 0.5) + 0.5, 1.0);
+#else
+   outNormal = vec4(0.5, 0.5, 1.0, 0.0);
+#endif
+   outAlbedo = baseColor;
+   outMaterial = uint(fragmentMaterialIndex);
+}
+#elif defined(VARIANT_LIGHTING_PASS)
+// shades one pixel of the G-buffer, the position is rebuilt from its depth
+void main()
+{
+   ivec2 pixel = ivec2(gl_FragCoord.xy);
+   float depth = texelFetch(gbufferDepth, pixel, 0).x;
+
+   // the pixels that no surface was drawn into keep the clear color
+   if(depth >= 1.0)
    {
-      // properties
-      vec3 lightNormal = normalize(fragmentVertexNormal);
-      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
-      vec3 phongResult = vec3(0.0f);
+      discard;
+   }
+   gl_FragDepth = depth;
 
-      for(int i = 0; i < TOTAL_LIGHTS; i++)
-      {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
-      }   
+   vec4 albedo = texelFetch(gbufferAlbedo, pixel, 0);
+#if defined(VARIANT_LIGHTING)
+   vec4 encodedNormal = texelFetch(gbufferNormal, pixel, 0);
+   if(encodedNormal.w > 0.5)
+   {
+      vec2 screenPosition = gl_FragCoord.xy / vec2(textureSize(gbufferDepth, 0));
+      vec4 clipPosition = vec4((screenPosition * 2.0) - 1.0, (depth * 2.0) - 1.0, 1.0);
+      vec4 worldPosition = fragmentInverseViewProjection * clipPosition;
+      vec3 lightNormal = normalize((encodedNormal.xyz * 2.0) - 1.0);
+      Material material = materials[texelFetch(gbufferMaterial, pixel, 0).x];
+
+      vec3 phongResult = CalcSurfaceLighting(material, lightNormal, worldPosition.xyz / worldPosition.w);
+      outFragmentColor = vec4(phongResult * albedo.xyz, albedo.w);
+      return;
+   }
+#endif
+   outFragmentColor = albedo;
+}
+#else
+void main()
+{
+#if defined(VARIANT_SPECIALIZED)
+#if defined(VARIANT_TEXTURE)
+   vec4 baseColor = texture(objectTextures, vec3(fragmentTextureCoordinate * fragmentUVscale, fragmentTextureLayer));
+#else
+   vec4 baseColor = objectColor;
+#endif
+#if defined(VARIANT_LIGHTING) && defined(VARIANT_TEXTURE)
+   outFragmentColor = vec4(CalcPhongLighting() * baseColor.xyz, 1.0);
+#elif defined(VARIANT_LIGHTING)
+   outFragmentColor = vec4(CalcPhongLighting() * baseColor.xyz, baseColor.w);
+#else
+   outFragmentColor = baseColor;
+#endif
+#else
+   if(bUseLighting == true)
+   {
+      vec3 phongResult = CalcPhongLighting();
     
-      if(bUseTexture == true)
+      if(fragmentTextureLayer >= 0)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         vec4 textureColor = texture(objectTextures, vec3(fragmentTextureCoordinate * fragmentUVscale, fragmentTextureLayer));
          outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
       }
       else
@@ -65,19 +217,93 @@ void main()
    }
    else 
    {
-      if(bUseTexture == true)
+      if(fragmentTextureLayer >= 0)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = texture(objectTextures, vec3(fragmentTextureCoordinate * fragmentUVscale, fragmentTextureLayer));
       }
       else
       {
          outFragmentColor = objectColor;
       }
    }
+#endif
+}
+#endif
+
+// lights the surface of the forward drawn fragment
+vec3 CalcPhongLighting()
+{
+   return(CalcSurfaceLighting(materials[fragmentMaterialIndex], normalize(fragmentVertexNormal), fragmentPosition));
+}
+
+// adds up the light sources, the loop of a specialized variant has a
+// constant count, so the compiler unrolls it
+vec3 CalcSurfaceLighting(Material material, vec3 lightNormal, vec3 vertexPosition)
+{
+   // properties
+   vec3 viewDirection = normalize(viewPosition.xyz - vertexPosition);
+   vec3 phongResult = vec3(0.0f);
+
+#if defined(LIGHT_COUNT)
+   for(int i = 0; i < LIGHT_COUNT; i++)
+#else
+   for(int i = 0; i < min(activeLights, TOTAL_LIGHTS); i++)
+#endif
+   {
+      phongResult += CalcLightSource(lightSources[i], material, lightNormal, vertexPosition, viewDirection); 
+   }   
+
+   phongResult += CalcClusterLights(material, lightNormal, vertexPosition, viewDirection);
+
+   return(phongResult);
+}
+
+// adds up the point lights that reach the cluster of the fragment, the
+// lights of the other clusters are never touched
+vec3 CalcClusterLights(Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   // the camera looks down the negative Z axis in view space
+   float viewDepth = -(view * vec4(vertexPosition, 1.0)).z;
+   int slice = int(floor((log(max(viewDepth, 0.0001)) * depthSlicing.x) + depthSlicing.y));
+   ivec2 tile = ivec2(gl_FragCoord.xy / tileSize.xy);
+
+   ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), ivec3(clusterCounts.xyz) - 1);
+   uint clusterIndex = (((uint(cluster.z) * clusterCounts.y) + uint(cluster.y)) * clusterCounts.x) + uint(cluster.x);
+   uvec2 lightRange = lightClusters[clusterIndex];
+
+   vec3 clusterResult = vec3(0.0f);
+   for(uint i = 0; i < lightRange.y; i++)
+   {
+      PointLight light = pointLights[lightIndices[lightRange.x + i]];
+      clusterResult += CalcPointLight(light, material, lightNormal, vertexPosition, viewDirection);
+   }
+
+   return(clusterResult);
+}
+
+// calculates the color of a point light, which fades out smoothly
+// before its radius so it only reaches the clusters it was assigned to
+vec3 CalcPointLight(PointLight light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   vec3 toLight = light.position - vertexPosition;
+   float distance = length(toLight);
+   float ratio = distance / light.radius;
+   float fade = clamp(1.0 - (ratio * ratio * ratio * ratio), 0.0, 1.0);
+   float attenuation = (fade * fade) / (1.0 + (distance * distance));
+
+   vec3 lightDirection = toLight / max(distance, 0.0001);
+   float impact = max(dot(lightNormal, lightDirection), 0.0);
+   vec3 diffuse = impact * material.diffuseColor;
+
+   vec3 reflectDir = reflect(-lightDirection, lightNormal);
+   float specularComponent = pow(max(dot(viewDirection, reflectDir), 0.0), POINT_LIGHT_FOCAL_STRENGTH);
+   vec3 specular = (POINT_LIGHT_SPECULAR_INTENSITY * material.shininess) * specularComponent * material.specularColor;
+
+   return((diffuse + specular) * light.color * (light.intensity * attenuation));
 }
 
 // calculates the color when using a directional light.
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+vec3 CalcLightSource(LightSource light, Material material, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
 {
    vec3 ambient;
    vec3 diffuse;
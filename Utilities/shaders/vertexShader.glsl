@@ -1,20 +1,104 @@
-#version 330 core
+#version 440 core
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// per-instance attributes - only read when bUseInstancing is set
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceParams;  // xy = UV scale, z = material index, w = texture layer
+// octahedral normal of the packed vertex format - only read when bPackedVertices is set
+layout (location = 8) in vec2 inPackedNormal;
+// matrices derived from the instance model matrix on the CPU, once per object
+layout (location = 9) in mat4 inInstanceModelViewProjection;
+layout (location = 13) in mat3 inInstanceNormalMatrix;
 
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+out vec2 fragmentUVscale;
+flat out int fragmentMaterialIndex;
+flat out int fragmentTextureLayer;
+#if defined(VARIANT_LIGHTING_PASS)
+// the lighting pass moves the pixels of the G-buffer back into world space
+flat out mat4 fragmentInverseViewProjection;
+#endif
+
+// per-frame camera data, shared by all shader programs
+layout (std140, binding = 0) uniform FrameConstants
+{
+   mat4 view;
+   mat4 projection;
+   vec4 viewPosition;
+};
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// matrices derived from the model matrix on the CPU, once per single draw
+uniform mat4 modelViewProjection;
+uniform mat3 normalMatrix;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+uniform bool bUseInstancing = false;
+uniform int materialIndex = 0;
+uniform int textureLayer = -1;
+uniform bool bPackedVertices = false;
+
+// unfold the lower half of the octahedron and project
+// the point back onto the unit sphere
+vec3 DecodeOctahedralNormal(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float fold = max(-normal.z, 0.0);
+   normal.x += (normal.x >= 0.0) ? -fold : fold;
+   normal.y += (normal.y >= 0.0) ? -fold : fold;
+   return normalize(normal);
+}
 
+#if defined(VARIANT_LIGHTING_PASS)
+// the deferred lighting pass draws one triangle that covers the whole
+// window, its corners are made from the vertex index with no vertex data
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
+   vec2 corner = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1)) - 1.0;
+   gl_Position = vec4(corner, 0.0, 1.0);
+
+   // three vertices take the inverse instead of every pixel
+   fragmentInverseViewProjection = inverse(projection * view);
+}
+#else
+void main()
+{
+   mat4 objectModel = model;
+   fragmentUVscale = UVscale;
+   fragmentMaterialIndex = materialIndex;
+   fragmentTextureLayer = textureLayer;
+
+   if(bUseInstancing == true)
+   {
+      objectModel = inInstanceModel;
+      fragmentUVscale = inInstanceParams.xy;
+      fragmentMaterialIndex = int(inInstanceParams.z + 0.5);
+      fragmentTextureLayer = int(floor(inInstanceParams.w + 0.5));
+   }
+   // draws without a material use the first one
+   fragmentMaterialIndex = max(fragmentMaterialIndex, 0);
+
+   vec4 worldPosition = objectModel * vec4(inVertexPosition, 1.0);
+   fragmentPosition = vec3(worldPosition);
+
+   vec3 vertexNormal = inVertexNormal;
+   if(bPackedVertices == true)
+   {
+      vertexNormal = DecodeOctahedralNormal(inPackedNormal);
+   }
+
+   if(bUseInstancing == true)
+   {
+      gl_Position = inInstanceModelViewProjection * vec4(inVertexPosition, 1.0);
+      fragmentVertexNormal = inInstanceNormalMatrix * vertexNormal;
+   }
+   else
+   {
+      gl_Position = modelViewProjection * vec4(inVertexPosition, 1.0);
+      fragmentVertexNormal = normalMatrix * vertexNormal;
+   }
    fragmentTextureCoordinate = inTextureCoordinate;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file